@@ -0,0 +1,142 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+// Plans the placement of buffers in a single heap so that buffers whose lifetimes don't overlap share memory.
+// A buffer's lifetime is the inclusive range of steps (e.g. commands) from its first use to its last use; the
+// contents of a buffer are undefined outside of its lifetime, since other buffers may overwrite them.
+//
+// Placement is an offset assignment problem: buffers that are live at the same step must occupy disjoint ranges.
+// The planner places buffers from largest to smallest, each into the smallest free range (best fit) left by the
+// already placed buffers that are live at the same time as it. The heap is at least as large as the peak size of
+// the buffers that are live at any one step, and typically close to it.
+class AliasingPlanner
+{
+public:
+    struct Buffer
+    {
+        uint64_t sizeInBytes;
+        uint32_t firstUse;
+        uint32_t lastUse;
+    };
+
+    struct Plan
+    {
+        std::vector<uint64_t> offsets;      // Offset of each buffer in the heap, in the order the buffers were added.
+        uint64_t heapSizeInBytes = 0;
+        uint64_t unaliasedSizeInBytes = 0;  // Memory required if every buffer had its own allocation.
+        uint64_t peakLiveSizeInBytes = 0;   // Largest size of the buffers that are live at the same step.
+    };
+
+    // Offsets and sizes are rounded up to the alignment (e.g. D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT).
+    explicit AliasingPlanner(uint64_t alignment) : m_alignment(alignment)
+    {
+        if (alignment == 0)
+        {
+            throw std::invalid_argument("AliasingPlanner alignment must be non-zero.");
+        }
+    }
+
+    // Returns the index of the buffer in the plan.
+    size_t AddBuffer(uint64_t sizeInBytes, uint32_t firstUse, uint32_t lastUse)
+    {
+        if (firstUse > lastUse)
+        {
+            throw std::invalid_argument("AliasingPlanner buffer's first use must not be after its last use.");
+        }
+
+        m_buffers.push_back({ (sizeInBytes + m_alignment - 1) / m_alignment * m_alignment, firstUse, lastUse });
+        return m_buffers.size() - 1;
+    }
+
+    Plan CreatePlan() const
+    {
+        Plan plan;
+        plan.offsets.resize(m_buffers.size());
+
+        // Largest first, since small buffers fit into the gaps left between large ones. Ties are broken by order
+        // of use, so the plan is deterministic.
+        std::vector<size_t> order(m_buffers.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)
+        {
+            if (m_buffers[a].sizeInBytes != m_buffers[b].sizeInBytes)
+            {
+                return m_buffers[a].sizeInBytes > m_buffers[b].sizeInBytes;
+            }
+            return m_buffers[a].firstUse < m_buffers[b].firstUse;
+        });
+
+        std::vector<size_t> placed;
+        std::vector<size_t> overlapping;
+        for (size_t index : order)
+        {
+            auto& buffer = m_buffers[index];
+
+            overlapping.clear();
+            for (size_t other : placed)
+            {
+                if (m_buffers[other].firstUse <= buffer.lastUse && buffer.firstUse <= m_buffers[other].lastUse)
+                {
+                    overlapping.push_back(other);
+                }
+            }
+            std::sort(overlapping.begin(), overlapping.end(), [&](size_t a, size_t b) { return plan.offsets[a] < plan.offsets[b]; });
+
+            // Overlapping buffers may overlap each other in the heap (if their lifetimes don't), so the free ranges
+            // are the gaps after the furthest end seen so far.
+            uint64_t bestOffset = 0;
+            uint64_t bestGap = std::numeric_limits<uint64_t>::max();
+            uint64_t end = 0;
+            for (size_t other : overlapping)
+            {
+                uint64_t offset = plan.offsets[other];
+                if (offset >= end && offset - end >= buffer.sizeInBytes && offset - end < bestGap)
+                {
+                    bestOffset = end;
+                    bestGap = offset - end;
+                }
+                end = std::max(end, offset + m_buffers[other].sizeInBytes);
+            }
+
+            plan.offsets[index] = bestGap != std::numeric_limits<uint64_t>::max() ? bestOffset : end;
+            plan.heapSizeInBytes = std::max(plan.heapSizeInBytes, plan.offsets[index] + buffer.sizeInBytes);
+            plan.unaliasedSizeInBytes += buffer.sizeInBytes;
+            placed.push_back(index);
+        }
+
+        plan.peakLiveSizeInBytes = GetPeakLiveSize();
+        return plan;
+    }
+
+private:
+    uint64_t GetPeakLiveSize() const
+    {
+        // Sizes are added at each buffer's first use and removed after its last use. Removals at a step sort before
+        // additions at the same step, so a buffer that ends right before another starts isn't counted with it.
+        std::vector<std::pair<uint64_t, int64_t>> events;
+        for (auto& buffer : m_buffers)
+        {
+            events.emplace_back(uint64_t(buffer.firstUse) * 2 + 1, static_cast<int64_t>(buffer.sizeInBytes));
+            events.emplace_back((uint64_t(buffer.lastUse) + 1) * 2, -static_cast<int64_t>(buffer.sizeInBytes));
+        }
+        std::sort(events.begin(), events.end());
+
+        int64_t liveSize = 0;
+        int64_t peakLiveSize = 0;
+        for (auto& event : events)
+        {
+            liveSize += event.second;
+            peakLiveSize = std::max(peakLiveSize, liveSize);
+        }
+        return static_cast<uint64_t>(peakLiveSize);
+    }
+
+    uint64_t m_alignment;
+    std::vector<Buffer> m_buffers;
+};
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Arrival times of an open-loop load, in milliseconds since the start of the load. The first request arrives at 0,
+// and each following request arrives one interval after the previous one. Arrivals don't depend on how long requests
+// take to complete: a slow request delays the start of the requests queued behind it, but not their arrival, so the
+// delay shows up in their latency (rather than being omitted from it).
+class ArrivalSchedule
+{
+public:
+    // Exponentially distributed intervals (a Poisson process) with the given mean rate. The same seed always
+    // generates the same arrivals.
+    static ArrivalSchedule Poisson(double ratePerSecond, uint64_t seed)
+    {
+        ArrivalSchedule schedule;
+        schedule.m_generator.seed(seed);
+        schedule.m_exponentialDistribution = std::exponential_distribution<double>(ValidateRate(ratePerSecond) / 1000.0);
+        return schedule;
+    }
+
+    // Evenly spaced arrivals.
+    static ArrivalSchedule Constant(double ratePerSecond)
+    {
+        ArrivalSchedule schedule;
+        schedule.m_intervals = { 1000.0 / ValidateRate(ratePerSecond) };
+        return schedule;
+    }
+
+    // Intervals of a recorded trace, repeated as often as needed. If a rate is given, the intervals are scaled so
+    // that their mean rate matches it (keeping their relative spacing); otherwise the trace is replayed as it is.
+    static ArrivalSchedule FromTrace(std::vector<double> intervals, std::optional<double> ratePerSecond)
+    {
+        if (intervals.empty())
+        {
+            throw std::invalid_argument("An arrival trace needs at least one interval");
+        }
+
+        if (ratePerSecond)
+        {
+            double meanInterval = std::accumulate(intervals.begin(), intervals.end(), 0.0) / intervals.size();
+            if (meanInterval <= 0)
+            {
+                throw std::invalid_argument("An arrival trace with only zero intervals can't be scaled to a rate");
+            }
+
+            double scale = 1000.0 / ValidateRate(*ratePerSecond) / meanInterval;
+            for (auto& interval : intervals)
+            {
+                interval *= scale;
+            }
+        }
+
+        ArrivalSchedule schedule;
+        schedule.m_intervals = std::move(intervals);
+        return schedule;
+    }
+
+    // Returns the arrival time of the next request and advances the schedule past it.
+    double NextArrivalTime()
+    {
+        double arrivalTime = m_time;
+        if (m_intervals.empty())
+        {
+            m_time += m_exponentialDistribution(m_generator);
+        }
+        else
+        {
+            m_time += m_intervals[m_nextInterval];
+            m_nextInterval = (m_nextInterval + 1) % m_intervals.size();
+        }
+        return arrivalTime;
+    }
+
+    // Reads the intervals (in milliseconds) of an arrival trace: one number per line. Empty lines and lines starting
+    // with '#' are ignored.
+    static std::vector<double> ParseTrace(std::istream& stream)
+    {
+        std::vector<double> intervals;
+        std::string line;
+        for (uint32_t lineNumber = 1; std::getline(stream, line); lineNumber++)
+        {
+            auto first = line.find_first_not_of(" \t\r");
+            if (first == std::string::npos || line[first] == '#')
+            {
+                continue;
+            }
+
+            size_t parsedLength = 0;
+            double interval = 0;
+            try
+            {
+                interval = std::stod(line.substr(first), &parsedLength);
+            }
+            catch (const std::exception&)
+            {
+                parsedLength = 0;
+            }
+
+            if (parsedLength == 0 || line.find_first_not_of(" \t\r", first + parsedLength) != std::string::npos || !(interval >= 0))
+            {
+                throw std::invalid_argument("Invalid arrival interval on line " + std::to_string(lineNumber) + ": '" + line + "'");
+            }
+            intervals.push_back(interval);
+        }
+        return intervals;
+    }
+
+private:
+    ArrivalSchedule() = default;
+
+    static double ValidateRate(double ratePerSecond)
+    {
+        if (!(ratePerSecond > 0))
+        {
+            throw std::invalid_argument("Arrival rates must be positive");
+        }
+        return ratePerSecond;
+    }
+
+private:
+    double m_time = 0;
+
+    // Intervals that are repeated in order, or empty for exponentially distributed intervals.
+    std::vector<double> m_intervals;
+    size_t m_nextInterval = 0;
+
+    std::mt19937_64 m_generator;
+    std::exponential_distribution<double> m_exponentialDistribution;
+};
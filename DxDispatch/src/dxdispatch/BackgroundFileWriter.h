@@ -0,0 +1,188 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Writes files on a background thread so that callers don't wait for the disk. Queued data is bounded: Write blocks
+// while the queued bytes would exceed the budget, so at most one buffer is being written while the caller fills the
+// next (a single write larger than the budget is still accepted once the queue is empty). Errors are collected and
+// returned by Flush instead of being thrown from the writer thread.
+class BackgroundFileWriter
+{
+public:
+    struct Result
+    {
+        std::filesystem::path path;
+        std::string error; // Empty if the write succeeded.
+    };
+
+    // Files at least this large are written without stream buffering, straight from the queued data.
+    static constexpr uint64_t c_unbufferedWriteThreshold = 1024 * 1024;
+
+    explicit BackgroundFileWriter(uint64_t maxQueuedBytes) :
+        m_maxQueuedBytes(maxQueuedBytes),
+        m_thread([this] { WriterMain(); })
+    {
+    }
+
+    // Finishes all queued writes before returning.
+    ~BackgroundFileWriter()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_shutdown = true;
+        }
+        m_queueChanged.notify_all();
+        m_thread.join();
+    }
+
+    BackgroundFileWriter(const BackgroundFileWriter&) = delete;
+    BackgroundFileWriter& operator=(const BackgroundFileWriter&) = delete;
+
+    // Queues the data to be written to a file, creating its parent directories if necessary. Any existing file is
+    // replaced.
+    void Write(std::filesystem::path path, std::vector<std::byte> data)
+    {
+        uint64_t sizeInBytes = data.size();
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        WaitBlocked(lock, [&] { return m_queuedBytes == 0 || m_queuedBytes + sizeInBytes <= m_maxQueuedBytes; });
+
+        m_queue.push_back({ std::move(path), std::move(data) });
+        m_queuedBytes += sizeInBytes;
+        lock.unlock();
+        m_queueChanged.notify_all();
+    }
+
+    // Waits for all queued writes to finish and returns the result of every write queued since the last flush, in
+    // the order they were queued.
+    std::vector<Result> Flush()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        WaitBlocked(lock, [&] { return m_queue.empty(); });
+
+        std::vector<Result> results;
+        results.swap(m_results);
+        return results;
+    }
+
+    // Total time callers spent blocked in Write (on a full queue) or Flush.
+    double BlockedMilliseconds() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_blockedMilliseconds;
+    }
+
+    uint64_t WrittenBytes() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_writtenBytes;
+    }
+
+private:
+    struct PendingWrite
+    {
+        std::filesystem::path path;
+        std::vector<std::byte> data;
+    };
+
+    template <typename Predicate>
+    void WaitBlocked(std::unique_lock<std::mutex>& lock, Predicate predicate)
+    {
+        if (predicate())
+        {
+            return;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        m_queueChanged.wait(lock, predicate);
+        m_blockedMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void WriterMain()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true)
+        {
+            m_queueChanged.wait(lock, [this] { return m_shutdown || !m_queue.empty(); });
+            if (m_queue.empty())
+            {
+                return;
+            }
+
+            // The front entry stays queued (and counted) while it's written, so Flush doesn't return early.
+            PendingWrite& write = m_queue.front();
+            lock.unlock();
+            Result result = { write.path, WriteFile(write.path, write.data) };
+            lock.lock();
+
+            if (result.error.empty())
+            {
+                m_writtenBytes += write.data.size();
+            }
+            m_queuedBytes -= write.data.size();
+            m_results.push_back(std::move(result));
+            m_queue.pop_front();
+            m_queueChanged.notify_all();
+        }
+    }
+
+    static std::string WriteFile(const std::filesystem::path& path, const std::vector<std::byte>& data)
+    {
+        try
+        {
+            if (path.has_parent_path() && !std::filesystem::exists(path.parent_path()))
+            {
+                std::filesystem::create_directories(path.parent_path());
+            }
+
+            std::ofstream file;
+            if (data.size() >= c_unbufferedWriteThreshold)
+            {
+                // Must be set before the file is opened to take effect.
+                file.rdbuf()->pubsetbuf(nullptr, 0);
+            }
+
+            file.open(path, std::ios::trunc | std::ios::binary);
+            if (!file.is_open())
+            {
+                return "Could not open file";
+            }
+
+            file.write(reinterpret_cast<const char*>(data.data()), data.size());
+            file.close();
+            if (file.fail())
+            {
+                return "Could not write file";
+            }
+        }
+        catch (const std::exception& e)
+        {
+            return e.what();
+        }
+
+        return {};
+    }
+
+private:
+    const uint64_t m_maxQueuedBytes;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_queueChanged;
+    std::deque<PendingWrite> m_queue;
+    uint64_t m_queuedBytes = 0;
+    std::vector<Result> m_results;
+    double m_blockedMilliseconds = 0;
+    uint64_t m_writtenBytes = 0;
+    bool m_shutdown = false;
+    std::thread m_thread;
+};
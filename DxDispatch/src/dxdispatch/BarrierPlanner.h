@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Plans the barriers needed between dispatches recorded into the same command list. Dispatches are added in
+// recording order along with the resources they read and write; each call returns the barriers that must be
+// recorded (as a single batch) before that dispatch. A UAV barrier is planned only for resources with a real
+// hazard since their last barrier:
+//
+// - read-after-write: the dispatch reads a resource written by an earlier dispatch.
+// - write-after-write: the dispatch writes a resource written by an earlier dispatch.
+// - write-after-read: the dispatch writes a resource read by an earlier dispatch.
+//
+// Resources that share memory (e.g. placed resources in the same heap range) can be given the same aliasing
+// key. Accessing a resource with a different identity than the last resource that used its key requires an
+// aliasing barrier, which also orders all prior accesses to the memory.
+//
+// Resources are opaque handles (e.g. ID3D12Resource*) so the planner can be tested without a device. Work
+// submitted in separate ExecuteCommandLists calls is implicitly ordered, so call Reset() at submission
+// boundaries.
+class BarrierPlanner
+{
+public:
+    using ResourceHandle = void*;
+
+    struct Access
+    {
+        ResourceHandle resource;
+        bool write;
+        ResourceHandle aliasingKey = nullptr;
+    };
+
+    struct AliasingBarrier
+    {
+        ResourceHandle before;
+        ResourceHandle after;
+    };
+
+    struct Barriers
+    {
+        std::vector<ResourceHandle> uav;
+        std::vector<AliasingBarrier> aliasing;
+
+        bool empty() const { return uav.empty() && aliasing.empty(); }
+        size_t size() const { return uav.size() + aliasing.size(); }
+    };
+
+    // Returns the barriers to record before a dispatch with the given accesses.
+    Barriers AddDispatch(const std::vector<Access>& accesses)
+    {
+        Barriers barriers;
+        std::unordered_set<ResourceHandle> barrierResources;
+
+        for (auto& access : accesses)
+        {
+            if (access.aliasingKey)
+            {
+                auto lastResource = m_aliasedResources.find(access.aliasingKey);
+                if (lastResource != m_aliasedResources.end() && lastResource->second != access.resource)
+                {
+                    barriers.aliasing.push_back({ lastResource->second, access.resource });
+                    m_pendingReads.erase(lastResource->second);
+                    m_pendingWrites.erase(lastResource->second);
+                }
+                m_aliasedResources[access.aliasingKey] = access.resource;
+            }
+
+            bool hazard = m_pendingWrites.count(access.resource) ||
+                (access.write && m_pendingReads.count(access.resource));
+
+            if (hazard && barrierResources.insert(access.resource).second)
+            {
+                barriers.uav.push_back(access.resource);
+            }
+        }
+
+        for (auto resource : barrierResources)
+        {
+            m_pendingReads.erase(resource);
+            m_pendingWrites.erase(resource);
+        }
+
+        for (auto& access : accesses)
+        {
+            (access.write ? m_pendingWrites : m_pendingReads).insert(access.resource);
+        }
+
+        m_barrierCount += barriers.size();
+        return barriers;
+    }
+
+    // Forgets all pending accesses (e.g. after the command list is submitted).
+    void Reset()
+    {
+        m_pendingReads.clear();
+        m_pendingWrites.clear();
+        m_aliasedResources.clear();
+    }
+
+    // Total number of barriers planned, across all dispatches.
+    uint64_t BarrierCount() const { return m_barrierCount; }
+
+private:
+    // Accesses since the last barrier on each resource.
+    std::unordered_set<ResourceHandle> m_pendingReads;
+    std::unordered_set<ResourceHandle> m_pendingWrites;
+
+    // Aliasing key -> most recently accessed resource with that key.
+    std::unordered_map<ResourceHandle, ResourceHandle> m_aliasedResources;
+
+    uint64_t m_barrierCount = 0;
+};
@@ -0,0 +1,284 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "BarrierPlanner.h"
+
+// Dependency graph of commands that access GPU resources. Commands are added in program order, and each command
+// depends on earlier commands it has a hazard with (read-after-write, write-after-write, or write-after-read),
+// so independent commands may execute concurrently.
+//
+// The graph can be scheduled onto multiple queues using a simple queue model: each queue executes its commands in
+// submission order, and a command starts once its queue is idle and all of its dependencies have finished. A
+// command on one queue that depends on a command from another queue needs a cross-queue wait (fence), unless the
+// waiting queue already knows the dependency completed (through an earlier wait, possibly transitively).
+//
+// Resources are opaque handles so the graph can be tested without a device.
+class CommandGraph
+{
+public:
+    using Access = BarrierPlanner::Access;
+    using ResourceHandle = BarrierPlanner::ResourceHandle;
+
+    // Waits for a command, which is scheduled on another queue, to finish.
+    struct Wait
+    {
+        uint32_t queue;
+        size_t node;
+    };
+
+    struct ScheduledNode
+    {
+        uint32_t queue;
+        std::vector<Wait> waits;
+        double start;
+        double finish;
+    };
+
+    struct Schedule
+    {
+        std::vector<ScheduledNode> nodes;
+        uint32_t queueCount;
+        size_t waitCount;
+        double makespan;
+    };
+
+    // Adds a command with the given resource accesses and estimated cost (e.g. duration). Returns its index.
+    size_t AddNode(const std::vector<Access>& accesses, double cost = 1.0)
+    {
+        size_t node = m_nodes.size();
+        m_nodes.push_back({ {}, cost });
+
+        std::unordered_set<size_t> dependencies;
+        for (auto& access : accesses)
+        {
+            // Resources that alias the same memory are conservatively treated as writes of the shared memory.
+            if (access.aliasingKey)
+            {
+                AddDependencies(access.aliasingKey, true, dependencies);
+            }
+            AddDependencies(access.resource, access.write, dependencies);
+        }
+
+        for (auto& access : accesses)
+        {
+            if (access.aliasingKey)
+            {
+                RecordAccess(access.aliasingKey, true, node);
+            }
+            RecordAccess(access.resource, access.write, node);
+        }
+
+        dependencies.erase(node);
+        m_nodes[node].dependencies.assign(dependencies.begin(), dependencies.end());
+        std::sort(m_nodes[node].dependencies.begin(), m_nodes[node].dependencies.end());
+        return node;
+    }
+
+    size_t NodeCount() const { return m_nodes.size(); }
+    const std::vector<size_t>& Dependencies(size_t node) const { return m_nodes[node].dependencies; }
+    double Cost(size_t node) const { return m_nodes[node].cost; }
+    void SetCost(size_t node, double cost) { m_nodes[node].cost = cost; }
+
+    // Sum of the costs of all commands (i.e. the duration if executed serially).
+    double TotalWork() const
+    {
+        double totalWork = 0;
+        for (auto& node : m_nodes)
+        {
+            totalWork += node.cost;
+        }
+        return totalWork;
+    }
+
+    // Cost of the most expensive dependency chain (i.e. the duration with unlimited queues).
+    double CriticalPath() const
+    {
+        std::vector<double> finish(m_nodes.size());
+        double criticalPath = 0;
+        for (size_t node = 0; node < m_nodes.size(); node++)
+        {
+            double start = 0;
+            for (auto dependency : m_nodes[node].dependencies)
+            {
+                start = std::max(start, finish[dependency]);
+            }
+            finish[node] = start + m_nodes[node].cost;
+            criticalPath = std::max(criticalPath, finish[node]);
+        }
+        return criticalPath;
+    }
+
+    // Assigns commands (in program order) to the queue where they can start earliest, preferring queues that
+    // need fewer cross-queue waits and then lower queue indices.
+    Schedule ScheduleOnQueues(uint32_t queueCount) const
+    {
+        if (queueCount == 0)
+        {
+            throw std::invalid_argument("CommandGraph must be scheduled on at least one queue.");
+        }
+
+        Schedule schedule = {};
+        schedule.queueCount = queueCount;
+        schedule.nodes.resize(m_nodes.size());
+
+        std::vector<double> queueFinish(queueCount, 0.0);
+        std::vector<int64_t> queueLength(queueCount, 0);
+
+        // For each queue, the number of commands on every queue it knows have completed.
+        std::vector<std::vector<int64_t>> knownComplete(queueCount, std::vector<int64_t>(queueCount, 0));
+
+        // Position of each command on its queue and what its queue knew when the command started.
+        std::vector<int64_t> positions(m_nodes.size());
+        std::vector<std::vector<int64_t>> nodeKnownComplete(m_nodes.size());
+
+        for (size_t node = 0; node < m_nodes.size(); node++)
+        {
+            uint32_t bestQueue = 0;
+            double bestStart = std::numeric_limits<double>::max();
+            size_t bestWaitCount = std::numeric_limits<size_t>::max();
+
+            for (uint32_t queue = 0; queue < queueCount; queue++)
+            {
+                double start = queueFinish[queue];
+                for (auto dependency : m_nodes[node].dependencies)
+                {
+                    start = std::max(start, schedule.nodes[dependency].finish);
+                }
+
+                size_t waitCount = GetWaits(node, queue, schedule, positions, nodeKnownComplete, knownComplete[queue]).size();
+                if (start < bestStart || (start == bestStart && waitCount < bestWaitCount))
+                {
+                    bestQueue = queue;
+                    bestStart = start;
+                    bestWaitCount = waitCount;
+                }
+            }
+
+            auto& scheduledNode = schedule.nodes[node];
+            scheduledNode.queue = bestQueue;
+            scheduledNode.waits = GetWaits(node, bestQueue, schedule, positions, nodeKnownComplete, knownComplete[bestQueue]);
+            scheduledNode.start = bestStart;
+            scheduledNode.finish = bestStart + m_nodes[node].cost;
+
+            auto& known = knownComplete[bestQueue];
+            for (auto& wait : scheduledNode.waits)
+            {
+                for (uint32_t queue = 0; queue < queueCount; queue++)
+                {
+                    known[queue] = std::max(known[queue], nodeKnownComplete[wait.node][queue]);
+                }
+                known[wait.queue] = std::max(known[wait.queue], positions[wait.node] + 1);
+            }
+
+            positions[node] = queueLength[bestQueue]++;
+            nodeKnownComplete[node] = known;
+            queueFinish[bestQueue] = scheduledNode.finish;
+            schedule.waitCount += scheduledNode.waits.size();
+            schedule.makespan = std::max(schedule.makespan, scheduledNode.finish);
+        }
+
+        return schedule;
+    }
+
+private:
+    struct Node
+    {
+        std::vector<size_t> dependencies;
+        double cost;
+    };
+
+    struct ResourceState
+    {
+        std::optional<size_t> lastWriter;
+        std::vector<size_t> readersSinceWrite;
+    };
+
+    void AddDependencies(ResourceHandle resource, bool write, std::unordered_set<size_t>& dependencies) const
+    {
+        auto state = m_resourceStates.find(resource);
+        if (state == m_resourceStates.end())
+        {
+            return;
+        }
+
+        if (state->second.lastWriter)
+        {
+            dependencies.insert(*state->second.lastWriter);
+        }
+        if (write)
+        {
+            dependencies.insert(state->second.readersSinceWrite.begin(), state->second.readersSinceWrite.end());
+        }
+    }
+
+    void RecordAccess(ResourceHandle resource, bool write, size_t node)
+    {
+        auto& state = m_resourceStates[resource];
+        if (write)
+        {
+            state.lastWriter = node;
+            state.readersSinceWrite.clear();
+        }
+        else if (state.readersSinceWrite.empty() || state.readersSinceWrite.back() != node)
+        {
+            state.readersSinceWrite.push_back(node);
+        }
+    }
+
+    // Returns the waits needed to run a command on the given queue: at most one per other queue (the latest
+    // dependency on it), and none for dependencies already known to be complete or implied by another wait.
+    std::vector<Wait> GetWaits(
+        size_t node,
+        uint32_t queue,
+        const Schedule& schedule,
+        const std::vector<int64_t>& positions,
+        const std::vector<std::vector<int64_t>>& nodeKnownComplete,
+        const std::vector<int64_t>& knownComplete) const
+    {
+        std::vector<Wait> waits;
+        for (auto dependency : m_nodes[node].dependencies)
+        {
+            uint32_t dependencyQueue = schedule.nodes[dependency].queue;
+            if (dependencyQueue == queue || positions[dependency] < knownComplete[dependencyQueue])
+            {
+                continue;
+            }
+
+            auto wait = std::find_if(waits.begin(), waits.end(), [&](const Wait& w) { return w.queue == dependencyQueue; });
+            if (wait == waits.end())
+            {
+                waits.push_back({ dependencyQueue, dependency });
+            }
+            else if (positions[dependency] > positions[wait->node])
+            {
+                wait->node = dependency;
+            }
+        }
+
+        std::vector<Wait> requiredWaits;
+        for (auto& wait : waits)
+        {
+            bool implied = std::any_of(waits.begin(), waits.end(), [&](const Wait& other)
+            {
+                return nodeKnownComplete[other.node][wait.queue] > positions[wait.node];
+            });
+
+            if (!implied)
+            {
+                requiredWaits.push_back(wait);
+            }
+        }
+        return requiredWaits;
+    }
+
+private:
+    std::vector<Node> m_nodes;
+    std::unordered_map<ResourceHandle, ResourceState> m_resourceStates;
+};
@@ -6,6 +6,7 @@
 #define CXXOPTS_VECTOR_DELIMITER '\0'
 #include <cxxopts.hpp>
 #include "config.h"
+#include "ArrivalSchedule.h"
 
 CommandLineArgs::CommandLineArgs(int argc, char** argv)
 {
@@ -82,6 +83,22 @@ CommandLineArgs::CommandLineArgs(int argc, char** argv)
             "The minimum time in milliseconds between dispatches (a large interval may introduce sleeps between dispatches)",
             cxxopts::value<uint32_t>()->default_value("0")
         )
+        (
+            "open_loop_rates",
+            "Comma-separated list of request rates (per second) to sweep. Each dispatch command is issued at these rates on an open-loop schedule (--arrival_process), "
+            "and latency is measured from each request's scheduled arrival rather than its actual start",
+            cxxopts::value<std::string>()
+        )
+        (
+            "arrival_process",
+            "Distribution of request arrivals for open_loop_rates ('poisson' or 'constant')",
+            cxxopts::value<std::string>()->default_value("poisson")
+        )
+        (
+            "arrival_trace",
+            "File of request inter-arrival times in milliseconds (one per line) to replay as the open-loop schedule. Scaled to each of open_loop_rates, if given",
+            cxxopts::value<std::string>()
+        )
         (
             "w,warmup_samples",
             "Max number of warmup samples to discard from timing statistics",
@@ -94,9 +111,14 @@ CommandLineArgs::CommandLineArgs(int argc, char** argv)
         )
         (
             "max_gpu_time_measurements",
-            "Determines the size of the GPU timestamp buffer. A value of 0 will disable GPU timing.",
+            "Determines the size of the GPU timestamp buffer, which limits the GPU samples in flight and kept for per-iteration output (statistics cover all samples). A value of 0 will disable GPU timing.",
             cxxopts::value<uint32_t>()
         )
+        (
+            "frames_in_flight",
+            "Max number of dispatch iterations submitted to the GPU before the CPU waits (1 = wait after every iteration)",
+            cxxopts::value<uint32_t>()->default_value("1")
+        )
         ;
 
     // DIRECTX OPTIONS
@@ -121,6 +143,36 @@ CommandLineArgs::CommandLineArgs(int argc, char** argv)
             "Type of command queue/list to use ('compute' or 'direct')",
             cxxopts::value<std::string>()
         )
+        (
+            "queue_count", 
+            "Number of command queues. Independent dispatch commands are scheduled across queues when greater than 1",
+            cxxopts::value<uint32_t>()->default_value("1")
+        )
+        (
+            "record_threads", 
+            "Number of threads that record consecutive dispatch commands into a single submission per iteration. 0 records and submits each dispatch command separately",
+            cxxopts::value<uint32_t>()->default_value("0")
+        )
+        (
+            "replay", 
+            "Record consecutive dispatch commands once and re-submit the recorded command lists every iteration",
+            cxxopts::value<bool>()
+        )
+        (
+            "instances", 
+            "Number of instances of the model that run concurrently, each on its own thread and device. Reports the throughput and iteration latency of each instance and in aggregate",
+            cxxopts::value<uint32_t>()->default_value("1")
+        )
+        (
+            "concurrent_models", 
+            "Additional model to run concurrently with the model (with --instances instances). Can be repeated",
+            cxxopts::value<std::vector<std::string>>()->default_value({})
+        )
+        (
+            "copy_queue_uploads", 
+            "Copy initial resource data on a dedicated copy queue, which overlaps with dispatchable creation",
+            cxxopts::value<bool>()
+        )
         (
             "disable_custom_heaps", 
             "Always use default heaps for resources",
@@ -161,9 +213,39 @@ CommandLineArgs::CommandLineArgs(int argc, char** argv)
             "Prints disassembled shader bytecode (HLSL dispatchables only)", 
             cxxopts::value<bool>()
         )
+        (
+            "shader_cache_dir",
+            "Caches compiled HLSL dispatchables (bytecode, root signature, and bindings) in a directory, so later runs don't recompile shaders whose source, includes, and arguments are unchanged",
+            cxxopts::value<std::string>()
+        )
+        (
+            "shader_cache_size",
+            "Maximum size of the shader cache in MB. The least recently used shaders are removed to stay below it",
+            cxxopts::value<uint32_t>()->default_value("256")
+        )
+        (
+            "compile_threads",
+            "Number of threads that compile dispatchables before they're initialized. 0 uses one thread per hardware thread",
+            cxxopts::value<uint32_t>()->default_value("0")
+        )
+        (
+            "lazy_init",
+            "Creates (and uploads) each resource and creates each dispatchable before the first command that uses it, instead of creating all of them up front",
+            cxxopts::value<bool>()
+        )
+        (
+            "release_resources",
+            "Releases each resource and dispatchable after the last command that uses it, which lowers peak memory of multi-stage models. Implies --lazy_init",
+            cxxopts::value<bool>()
+        )
+        (
+            "alias_resources",
+            "Places resources whose lifetimes (from the first to the last command that uses them) don't overlap in the same memory, and reports the peak memory with and without aliasing",
+            cxxopts::value<bool>()
+        )
         (
             "post_dispatch_barriers",
-            "Sets barrier types issued after every dispatch is recorded into a command list: none, uav, or uav+aliasing",
+            "Sets barrier types issued after every dispatch is recorded into a command list: none, uav, uav+aliasing, or auto (only barriers required by resource hazards)",
             cxxopts::value<std::string>()->default_value("uav")
         )
         (
@@ -197,6 +279,16 @@ CommandLineArgs::CommandLineArgs(int argc, char** argv)
             "Injects present after each full inference pass, giving debugging tools a notion of frames.",
             cxxopts::value<bool>()
         )
+        (
+            "trace_file",
+            "Writes a timeline of the run (CPU phases and GPU work) to a file in the Chrome Trace Event format, viewable in Perfetto or chrome://tracing",
+            cxxopts::value<std::string>()
+        )
+        (
+            "memory_report_file",
+            "Writes the live and peak bytes of each memory category (model resources, DML persistent and temporary resources, upload staging, readback, descriptor heaps, ONNX bindings, and the host model) to a JSON file at exit",
+            cxxopts::value<std::string>()
+        )
         ;
 
     // ONNX OPTIONS
@@ -222,6 +314,13 @@ CommandLineArgs::CommandLineArgs(int argc, char** argv)
             "dimension sizes without whitespace). Can be repeated. Example: -b input1:2,2 -b input2:3,2",
             cxxopts::value<std::vector<std::string>>()->default_value({})
         )
+        (
+            "binding_shape_sweep",
+            "Runs each ONNX dispatch once per set of binding shapes (<tensor_name>:<shape>, separated by ';') with the same "
+            "session, and reports the timings of each set in a table. Can be repeated. Example: "
+            "--binding_shape_sweep x:1,128 --binding_shape_sweep x:1,256",
+            cxxopts::value<std::vector<std::string>>()->default_value({})
+        )
         (
             "l,onnx_graph_optimization_level",
             "Sets the ONNX Runtime graph optimization level. 0 = Disabled; 1 = Basic; 2 = Extended; 99 = All",
@@ -327,6 +426,15 @@ CommandLineArgs::CommandLineArgs(int argc, char** argv)
         m_maxGpuTimeMeasurements = result["max_gpu_time_measurements"].as<uint32_t>();
     }
 
+    if (result.count("frames_in_flight"))
+    {
+        m_framesInFlight = result["frames_in_flight"].as<uint32_t>();
+        if (m_framesInFlight == 0)
+        {
+            throw std::invalid_argument("frames_in_flight must be at least 1");
+        }
+    }
+
     if (result.count("show_dependencies"))
     {
         m_showDependencies = result["show_dependencies"].as<bool>();
@@ -377,6 +485,36 @@ CommandLineArgs::CommandLineArgs(int argc, char** argv)
         m_printHlslDisassembly = result["print_hlsl_disassembly"].as<bool>();
     }
 
+    if (result.count("shader_cache_dir"))
+    {
+        m_shaderCacheDirectory = result["shader_cache_dir"].as<std::string>();
+    }
+
+    if (result.count("shader_cache_size"))
+    {
+        m_shaderCacheSizeInBytes = uint64_t(result["shader_cache_size"].as<uint32_t>()) * 1024 * 1024;
+    }
+
+    if (result.count("compile_threads"))
+    {
+        m_compileThreads = result["compile_threads"].as<uint32_t>();
+    }
+
+    if (result.count("lazy_init"))
+    {
+        m_lazyInit = result["lazy_init"].as<bool>();
+    }
+
+    if (result.count("release_resources"))
+    {
+        m_releaseResources = result["release_resources"].as<bool>();
+    }
+
+    if (result.count("alias_resources"))
+    {
+        m_aliasResources = result["alias_resources"].as<bool>();
+    }
+
     if (result.count("post_dispatch_barriers"))
     {
         auto value = result["post_dispatch_barriers"].as<std::string>();
@@ -396,6 +534,12 @@ CommandLineArgs::CommandLineArgs(int argc, char** argv)
             m_uavBarrierAfterDispatch = true;
             m_aliasingBarrierAfterDispatch = true;
         }
+        else if (value == "auto")
+        {
+            m_uavBarrierAfterDispatch = false;
+            m_aliasingBarrierAfterDispatch = false;
+            m_autoBarriersAfterDispatch = true;
+        }
     }
 
     if (result.count("dml_feature_level"))
@@ -422,6 +566,128 @@ CommandLineArgs::CommandLineArgs(int argc, char** argv)
         }
     }
 
+    if (result.count("queue_count"))
+    {
+        m_queueCount = result["queue_count"].as<uint32_t>();
+        if (m_queueCount == 0)
+        {
+            throw std::invalid_argument("queue_count must be at least 1");
+        }
+
+        // Commands on different queues can only overlap if submitting one doesn't wait for it to finish.
+        if (m_queueCount > 1)
+        {
+            m_framesInFlight = std::max(m_framesInFlight, 2u);
+        }
+    }
+
+    // Aliased resources are re-initialized whenever their lifetimes begin, which assumes a single timeline.
+    if (m_aliasResources && (LazyInit() || m_queueCount > 1))
+    {
+        throw std::invalid_argument("alias_resources can't be combined with lazy_init, release_resources, or queue_count greater than 1");
+    }
+
+    if (result.count("record_threads"))
+    {
+        m_recordThreads = result["record_threads"].as<uint32_t>();
+        if (m_recordThreads > 0 && m_queueCount > 1)
+        {
+            throw std::invalid_argument("record_threads can't be combined with queue_count greater than 1");
+        }
+    }
+
+    if (result.count("replay"))
+    {
+        m_replayDispatches = result["replay"].as<bool>();
+        if (m_replayDispatches && m_queueCount > 1)
+        {
+            throw std::invalid_argument("replay can't be combined with queue_count greater than 1");
+        }
+    }
+
+    if (result.count("instances"))
+    {
+        m_instanceCount = result["instances"].as<uint32_t>();
+        if (m_instanceCount == 0)
+        {
+            throw std::invalid_argument("instances must be at least 1");
+        }
+    }
+
+    if (result.count("concurrent_models"))
+    {
+        for (auto& path : result["concurrent_models"].as<std::vector<std::string>>())
+        {
+            m_concurrentModelPaths.push_back(path);
+        }
+    }
+
+    if (result.count("open_loop_rates"))
+    {
+        // Tokenize rate string (e.g "100,200.5") by commas -> [100,200.5]
+        auto ratesStr = result["open_loop_rates"].as<std::string>();
+        size_t startPos = 0;
+        while (startPos != std::string::npos)
+        {
+            size_t endPos = ratesStr.find(",", startPos);
+            m_openLoopRates.push_back(std::stod(ratesStr.substr(startPos, endPos - startPos)));
+            startPos = endPos == std::string::npos ? std::string::npos : endPos + 1;
+        }
+    }
+
+    if (result.count("arrival_process"))
+    {
+        auto arrivalProcess = result["arrival_process"].as<std::string>();
+        if (arrivalProcess == "poisson")
+        {
+            m_arrivalProcess = ArrivalProcess::Poisson;
+        }
+        else if (arrivalProcess == "constant")
+        {
+            m_arrivalProcess = ArrivalProcess::Constant;
+        }
+        else
+        {
+            throw std::invalid_argument("Unexpected value for arrival_process. Must be 'poisson' or 'constant'");
+        }
+    }
+
+    if (result.count("arrival_trace"))
+    {
+        std::filesystem::path tracePath = result["arrival_trace"].as<std::string>();
+        std::ifstream traceFile(tracePath);
+        if (!traceFile)
+        {
+            throw std::invalid_argument(fmt::format("Could not open arrival_trace '{}'", tracePath.string()));
+        }
+        m_arrivalTraceIntervals = ArrivalSchedule::ParseTrace(traceFile);
+        if (m_arrivalTraceIntervals.empty())
+        {
+            throw std::invalid_argument("arrival_trace must contain at least one interval");
+        }
+    }
+
+    if (OpenLoopEnabled())
+    {
+        for (auto rate : m_openLoopRates)
+        {
+            if (!(rate > 0))
+            {
+                throw std::invalid_argument("open_loop_rates must be positive");
+            }
+        }
+
+        if (m_minDispatchIntervalInMilliseconds > 0 || m_replayDispatches || m_recordThreads > 0 || m_queueCount > 1)
+        {
+            throw std::invalid_argument("open-loop runs can't be combined with dispatch_interval, replay, record_threads, or queue_count greater than 1");
+        }
+    }
+
+    if (result.count("copy_queue_uploads"))
+    {
+        m_useCopyQueueForUploads = result["copy_queue_uploads"].as<bool>();
+    }
+
     if (result.count("xbox_allow_precompile") && result["xbox_allow_precompile"].as<bool>())
     {
         m_forceDisablePrecompiledShadersOnXbox = false;
@@ -453,6 +719,16 @@ CommandLineArgs::CommandLineArgs(int argc, char** argv)
         m_pixCaptureName = result["pix_capture_name"].as<std::string>();
     }
 
+    if (result.count("trace_file"))
+    {
+        m_traceFilePath = result["trace_file"].as<std::string>();
+    }
+
+    if (result.count("memory_report_file"))
+    {
+        m_memoryReportFilePath = result["memory_report_file"].as<std::string>();
+    }
+
     auto ParseFreeDimensionOverrides = [&](const char* parameterName, std::vector<std::pair<std::string, uint32_t>>& overrides)
     {
         if (result.count(parameterName))
@@ -507,32 +783,63 @@ CommandLineArgs::CommandLineArgs(int argc, char** argv)
     }
 
     // Parse binding shapes
+    auto ParseBindingShape = [](const std::string& bindingShapeArg, std::unordered_map<std::string, std::vector<int64_t>>& bindingShapes)
+    {
+        auto splitPos = bindingShapeArg.rfind(":");
+        if (splitPos == std::string::npos)
+        {
+            throw std::invalid_argument("Expected ':' separating tensor name and its shape");
+        }
+        auto tensorName = bindingShapeArg.substr(0, splitPos);
+        auto tensorShapeStr = bindingShapeArg.substr(splitPos + 1);
+
+        // Tokenize shape string (e.g "1,2,15,8") by commas -> [1,2,15,8]
+        std::vector<int64_t> shape;
+
+        size_t startPos = 0;
+        while (startPos != std::string::npos)
+        {
+            size_t endPos = tensorShapeStr.find(",", startPos + 1);
+            auto substr = tensorShapeStr.substr(startPos, endPos - startPos);
+            shape.push_back(std::stoll(substr));
+            startPos = endPos == std::string::npos ? std::string::npos : endPos + 1;
+        }
+
+        bindingShapes[tensorName] = std::move(shape);
+    };
+
     if (result.count("binding_shape"))
     {
-        auto bindingShapes = result["binding_shape"].as<std::vector<std::string>>(); 
+        auto bindingShapes = result["binding_shape"].as<std::vector<std::string>>();
         for (auto& bindingShapeArg : bindingShapes)
         {
-            auto splitPos = bindingShapeArg.rfind(":");
-            if (splitPos == std::string::npos)
-            {
-                throw std::invalid_argument("Expected ':' separating tensor name and its shape");
-            }
-            auto tensorName = bindingShapeArg.substr(0, splitPos);
-            auto tensorShapeStr = bindingShapeArg.substr(splitPos + 1);
+            ParseBindingShape(bindingShapeArg, m_onnxBindShapes);
+        }
+    }
 
-            // Tokenize shape string (e.g "1,2,15,8") by commas -> [1,2,15,8]
-            std::vector<int64_t> shape;
+    // Each sweep step is a ';'-separated list of binding shapes (e.g. "x:1,128;mask:1,128").
+    if (result.count("binding_shape_sweep"))
+    {
+        for (auto& sweepArg : result["binding_shape_sweep"].as<std::vector<std::string>>())
+        {
+            OnnxBindingShapes step;
+            step.label = sweepArg;
+            std::replace(step.label.begin(), step.label.end(), ';', ' ');
 
             size_t startPos = 0;
             while (startPos != std::string::npos)
             {
-                size_t endPos = tensorShapeStr.find(",", startPos + 1);
-                auto substr = tensorShapeStr.substr(startPos, endPos - startPos);
-                shape.push_back(std::stoll(substr));
+                size_t endPos = sweepArg.find(";", startPos);
+                ParseBindingShape(sweepArg.substr(startPos, endPos - startPos), step.shapes);
                 startPos = endPos == std::string::npos ? std::string::npos : endPos + 1;
             }
 
-            m_onnxBindShapes[tensorName] = std::move(shape);
+            m_onnxBindingShapeSweep.push_back(std::move(step));
+        }
+
+        if (!m_onnxBindingShapeSweep.empty() && OpenLoopEnabled())
+        {
+            throw std::invalid_argument("binding_shape_sweep can't be combined with open_loop_rates or arrival_trace");
         }
     }
 
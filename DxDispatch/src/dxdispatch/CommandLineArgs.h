@@ -9,6 +9,19 @@ enum TimingVerbosity
     All
 };
 
+enum class ArrivalProcess
+{
+    Poisson,
+    Constant
+};
+
+// Shapes of ONNX tensors (by name) for one step of a binding shape sweep.
+struct OnnxBindingShapes
+{
+    std::string label;
+    std::unordered_map<std::string, std::vector<int64_t>> shapes;
+};
+
 class CommandLineArgs
 {
 public:
@@ -19,6 +32,12 @@ public:
     bool ShowDependencies() const { return m_showDependencies; }
     bool PrintHelp() const { return m_printHelp; }
     bool PrintHlslDisassembly() const { return m_printHlslDisassembly; }
+    const std::optional<std::filesystem::path>& ShaderCacheDirectory() const { return m_shaderCacheDirectory; }
+    uint64_t ShaderCacheSizeInBytes() const { return m_shaderCacheSizeInBytes; }
+    uint32_t CompileThreads() const { return m_compileThreads; }
+    bool LazyInit() const { return m_lazyInit || m_releaseResources; }
+    bool ReleaseResources() const { return m_releaseResources; }
+    bool AliasResources() const { return m_aliasResources; }
     bool DebugLayersEnabled() const { return m_debugLayersEnabled; }
     TimingVerbosity GetTimingVerbosity() const { return m_timingVerbosity; }
     uint32_t MaxGpuTimeMeasurements() const { return m_maxGpuTimeMeasurements; }
@@ -43,6 +62,17 @@ public:
     std::optional<uint32_t> TimeToRunInMilliseconds() const { return m_timeToRunInMilliseconds; }
     uint32_t MinimumDispatchIntervalInMilliseconds() const { return m_minDispatchIntervalInMilliseconds; }
     uint32_t MaxWarmupSamples() const { return m_maxWarmupSamples; }
+    uint32_t FramesInFlight() const { return m_framesInFlight; }
+    uint32_t QueueCount() const { return m_queueCount; }
+    uint32_t RecordThreads() const { return m_recordThreads; }
+    bool ReplayDispatches() const { return m_replayDispatches; }
+    bool UseCopyQueueForUploads() const { return m_useCopyQueueForUploads; }
+    bool OpenLoopEnabled() const { return !m_openLoopRates.empty() || !m_arrivalTraceIntervals.empty(); }
+    const std::vector<double>& OpenLoopRates() const { return m_openLoopRates; }
+    ArrivalProcess GetArrivalProcess() const { return m_arrivalProcess; }
+    const std::vector<double>& ArrivalTraceIntervals() const { return m_arrivalTraceIntervals; }
+    uint32_t InstanceCount() const { return m_instanceCount; }
+    const std::vector<std::filesystem::path>& ConcurrentModelPaths() const { return m_concurrentModelPaths; }
     D3D12_COMMAND_LIST_TYPE CommandListType() const 
     {
         if (D3D12_COMMAND_LIST_TYPE_NONE == m_commandListType)
@@ -53,10 +83,13 @@ public:
     }
     PixCaptureType GetPixCaptureType() const { return m_pixCaptureType; }
     const std::string& PixCaptureName() const { return m_pixCaptureName; }
+    const std::optional<std::filesystem::path>& TraceFilePath() const { return m_traceFilePath; }
+    const std::optional<std::filesystem::path>& MemoryReportFilePath() const { return m_memoryReportFilePath; }
 
     bool GetPresentSeparator() const { return m_presentSeparator; }
     bool GetUavBarrierAfterDispatch() const { return m_uavBarrierAfterDispatch; }
     bool GetAliasingBarrierAfterDispatch() const { return m_aliasingBarrierAfterDispatch; }
+    bool GetAutoBarriersAfterDispatch() const { return m_autoBarriersAfterDispatch; }
     bool  PrintCommands() const { return m_commandPrinting; }
 
     // ONNX
@@ -64,6 +97,7 @@ public:
     gsl::span<const std::pair<std::string, uint32_t>> GetOnnxFreeDimensionDenotationOverrides() const { return m_onnxFreeDimensionDenotationOverrides; }
     gsl::span<const std::pair<std::string, std::string>> GetOnnxSessionOptionConfigEntries() const { return m_onnxSessionOptionConfigEntries; }
     const std::unordered_map<std::string, std::vector<int64_t>>& GetOnnxBindingShapes() const { return m_onnxBindShapes; }
+    const std::vector<OnnxBindingShapes>& GetOnnxBindingShapeSweep() const { return m_onnxBindingShapeSweep; }
     std::optional<uint32_t> GetOnnxGraphOptimizationLevel() const { return m_onnxGraphOptimizationLevel; }
     std::optional<uint32_t> GetOnnxLoggingLevel() const { return m_onnxLoggingLevel; }
     bool PrintVerboseOnnxBindingInfo() const { return m_onnxPrintVerboseBindingInfo; } 
@@ -76,6 +110,12 @@ private:
     bool m_showDependencies = false;
     bool m_printHelp = false;
     bool m_printHlslDisassembly = false;
+    std::optional<std::filesystem::path> m_shaderCacheDirectory;
+    uint64_t m_shaderCacheSizeInBytes = 256 * 1024 * 1024;
+    uint32_t m_compileThreads = 0;
+    bool m_lazyInit = false;
+    bool m_releaseResources = false;
+    bool m_aliasResources = false;
     bool m_debugLayersEnabled = false;
     TimingVerbosity m_timingVerbosity = TimingVerbosity::Basic;
     uint32_t m_maxGpuTimeMeasurements = 8192;
@@ -90,18 +130,31 @@ private:
     bool m_presentSeparator = false;
     bool m_uavBarrierAfterDispatch = true;
     bool m_aliasingBarrierAfterDispatch = false;
+    bool m_autoBarriersAfterDispatch = false;
     DML_FEATURE_LEVEL m_dmlFeatureLevel = DML_FEATURE_LEVEL_5_0;
     std::string m_adapterSubstring = "";
     std::optional<std::filesystem::path> m_modelPath;
     std::optional<std::filesystem::path> m_inputRelPath;
     std::optional<std::filesystem::path> m_outputRelPath;
     std::string m_pixCaptureName = "dxdispatch";
+    std::optional<std::filesystem::path> m_traceFilePath;
+    std::optional<std::filesystem::path> m_memoryReportFilePath;
     std::string m_helpText;
     uint32_t m_dispatchIterations = 1;
     uint32_t m_dispatchRepeat = 1;
     std::optional<uint32_t> m_timeToRunInMilliseconds = {};
     uint32_t m_minDispatchIntervalInMilliseconds = 0;
     uint32_t m_maxWarmupSamples = 1;
+    uint32_t m_framesInFlight = 1;
+    uint32_t m_queueCount = 1;
+    uint32_t m_recordThreads = 0;
+    bool m_replayDispatches = false;
+    bool m_useCopyQueueForUploads = false;
+    std::vector<double> m_openLoopRates;
+    ArrivalProcess m_arrivalProcess = ArrivalProcess::Poisson;
+    std::vector<double> m_arrivalTraceIntervals; // Milliseconds.
+    uint32_t m_instanceCount = 1;
+    std::vector<std::filesystem::path> m_concurrentModelPaths;
 
     // Tools like PIX generally work better when work is recorded into a graphics queue, so it's set as the default here.
     D3D12_COMMAND_LIST_TYPE m_commandListType = D3D12_COMMAND_LIST_TYPE_NONE;
@@ -123,6 +176,7 @@ private:
     // Optional binding shapes for dynamically shaped tensors.
     // Maps ONNX tensor names to a specific shape that should be used when binding the tensor to a resource/OrtValue.
     std::unordered_map<std::string, std::vector<int64_t>> m_onnxBindShapes;
+    std::vector<OnnxBindingShapes> m_onnxBindingShapeSweep;
 
     std::optional<uint32_t> m_onnxGraphOptimizationLevel;
     std::optional<uint32_t> m_onnxLoggingLevel;
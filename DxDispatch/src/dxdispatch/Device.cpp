@@ -1,5 +1,7 @@
 #include "pch.h"
 #include "Device.h"
+#include "PhaseTiming.h"
+#include "SharedCache.h"
 
 using Microsoft::WRL::ComPtr;
 
@@ -7,6 +9,64 @@ using Microsoft::WRL::ComPtr;
 static const GUID PIX_EVAL_CAPTURABLE_WORK_GUID =
 { 0x59da69, 0xb561, 0x43d9, { 0xa3, 0x9b, 0x33, 0x55, 0x7, 0x4b, 0x10, 0x82 } };
 
+// Attached to tracked D3D objects as private data, which is released when the object is destroyed.
+MIDL_INTERFACE("3F1C8A52-6D4E-4B7A-9E21-5C0D8B7F4A13")
+ITrackedMemory : public IUnknown
+{
+};
+
+#ifndef WIN32
+WINADAPTER_IID(ITrackedMemory, 0x3F1C8A52, 0x6D4E, 0x4B7A, 0x9E, 0x21, 0x5C, 0x0D, 0x8B, 0x7F, 0x4A, 0x13);
+#endif
+
+class TrackedMemory : public Microsoft::WRL::Base<ITrackedMemory>
+{
+public:
+    TrackedMemory(std::shared_ptr<MemoryTracker> tracker, MemoryCategory category, uint64_t sizeInBytes) :
+        m_tracker(std::move(tracker)), m_category(category), m_sizeInBytes(sizeInBytes)
+    {
+        m_tracker->Allocate(m_category, m_sizeInBytes);
+    }
+
+protected:
+    virtual ~TrackedMemory()
+    {
+        m_tracker->Free(m_category, m_sizeInBytes);
+    }
+
+private:
+    std::shared_ptr<MemoryTracker> m_tracker;
+    MemoryCategory m_category;
+    uint64_t m_sizeInBytes;
+};
+
+// Size of the device's shader-visible descriptor heap, which is split into a persistent region followed by a 
+// transient (ring) region.
+static constexpr uint32_t c_persistentDescriptorCount = 65536;
+static constexpr uint32_t c_transientDescriptorCount = 65536;
+
+// The upload staging ring starts small and doubles whenever an upload doesn't fit. Beyond the maximum size, pending
+// uploads are submitted so their space can be reused instead.
+static constexpr uint64_t c_initialStagingBufferSize = 16 * 1024 * 1024;
+static constexpr uint64_t c_maxStagingBufferSize = 256 * 1024 * 1024;
+static constexpr uint64_t c_stagingAlignment = 256;
+
+// Upload data of at least this size is copied into staging memory by multiple threads, in chunks.
+static constexpr uint64_t c_parallelCopyThreshold = 8 * 1024 * 1024;
+static constexpr uint64_t c_parallelCopyChunkSize = 1024 * 1024;
+
+// Numbers devices in creation order, to tell apart the GPU tracks of devices that share a trace.
+static std::atomic<uint32_t> s_nextTraceDeviceNumber = 1;
+
+// DirectML devices are shared by all Devices (of any IDxDispatch instance in the process) created with the same D3D12
+// device and settings. D3D12 devices are singletons per adapter, and operators compiled on a shared DML device can be
+// shared as well.
+static SharedCache<ComPtr<IDMLDevice1>>& GetDmlDeviceCache()
+{
+    static SharedCache<ComPtr<IDMLDevice1>> cache;
+    return cache;
+}
+
 // Callback to log D3D12/DirectML debug messages.
 #ifdef _GAMING_XBOX
 static bool DebugMessageCallback(void* context, void* commandList, DWORD messageId, const CHAR* message)
@@ -61,6 +121,9 @@ Device::Device(
     bool preferCustomHeaps,
     bool usePresentSeparator,
     uint32_t maxGpuTimeMeasurements,
+    uint32_t framesInFlight,
+    uint32_t queueCount,
+    bool useCopyQueueForUploads,
     std::shared_ptr<PixCaptureHelper> pixCaptureHelper,
     std::shared_ptr<D3d12Module> d3dModule,
     std::shared_ptr<DmlModule> dmlModule,
@@ -72,7 +135,8 @@ Device::Device(
         m_logger(logger),
         m_restoreBackgroundProcessing(disableBackgroundProcessing),
         m_restoreStablePowerState(setStablePowerState),
-        m_useCustomHeaps(preferCustomHeaps)
+        m_useCustomHeaps(preferCustomHeaps),
+        m_traceDeviceNumber(s_nextTraceDeviceNumber++)
 {
     DML_CREATE_DEVICE_FLAGS dmlCreateDeviceFlags = debugLayersEnabled ? DML_CREATE_DEVICE_FLAG_DEBUG : DML_CREATE_DEVICE_FLAG_NONE;
 
@@ -216,19 +280,56 @@ Device::Device(
 
 #endif // !_GAMING_XBOX
 
-    THROW_IF_FAILED(m_d3d->CreateFence(
-        0, 
-        D3D12_FENCE_FLAG_NONE, 
-        IID_GRAPHICS_PPV_ARGS(m_fence.ReleaseAndGetAddressOf())));
+    if (queueCount == 0)
+    {
+        throw std::invalid_argument("The device requires at least one queue.");
+    }
 
     D3D12_COMMAND_QUEUE_DESC queueDesc = {};
     queueDesc.Flags = disableGpuTimeout ? D3D12_COMMAND_QUEUE_FLAG_DISABLE_GPU_TIMEOUT : D3D12_COMMAND_QUEUE_FLAG_NONE;
     queueDesc.Type = commandListType;
-    THROW_IF_FAILED(m_d3d->CreateCommandQueue(
-        &queueDesc, 
-        IID_GRAPHICS_PPV_ARGS(m_queue.ReleaseAndGetAddressOf())));
     m_commandListType = queueDesc.Type;
 
+    for (uint32_t i = 0; i < queueCount; i++)
+    {
+        auto queue = std::make_unique<Queue>();
+
+        THROW_IF_FAILED(m_d3d->CreateFence(
+            0, 
+            D3D12_FENCE_FLAG_NONE, 
+            IID_GRAPHICS_PPV_ARGS(queue->fence.ReleaseAndGetAddressOf())));
+
+        THROW_IF_FAILED(m_d3d->CreateCommandQueue(
+            &queueDesc, 
+            IID_GRAPHICS_PPV_ARGS(queue->queue.ReleaseAndGetAddressOf())));
+
+        queue->fenceTimeline = std::make_unique<QueueFenceTimeline>(queue->queue.Get(), queue->fence.Get());
+        queue->frameRing = std::make_unique<FrameRing>(queue->fenceTimeline.get(), framesInFlight);
+        m_queues.push_back(std::move(queue));
+    }
+    m_activeQueue = m_queues.front().get();
+
+    if (useCopyQueueForUploads)
+    {
+        D3D12_COMMAND_QUEUE_DESC copyQueueDesc = {};
+        copyQueueDesc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+        m_copyQueue = std::make_unique<Queue>();
+
+        THROW_IF_FAILED(m_d3d->CreateFence(
+            0, 
+            D3D12_FENCE_FLAG_NONE, 
+            IID_GRAPHICS_PPV_ARGS(m_copyQueue->fence.ReleaseAndGetAddressOf())));
+
+        THROW_IF_FAILED(m_d3d->CreateCommandQueue(
+            &copyQueueDesc, 
+            IID_GRAPHICS_PPV_ARGS(m_copyQueue->queue.ReleaseAndGetAddressOf())));
+
+        // Two frames let the next batch of uploads be recorded while the previous one executes.
+        m_copyQueue->fenceTimeline = std::make_unique<QueueFenceTimeline>(m_copyQueue->queue.Get(), m_copyQueue->fence.Get());
+        m_copyQueue->frameRing = std::make_unique<FrameRing>(m_copyQueue->fenceTimeline.get(), 2);
+    }
+    m_uploadQueue = m_copyQueue ? m_copyQueue.get() : m_queues.front().get();
+
 #if defined(INCLUDE_DXGI)
     // Create dummy swapchain for frame indication
     if (usePresentSeparator)
@@ -248,7 +349,7 @@ Device::Device(
         desc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL;
         desc.AlphaMode = DXGI_ALPHA_MODE_IGNORE;
         desc.Flags = DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING;
-        const auto hr = factory->CreateSwapChainForComposition(m_queue.Get(), &desc, nullptr, m_dummySwapChain.GetAddressOf());
+        const auto hr = factory->CreateSwapChainForComposition(m_activeQueue->queue.Get(), &desc, nullptr, m_dummySwapChain.GetAddressOf());
         if (FAILED(hr))
         {
             m_logger->LogWarning("Creating dummy swap chain for present seperator failed");
@@ -256,25 +357,98 @@ Device::Device(
     }
 #endif
 
-    THROW_IF_FAILED(m_dmlModule->CreateDevice1(
-        m_d3d.Get(), 
-        dmlCreateDeviceFlags, 
-        dmlFeatureLevel, 
-        IID_PPV_ARGS(&m_dml)));
+    // The module handle identifies the DirectML library; it's the same for every instance that loads the same library.
+    auto dmlDeviceKey = fmt::format(
+        "{}:{}:{}:{}", 
+        static_cast<const void*>(m_dmlModule->GetHandle()), 
+        static_cast<const void*>(m_d3d.Get()), 
+        static_cast<uint32_t>(dmlCreateDeviceFlags), 
+        static_cast<uint32_t>(dmlFeatureLevel));
 
-    THROW_IF_FAILED(m_d3d->CreateCommandAllocator(
-        m_commandListType,
-        IID_GRAPHICS_PPV_ARGS(m_commandAllocator.ReleaseAndGetAddressOf())));
+    m_sharedDml = GetDmlDeviceCache().GetOrCreate(dmlDeviceKey, [&]
+    {
+        ComPtr<IDMLDevice1> dml;
+        THROW_IF_FAILED(m_dmlModule->CreateDevice1(
+            m_d3d.Get(), 
+            dmlCreateDeviceFlags, 
+            dmlFeatureLevel, 
+            IID_PPV_ARGS(&dml)));
+        return dml;
+    });
+    m_dml = *m_sharedDml;
+
+    // Shared objects are keyed by the adapter's LUID rather than by device pointers, since a pointer only identifies a
+    // device while it's alive. The feature levels, DML library, and DML device flags are included because they change
+    // what's compiled.
+    auto adapterLuid = m_d3d->GetAdapterLuid();
+    m_d3dCacheKey = fmt::format(
+        "{:08x}{:08x}:{}", 
+        static_cast<uint32_t>(adapterLuid.HighPart), 
+        adapterLuid.LowPart, 
+        static_cast<uint32_t>(featureLevel));
+    m_dmlCacheKey = fmt::format(
+        "{}:{}:{}:{}", 
+        m_d3dCacheKey, 
+        static_cast<const void*>(m_dmlModule->GetHandle()), 
+        static_cast<uint32_t>(dmlCreateDeviceFlags), 
+        static_cast<uint32_t>(dmlFeatureLevel));
+
+    for (auto& queue : m_queues)
+    {
+        queue->frames.resize(queue->frameRing->FrameCount());
+        for (auto& frame : queue->frames)
+        {
+            THROW_IF_FAILED(m_d3d->CreateCommandAllocator(
+                m_commandListType,
+                IID_GRAPHICS_PPV_ARGS(frame.commandAllocator.ReleaseAndGetAddressOf())));
+        }
 
-    THROW_IF_FAILED(m_d3d->CreateCommandList(
-        0,
-        m_commandListType,
-        m_commandAllocator.Get(),
-        nullptr,
-        IID_GRAPHICS_PPV_ARGS(m_commandList.ReleaseAndGetAddressOf())));
+        THROW_IF_FAILED(m_d3d->CreateCommandList(
+            0,
+            m_commandListType,
+            queue->frames[queue->frameRing->CurrentFrameIndex()].commandAllocator.Get(),
+            nullptr,
+            IID_GRAPHICS_PPV_ARGS(queue->commandList.ReleaseAndGetAddressOf())));
+    }
+
+    if (m_copyQueue)
+    {
+        m_copyQueue->frames.resize(m_copyQueue->frameRing->FrameCount());
+        for (auto& frame : m_copyQueue->frames)
+        {
+            THROW_IF_FAILED(m_d3d->CreateCommandAllocator(
+                D3D12_COMMAND_LIST_TYPE_COPY,
+                IID_GRAPHICS_PPV_ARGS(frame.commandAllocator.ReleaseAndGetAddressOf())));
+        }
+
+        THROW_IF_FAILED(m_d3d->CreateCommandList(
+            0,
+            D3D12_COMMAND_LIST_TYPE_COPY,
+            m_copyQueue->frames[m_copyQueue->frameRing->CurrentFrameIndex()].commandAllocator.Get(),
+            nullptr,
+            IID_GRAPHICS_PPV_ARGS(m_copyQueue->commandList.ReleaseAndGetAddressOf())));
+    }
 
     THROW_IF_FAILED(m_dml->CreateCommandRecorder(IID_PPV_ARGS(&m_commandRecorder)));
 
+    D3D12_DESCRIPTOR_HEAP_DESC descriptorHeapDesc = {};
+    descriptorHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+    descriptorHeapDesc.NumDescriptors = c_persistentDescriptorCount + c_transientDescriptorCount;
+    descriptorHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+    THROW_IF_FAILED(m_d3d->CreateDescriptorHeap(
+        &descriptorHeapDesc, 
+        IID_GRAPHICS_PPV_ARGS(m_descriptorHeap.ReleaseAndGetAddressOf())));
+    m_descriptorIncrementSize = m_d3d->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    TrackMemory(m_descriptorHeap.Get(), MemoryCategory::DescriptorHeaps);
+    m_persistentDescriptors = std::make_unique<FreeListAllocator>(m_queues.front()->fenceTimeline.get(), c_persistentDescriptorCount);
+    m_transientDescriptors = std::make_unique<RingAllocator>(m_queues.front()->fenceTimeline.get(), c_transientDescriptorCount);
+
+    ID3D12DescriptorHeap* descriptorHeaps[] = { m_descriptorHeap.Get() };
+    for (auto& queue : m_queues)
+    {
+        queue->commandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
+    }
+
     // Each GPU time measurement requires a pair of timestamps
     m_timestampCapacity = maxGpuTimeMeasurements * 2;
 
@@ -286,9 +460,42 @@ Device::Device(
         queryHeapDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
 
         THROW_IF_FAILED(m_d3d->CreateQueryHeap(&queryHeapDesc, IID_PPV_ARGS(&m_timestampHeap)));
+
+        // Every query has a slot in the readback buffer at the same index, which stays mapped so that resolved
+        // values can be read as soon as their submission completes.
+        m_timestampReadbackBuffer = CreateReadbackBuffer(sizeof(uint64_t) * m_timestampCapacity);
+        m_timestampReadbackBuffer->SetName(L"Device::Timestamps");
+
+        void* resolvedTimestamps = nullptr;
+        THROW_IF_FAILED(m_timestampReadbackBuffer->Map(0, nullptr, &resolvedTimestamps));
+        THROW_IF_FAILED(m_queues.front()->queue->GetTimestampFrequency(&m_timestampFrequency));
+
+        m_timestampRing = std::make_unique<TimestampRing>(
+            m_timestampCapacity, 
+            static_cast<const uint64_t*>(resolvedTimestamps), 
+            [this, maxGpuTimeMeasurements](IFenceTimeline* timeline, uint64_t startTimestamp, uint64_t endTimestamp)
+        {
+            double sample = double((endTimestamp - startTimestamp) * 1000) / m_timestampFrequency / m_dispatchRepeat;
+
+            m_timingSamples.push_back(sample);
+            if (m_timingSamples.size() > maxGpuTimeMeasurements)
+            {
+                m_timingSamples.pop_front();
+            }
+
+            if (m_timingSampleCallback)
+            {
+                m_timingSampleCallback(sample);
+            }
+
+            if (auto traceRecorder = TraceRecorder::GetActive())
+            {
+                TraceGpuEvent(traceRecorder, timeline, startTimestamp, endTimestamp);
+            }
+        });
     }
 
-    m_pixCaptureHelper->Initialize(m_queue.Get());
+    m_pixCaptureHelper->Initialize(m_activeQueue->queue.Get());
 
     if (uavBarrierAfterDispatch)
     {
@@ -314,6 +521,29 @@ Device::~Device()
         m_callbackCookie = 0;
     }
 
+    // Temporary resources of in-flight frames must outlive the GPU work that references them.
+    for (auto& queue : m_queues)
+    {
+        try
+        {
+            queue->frameRing->WaitForAllFrames();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    if (m_copyQueue)
+    {
+        try
+        {
+            m_copyQueue->frameRing->WaitForAllFrames();
+        }
+        catch (...)
+        {
+        }
+    }
+
     if (m_d3d)
     {
         // Restore state for certain features that may have been toggled. Normally this isn't required,
@@ -338,6 +568,35 @@ Device::~Device()
     }
 }
 
+void Device::TrackMemory(ID3D12Object* object, MemoryCategory category)
+{
+    uint64_t sizeInBytes = 0;
+    ComPtr<ID3D12Resource> resource;
+    ComPtr<ID3D12Heap> heap;
+    ComPtr<ID3D12DescriptorHeap> descriptorHeap;
+    if (SUCCEEDED(object->QueryInterface(IID_GRAPHICS_PPV_ARGS(resource.GetAddressOf()))))
+    {
+        auto resourceDesc = resource->GetDesc();
+        sizeInBytes = m_d3d->GetResourceAllocationInfo(0, 1, &resourceDesc).SizeInBytes;
+    }
+    else if (SUCCEEDED(object->QueryInterface(IID_GRAPHICS_PPV_ARGS(heap.GetAddressOf()))))
+    {
+        sizeInBytes = heap->GetDesc().SizeInBytes;
+    }
+    else if (SUCCEEDED(object->QueryInterface(IID_GRAPHICS_PPV_ARGS(descriptorHeap.GetAddressOf()))))
+    {
+        auto heapDesc = descriptorHeap->GetDesc();
+        sizeInBytes = uint64_t(heapDesc.NumDescriptors) * m_d3d->GetDescriptorHandleIncrementSize(heapDesc.Type);
+    }
+    else
+    {
+        throw std::invalid_argument("Only resources, heaps, and descriptor heaps can be tracked");
+    }
+
+    auto trackedMemory = Microsoft::WRL::Make<TrackedMemory>(m_memoryTracker, category, sizeInBytes);
+    THROW_IF_FAILED(object->SetPrivateDataInterface(__uuidof(ITrackedMemory), trackedMemory.Get()));
+}
+
 Microsoft::WRL::ComPtr<ID3D12Resource> Device::CreatePreferredDeviceMemoryBuffer(
     uint64_t sizeInBytes, 
     D3D12_RESOURCE_FLAGS resourceFlags,
@@ -407,10 +666,49 @@ ComPtr<ID3D12Resource> Device::CreateUploadBuffer(
         D3D12_RESOURCE_STATE_GENERIC_READ,
         nullptr,
         IID_GRAPHICS_PPV_ARGS(resource.ReleaseAndGetAddressOf())));
+    TrackMemory(resource.Get(), MemoryCategory::UploadStaging);
 
     return resource;
 }
 
+ComPtr<ID3D12Heap> Device::CreatePreferredDeviceMemoryHeap(uint64_t sizeInBytes)
+{
+    constexpr uint64_t alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+
+    D3D12_HEAP_DESC heapDesc = {};
+    heapDesc.SizeInBytes = (sizeInBytes + alignment - 1) & ~(alignment - 1);
+    heapDesc.Properties = m_useCustomHeaps ? 
+        CD3DX12_HEAP_PROPERTIES(D3D12_CPU_PAGE_PROPERTY_WRITE_COMBINE, D3D12_MEMORY_POOL_L0, 0, 0) :
+        CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+    heapDesc.Alignment = alignment;
+    heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
+
+    ComPtr<ID3D12Heap> heap;
+    THROW_IF_FAILED(m_d3d->CreateHeap(&heapDesc, IID_GRAPHICS_PPV_ARGS(heap.ReleaseAndGetAddressOf())));
+    return heap;
+}
+
+ComPtr<ID3D12Resource> Device::CreatePlacedBuffer(ID3D12Heap* heap, uint64_t offset, uint64_t sizeInBytes, std::wstring_view name)
+{
+    auto resourceDesc = CD3DX12_RESOURCE_DESC::Buffer(sizeInBytes, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+
+    ComPtr<ID3D12Resource> buffer;
+    THROW_IF_FAILED(m_d3d->CreatePlacedResource(
+        heap,
+        offset,
+        &resourceDesc,
+        D3D12_RESOURCE_STATE_COMMON,
+        nullptr,
+        IID_GRAPHICS_PPV_ARGS(buffer.ReleaseAndGetAddressOf())));
+
+    if (!name.empty())
+    {
+        buffer->SetName(name.data());
+    }
+
+    return buffer;
+}
+
 ComPtr<ID3D12Resource> Device::CreateReadbackBuffer(
     uint64_t sizeInBytes,
     D3D12_RESOURCE_FLAGS resourceFlags,
@@ -428,62 +726,282 @@ ComPtr<ID3D12Resource> Device::CreateReadbackBuffer(
         D3D12_RESOURCE_STATE_COPY_DEST,
         nullptr,
         IID_GRAPHICS_PPV_ARGS(resource.ReleaseAndGetAddressOf())));
+    TrackMemory(resource.Get(), MemoryCategory::Readback);
 
     return resource;
 }
 
+Device::DescriptorRange Device::GetDescriptorRange(uint64_t offset, uint32_t count)
+{
+    DescriptorRange range = {};
+    range.offset = static_cast<uint32_t>(offset);
+    range.count = count;
+    range.cpuHandle = CD3DX12_CPU_DESCRIPTOR_HANDLE(m_descriptorHeap->GetCPUDescriptorHandleForHeapStart(), range.offset, m_descriptorIncrementSize);
+    range.gpuHandle = CD3DX12_GPU_DESCRIPTOR_HANDLE(m_descriptorHeap->GetGPUDescriptorHandleForHeapStart(), range.offset, m_descriptorIncrementSize);
+    return range;
+}
+
+// Descriptor ranges are retired on the primary queue's timeline (see SubmitCommandList), which doesn't cover work
+// submitted to other queues. Freeing doesn't throw, since it's called when dispatchables are destroyed.
+Device::DescriptorRange Device::AllocatePersistentDescriptors(uint32_t count)
+{
+    assert(m_activeQueue == m_queues.front().get());
+    return GetDescriptorRange(m_persistentDescriptors->Allocate(count), count);
+}
+
+void Device::FreePersistentDescriptors(const DescriptorRange& range)
+{
+    assert(m_activeQueue == m_queues.front().get());
+    m_persistentDescriptors->Free(range.offset, range.count);
+}
+
+Device::DescriptorRange Device::AllocateTransientDescriptors(uint32_t count)
+{
+    assert(m_activeQueue == m_queues.front().get());
+    return GetDescriptorRange(c_persistentDescriptorCount + m_transientDescriptors->Allocate(count), count);
+}
+
+void Device::ReserveTransientMemory(uint64_t sizeInBytes)
+{
+    m_transientPoolStats.reservedInBytes = std::max(m_transientPoolStats.reservedInBytes, sizeInBytes);
+}
+
+ComPtr<ID3D12Resource> Device::AcquireTransientBuffer(uint64_t sizeInBytes)
+{
+    ReserveTransientMemory(sizeInBytes);
+    m_transientPoolStats.requestCount++;
+    m_transientPoolStats.requestedInBytes += sizeInBytes;
+
+    // A queue's pool is recreated whenever the reservation outgrows it, so buffers acquired after all reservations
+    // are made share one heap. Buffers acquired from a previous heap remain valid (placed resources reference 
+    // their heap), but they no longer alias buffers acquired from the new heap.
+    auto& queue = *m_activeQueue;
+    if (queue.transientCapacityInBytes < m_transientPoolStats.reservedInBytes)
+    {
+        constexpr uint64_t alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+        uint64_t capacity = (m_transientPoolStats.reservedInBytes + alignment - 1) & ~(alignment - 1);
+
+        D3D12_HEAP_DESC heapDesc = {};
+        heapDesc.SizeInBytes = capacity;
+        heapDesc.Properties = m_useCustomHeaps ? 
+            CD3DX12_HEAP_PROPERTIES(D3D12_CPU_PAGE_PROPERTY_WRITE_COMBINE, D3D12_MEMORY_POOL_L0, 0, 0) :
+            CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+        heapDesc.Alignment = alignment;
+        heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
+        THROW_IF_FAILED(m_d3d->CreateHeap(&heapDesc, IID_GRAPHICS_PPV_ARGS(queue.transientHeap.ReleaseAndGetAddressOf())));
+        TrackMemory(queue.transientHeap.Get(), MemoryCategory::DmlTemporary);
+
+        auto resourceDesc = CD3DX12_RESOURCE_DESC::Buffer(capacity, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+        THROW_IF_FAILED(m_d3d->CreatePlacedResource(
+            queue.transientHeap.Get(),
+            0,
+            &resourceDesc,
+            D3D12_RESOURCE_STATE_COMMON,
+            nullptr,
+            IID_GRAPHICS_PPV_ARGS(queue.transientBuffer.ReleaseAndGetAddressOf())));
+        queue.transientBuffer->SetName(L"Device::TransientPool");
+
+        m_transientPoolStats.capacityInBytes += capacity - queue.transientCapacityInBytes;
+        m_transientPoolStats.heapCount++;
+        queue.transientCapacityInBytes = capacity;
+    }
+
+    return queue.transientBuffer;
+}
+
+uint64_t QueueFenceTimeline::Signal()
+{
+    THROW_IF_FAILED(m_queue->Signal(m_fence, m_lastSignaledValue + 1));
+    return ++m_lastSignaledValue;
+}
+
+uint64_t QueueFenceTimeline::GetCompletedValue()
+{
+    return m_fence->GetCompletedValue();
+}
+
+void QueueFenceTimeline::WaitForValue(uint64_t value)
+{
+    if (m_fence->GetCompletedValue() < value)
+    {
+        THROW_IF_FAILED(m_fence->SetEventOnCompletion(value, nullptr));
+    }
+}
+
 void Device::WaitForGpuWorkToComplete()
 {
-    uint64_t nextFenceValue = m_fence->GetCompletedValue() + 1;
-    THROW_IF_FAILED(m_queue->Signal(m_fence.Get(), nextFenceValue));
-    THROW_IF_FAILED(m_fence->SetEventOnCompletion(nextFenceValue, nullptr));
+    for (auto& queue : m_queues)
+    {
+        queue->fenceTimeline->WaitForValue(queue->fenceTimeline->Signal());
+    }
+
+    if (m_copyQueue)
+    {
+        m_copyQueue->fenceTimeline->WaitForValue(m_copyQueue->fenceTimeline->Signal());
+    }
+}
+
+void Device::SetActiveQueue(uint32_t queueIndex)
+{
+    if (queueIndex >= m_queues.size())
+    {
+        throw std::invalid_argument(fmt::format("Queue index {} is out of range; the device has {} queues.", queueIndex, m_queues.size()));
+    }
+    m_activeQueue = m_queues[queueIndex].get();
+}
+
+uint32_t Device::GetActiveQueue() const
+{
+    for (uint32_t i = 0; i < m_queues.size(); i++)
+    {
+        if (m_queues[i].get() == m_activeQueue)
+        {
+            return i;
+        }
+    }
+    return 0;
+}
+
+uint64_t Device::GetLastSubmittedFenceValue(uint32_t queueIndex) const
+{
+    return m_queues.at(queueIndex)->fenceTimeline->LastSignaledValue();
+}
+
+void Device::WaitForQueue(uint32_t queueIndex, uint64_t fenceValue)
+{
+    auto& queue = m_queues.at(queueIndex);
+    if (queue.get() != m_activeQueue)
+    {
+        THROW_IF_FAILED(m_activeQueue->queue->Wait(queue->fence.Get(), fenceValue));
+    }
 }
 
 void Device::RecordInitialize(IDMLDispatchable* dispatchable, IDMLBindingTable* bindingTable)
 {
-    m_commandRecorder->RecordDispatch(m_commandList.Get(), dispatchable, bindingTable);
+    FlushUploads();
+    m_commandRecorder->RecordDispatch(m_activeQueue->commandList.Get(), dispatchable, bindingTable);
 }
 
 void Device::RecordDispatch(IDMLDispatchable* dispatchable, IDMLBindingTable* bindingTable)
 {
+    FlushUploads();
+    RecordTimestamp();
+    RecordDispatch(GetRecordingTarget(), dispatchable, bindingTable);
+    RecordTimestamp();
+}
+
+void Device::RecordDispatch(const char* name, uint32_t threadGroupX, uint32_t threadGroupY, uint32_t threadGroupZ)
+{
+    FlushUploads();
+    RecordTimestamp();
+    RecordDispatch(GetRecordingTarget(), name, threadGroupX, threadGroupY, threadGroupZ);
     RecordTimestamp();
+}
 
+void Device::RecordDispatch(const RecordingTarget& target, IDMLDispatchable* dispatchable, IDMLBindingTable* bindingTable) const
+{
     for (uint32_t i = 0; i < m_dispatchRepeat; i++)
     {
-        m_commandRecorder->RecordDispatch(m_commandList.Get(), dispatchable, bindingTable);
-        if (!m_postDispatchBarriers.empty())
+        if (i > 0)
         {
-            if (m_postDispatchBarriers.size() > std::numeric_limits<uint32_t>::max())
-            {
-                throw std::invalid_argument(fmt::format("ResourceBarrier '{}' is too large.", m_postDispatchBarriers.size()));
-            }
-            m_commandList->ResourceBarrier(static_cast<uint32_t>(m_postDispatchBarriers.size()), m_postDispatchBarriers.data());
+            RecordBarriers(target.commandList, target.repeatBarriers);
         }
+        target.dmlCommandRecorder->RecordDispatch(target.commandList, dispatchable, bindingTable);
+        RecordBarriers(target.commandList, m_postDispatchBarriers);
     }
-
-    RecordTimestamp();
 }
 
-void Device::RecordDispatch(const char* name, uint32_t threadGroupX, uint32_t threadGroupY, uint32_t threadGroupZ)
+void Device::RecordDispatch(const RecordingTarget& target, const char* name, uint32_t threadGroupX, uint32_t threadGroupY, uint32_t threadGroupZ) const
 {
-    PIXBeginEvent(m_commandList.Get(), PIX_COLOR(255, 255, 0), "HLSL: '%s'", name);
-    RecordTimestamp();
-    
+    PIXBeginEvent(target.commandList, PIX_COLOR(255, 255, 0), "HLSL: '%s'", name);
+
     for (uint32_t i = 0; i < m_dispatchRepeat; i++)
     {
-        m_commandList->Dispatch(threadGroupX, threadGroupY, threadGroupZ);
-        if (!m_postDispatchBarriers.empty())
+        if (i > 0)
         {
-            if (m_postDispatchBarriers.size() > std::numeric_limits<uint32_t>::max())
-            {
-                throw std::invalid_argument(fmt::format("ResourceBarrier '{}' is too large.", m_postDispatchBarriers.size()));
-            }
-            m_commandList->ResourceBarrier(static_cast<uint32_t>(m_postDispatchBarriers.size()), m_postDispatchBarriers.data());
+            RecordBarriers(target.commandList, target.repeatBarriers);
         }
+        target.commandList->Dispatch(threadGroupX, threadGroupY, threadGroupZ);
+        RecordBarriers(target.commandList, m_postDispatchBarriers);
     }
 
-    RecordTimestamp();
-    PIXEndEvent(m_commandList.Get());
+    PIXEndEvent(target.commandList);
+}
+
+void Device::RecordBarriers(ID3D12GraphicsCommandList* commandList, gsl::span<const D3D12_RESOURCE_BARRIER> barriers) const
+{
+    if (!barriers.empty())
+    {
+        if (barriers.size() > std::numeric_limits<uint32_t>::max())
+        {
+            throw std::invalid_argument(fmt::format("ResourceBarrier '{}' is too large.", barriers.size()));
+        }
+        commandList->ResourceBarrier(static_cast<uint32_t>(barriers.size()), barriers.data());
+    }
+}
+
+Device::RecordingTarget Device::GetRecordingTarget()
+{
+    return { m_activeQueue->commandList.Get(), m_commandRecorder.Get(), m_repeatDispatchBarriers };
+}
+
+void Device::EnsureWorkerCommandLists(uint32_t count)
+{
+    auto& queue = *m_queues.front();
+    uint32_t currentFrameIndex = queue.frameRing->CurrentFrameIndex();
+    ID3D12DescriptorHeap* descriptorHeaps[] = { m_descriptorHeap.Get() };
+
+    for (uint32_t i = GetWorkerCommandListCount(); i < count; i++)
+    {
+        for (auto& frame : queue.frames)
+        {
+            ComPtr<ID3D12CommandAllocator> commandAllocator;
+            THROW_IF_FAILED(m_d3d->CreateCommandAllocator(
+                m_commandListType,
+                IID_GRAPHICS_PPV_ARGS(commandAllocator.GetAddressOf())));
+            frame.workerCommandAllocators.push_back(std::move(commandAllocator));
+        }
+
+        ComPtr<ID3D12GraphicsCommandList> commandList;
+        THROW_IF_FAILED(m_d3d->CreateCommandList(
+            0,
+            m_commandListType,
+            queue.frames[currentFrameIndex].workerCommandAllocators[i].Get(),
+            nullptr,
+            IID_GRAPHICS_PPV_ARGS(commandList.GetAddressOf())));
+        commandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
+        m_workerCommandLists.push_back(std::move(commandList));
+
+        ComPtr<IDMLCommandRecorder> commandRecorder;
+        THROW_IF_FAILED(m_dml->CreateCommandRecorder(IID_PPV_ARGS(&commandRecorder)));
+        m_workerCommandRecorders.push_back(std::move(commandRecorder));
+    }
+}
+
+Device::ReplayCommandList Device::CreateReplayCommandList()
+{
+    ReplayCommandList replayCommandList;
+    THROW_IF_FAILED(m_d3d->CreateCommandAllocator(
+        m_commandListType,
+        IID_GRAPHICS_PPV_ARGS(replayCommandList.commandAllocator.GetAddressOf())));
+
+    THROW_IF_FAILED(m_d3d->CreateCommandList(
+        0,
+        m_commandListType,
+        replayCommandList.commandAllocator.Get(),
+        nullptr,
+        IID_GRAPHICS_PPV_ARGS(replayCommandList.commandList.GetAddressOf())));
+
+    ID3D12DescriptorHeap* descriptorHeaps[] = { m_descriptorHeap.Get() };
+    replayCommandList.commandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
+
+    THROW_IF_FAILED(m_dml->CreateCommandRecorder(IID_PPV_ARGS(&replayCommandList.dmlCommandRecorder)));
+    return replayCommandList;
+}
+
+Device::RecordingTarget Device::GetWorkerRecordingTarget(uint32_t index)
+{
+    return { m_workerCommandLists.at(index).Get(), m_workerCommandRecorders.at(index).Get(), {} };
 }
 
 Microsoft::WRL::ComPtr<ID3D12Resource> Device::Upload(uint64_t totalSize, gsl::span<const std::byte> data, std::wstring_view name)
@@ -493,194 +1011,563 @@ Microsoft::WRL::ComPtr<ID3D12Resource> Device::Upload(uint64_t totalSize, gsl::s
         throw std::invalid_argument("Attempting to upload more data than the size of the buffer");
     }
 
-    ComPtr<ID3D12Resource> buffer;
-    ComPtr<ID3D12Resource> uploadBuffer;
-    ComPtr<ID3D12Resource> resourceToMap;
+    ComPtr<ID3D12Resource> buffer = m_useCustomHeaps ? CreateCustomBuffer(totalSize) : CreateDefaultBuffer(totalSize);
+    TrackMemory(buffer.Get(), MemoryCategory::ModelResources);
+
+    if (!name.empty())
+    {
+        buffer->SetName(name.data());
+    }
+
+    UploadTo(buffer.Get(), data);
+    return buffer;
+}
+
+// Buffers in custom heaps of system memory (L0) can be mapped, so they're read and written without staging copies.
+static bool IsCpuVisible(ID3D12Resource* buffer)
+{
+    // Can't assume the buffer was created as a custom heap (e.g., ONNX dispatchable with a deferred resource 
+    // allocated by the DML EP), so check the heap properties.
+    D3D12_HEAP_PROPERTIES heapProps = {};
+    D3D12_HEAP_FLAGS heapFlags = {};
+
+    return SUCCEEDED(buffer->GetHeapProperties(&heapProps, &heapFlags)) && 
+        heapProps.MemoryPoolPreference == D3D12_MEMORY_POOL_L0 && 
+        (heapProps.CPUPageProperty == D3D12_CPU_PAGE_PROPERTY_WRITE_COMBINE || heapProps.CPUPageProperty == D3D12_CPU_PAGE_PROPERTY_WRITE_BACK);
+}
+
+void Device::UploadTo(ID3D12Resource* buffer, gsl::span<const std::byte> data)
+{
+    if (data.size() > buffer->GetDesc().Width)
+    {
+        throw std::invalid_argument("Attempting to upload more data than the size of the buffer");
+    }
+
+    if (data.empty())
+    {
+        return;
+    }
 
-    if (m_useCustomHeaps)
+    m_uploadStats.uploadCount++;
+    m_uploadStats.uploadedInBytes += data.size();
+
+    if (IsCpuVisible(buffer))
     {
-        buffer = CreateCustomBuffer(totalSize);
-        resourceToMap = data.empty() ? nullptr : buffer;
+        // Custom heap buffers are CPU-visible, so the data is written directly.
+        void* mappedBufferData = nullptr;
+        THROW_IF_FAILED(buffer->Map(0, nullptr, &mappedBufferData));
+        CopyUploadData(mappedBufferData, data);
+        buffer->Unmap(0, nullptr);
     }
     else
     {
-        buffer = CreateDefaultBuffer(totalSize);
-        uploadBuffer = data.empty() ? nullptr : CreateUploadBuffer(totalSize);
-        uploadBuffer->SetName(L"Device::Upload");
-        resourceToMap = uploadBuffer;
+        uint64_t stagingOffset = AllocateStagingMemory(data.size());
+        CopyUploadData(m_stagingBufferData + stagingOffset, data);
+        m_pendingUploads.push_back({ buffer, m_stagingBuffer.Get(), stagingOffset, data.size() });
+    }
+}
+
+ComPtr<ID3D12Resource> Device::WrapHostMemory(void* data, uint64_t sizeInBytes, std::wstring_view name)
+{
+    if (reinterpret_cast<uintptr_t>(data) % D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT != 0)
+    {
+        throw std::invalid_argument(fmt::format("Host memory must be aligned to {} bytes to be wrapped", D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT));
     }
 
+    // The heap spans the whole allocation that contains the address, which may be larger than the buffer.
+    ComPtr<ID3D12Heap> heap;
+    THROW_IF_FAILED(m_d3d->OpenExistingHeapFromAddress(data, IID_GRAPHICS_PPV_ARGS(heap.GetAddressOf())));
+    if (heap->GetDesc().SizeInBytes < sizeInBytes)
+    {
+        throw std::invalid_argument("Host memory is smaller than the buffer it wraps");
+    }
+
+    // Heaps opened from an address are cross-adapter heaps, which only allow row-major resources.
+    auto resourceDesc = CD3DX12_RESOURCE_DESC::Buffer(
+        sizeInBytes, 
+        D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS | D3D12_RESOURCE_FLAG_ALLOW_CROSS_ADAPTER);
+
+    ComPtr<ID3D12Resource> buffer;
+    THROW_IF_FAILED(m_d3d->CreatePlacedResource(
+        heap.Get(),
+        0,
+        &resourceDesc,
+        D3D12_RESOURCE_STATE_COMMON,
+        nullptr,
+        IID_GRAPHICS_PPV_ARGS(buffer.ReleaseAndGetAddressOf())));
+
     if (!name.empty())
     {
         buffer->SetName(name.data());
     }
 
-    if (resourceToMap)
+    return buffer;
+}
+
+uint64_t Device::AllocateStagingMemory(uint64_t sizeInBytes)
+{
+    uint64_t alignedSize = (sizeInBytes + c_stagingAlignment - 1) / c_stagingAlignment * c_stagingAlignment;
+
+    if (m_stagingRing)
     {
-        void* mappedBufferData = nullptr;
-        THROW_IF_FAILED(resourceToMap->Map(0, nullptr, &mappedBufferData));
-        memcpy(mappedBufferData, data.data(), data.size());
-        resourceToMap->Unmap(0, nullptr);
+        auto offset = m_stagingRing->TryAllocate(alignedSize);
+        if (offset)
+        {
+            return *offset;
+        }
 
-        if (resourceToMap == uploadBuffer)
+        // Uploads can only be submitted early if they're recorded into the active queue (or a copy queue).
+        bool canSubmitUploads = m_copyQueue || m_activeQueue == m_uploadQueue;
+        if (canSubmitUploads && alignedSize <= m_stagingRing->Capacity() && m_stagingRing->Capacity() >= c_maxStagingBufferSize)
         {
-            D3D12_RESOURCE_BARRIER barriers[] =
+            m_uploadStats.stagingFlushCount++;
+            if (m_copyQueue)
             {
-                CD3DX12_RESOURCE_BARRIER::Transition(
-                    buffer.Get(),
-                    D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
-                    D3D12_RESOURCE_STATE_COPY_DEST)
-            };
-
-            m_commandList->ResourceBarrier(_countof(barriers), barriers);
-            m_commandList->CopyResource(buffer.Get(), uploadBuffer.Get());
-            std::swap(barriers[0].Transition.StateBefore, barriers[0].Transition.StateAfter);
-            m_commandList->ResourceBarrier(_countof(barriers), barriers);
+                FlushUploads();
+            }
+            else
+            {
+                ExecuteCommandList();
+            }
 
-            m_temporaryResources.push_back(std::move(uploadBuffer));
+            // Everything in the ring is submitted, so this only waits for the GPU to consume enough of it.
+            return m_stagingRing->Allocate(alignedSize);
         }
     }
 
-    return buffer;
+    // Replace the staging buffer with a larger one. Pending copies from the old buffer keep it alive until the
+    // upload queue finishes the current frame.
+    uint64_t capacity = std::max(alignedSize, m_stagingRing ? m_stagingRing->Capacity() * 2 : c_initialStagingBufferSize);
+    if (m_stagingBuffer)
+    {
+        m_uploadQueue->frames[m_uploadQueue->frameRing->CurrentFrameIndex()].temporaryResources.push_back(std::move(m_stagingBuffer));
+    }
+
+    m_stagingBuffer = CreateUploadBuffer(capacity);
+    m_stagingBuffer->SetName(L"Device::Upload");
+
+    // Upload heap buffers can stay mapped for their whole lifetime.
+    void* mappedBufferData = nullptr;
+    THROW_IF_FAILED(m_stagingBuffer->Map(0, nullptr, &mappedBufferData));
+    m_stagingBufferData = static_cast<std::byte*>(mappedBufferData);
+
+    m_stagingRing = std::make_unique<RingAllocator>(m_uploadQueue->fenceTimeline.get(), capacity);
+    m_uploadStats.stagingCapacityInBytes = capacity;
+    m_uploadStats.stagingBufferCount++;
+
+    return m_stagingRing->Allocate(alignedSize);
 }
 
-std::vector<std::byte> Device::Download(Microsoft::WRL::ComPtr<ID3D12Resource> buffer)
+void Device::CopyUploadData(void* destination, gsl::span<const std::byte> data)
 {
-    if (buffer->GetDesc().Width > std::numeric_limits<size_t>::max())
+    uint32_t threadCount = std::min(std::thread::hardware_concurrency(), 8u);
+    if (data.size() < c_parallelCopyThreshold || threadCount <= 1)
     {
-        throw std::invalid_argument(fmt::format("Buffer width '{}' is too large.", buffer->GetDesc().Width));
+        memcpy(destination, data.data(), data.size());
+        return;
     }
 
-    ComPtr<ID3D12Resource> resourceToMap;
+    if (!m_uploadThreadPool)
+    {
+        m_uploadThreadPool = std::make_unique<ThreadPool>(threadCount);
+    }
 
-    // Can't assume the input buffer was created as a custom heap (e.g., ONNX dispatchable with a deferred
-    // resource allocated by the DML EP), so check the heap properties.
-    D3D12_HEAP_PROPERTIES heapProps = {};
-    D3D12_HEAP_FLAGS heapFlags = {};
+    size_t chunkCount = (data.size() + c_parallelCopyChunkSize - 1) / c_parallelCopyChunkSize;
+    m_uploadThreadPool->ParallelFor(chunkCount, [&](size_t chunk)
+    {
+        size_t offset = chunk * c_parallelCopyChunkSize;
+        size_t size = std::min<size_t>(c_parallelCopyChunkSize, data.size() - offset);
+        memcpy(static_cast<std::byte*>(destination) + offset, data.data() + offset, size);
+    });
+}
 
-    if (SUCCEEDED(buffer->GetHeapProperties(&heapProps, &heapFlags)) && 
-        heapProps.MemoryPoolPreference == D3D12_MEMORY_POOL_L0 && 
-        heapProps.CPUPageProperty == D3D12_CPU_PAGE_PROPERTY_WRITE_COMBINE)
+void Device::FlushUploads()
+{
+    if (m_pendingUploads.empty())
     {
-        resourceToMap = buffer;
+        return;
+    }
+
+    if (!m_copyQueue)
+    {
+        // The copies are recorded the next time the primary queue records or submits work.
+        if (m_activeQueue != m_uploadQueue)
+        {
+            return;
+        }
+
+        std::vector<D3D12_RESOURCE_BARRIER> barriers;
+        for (auto& upload : m_pendingUploads)
+        {
+            barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(
+                upload.destination.Get(),
+                D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
+                D3D12_RESOURCE_STATE_COPY_DEST));
+        }
+
+        auto commandList = m_uploadQueue->commandList.Get();
+        RecordBarriers(commandList, barriers);
+        for (auto& upload : m_pendingUploads)
+        {
+            commandList->CopyBufferRegion(upload.destination.Get(), 0, upload.stagingBuffer, upload.stagingOffset, upload.sizeInBytes);
+        }
+
+        for (auto& barrier : barriers)
+        {
+            std::swap(barrier.Transition.StateBefore, barrier.Transition.StateAfter);
+        }
+        RecordBarriers(commandList, barriers);
     }
     else
     {
-        resourceToMap = CreateReadbackBuffer(buffer->GetDesc().Width);
-        resourceToMap->SetName(L"Device::Download");
+        // Buffers are implicitly promoted to COPY_DEST by the copies and decay back to COMMON once the copy queue 
+        // finishes, so no barriers are needed.
+        auto commandList = m_copyQueue->commandList.Get();
+        for (auto& upload : m_pendingUploads)
+        {
+            commandList->CopyBufferRegion(upload.destination.Get(), 0, upload.stagingBuffer, upload.stagingOffset, upload.sizeInBytes);
+        }
+        THROW_IF_FAILED(commandList->Close());
+
+        ID3D12CommandList* commandLists[] = { commandList };
+        m_copyQueue->queue->ExecuteCommandLists(_countof(commandLists), commandLists);
+        uint64_t fenceValue = m_copyQueue->frameRing->SubmitCurrentFrame();
+        m_stagingRing->Submit(fenceValue);
 
-        D3D12_RESOURCE_BARRIER barriers[] =
+        // Work submitted to any queue after this point waits (on the GPU, not the CPU) for the copies.
+        for (auto& queue : m_queues)
         {
-            CD3DX12_RESOURCE_BARRIER::Transition(
-                buffer.Get(),
+            THROW_IF_FAILED(queue->queue->Wait(m_copyQueue->fence.Get(), fenceValue));
+        }
+
+        uint32_t frameIndex = m_copyQueue->frameRing->AdvanceFrame();
+        auto& frame = m_copyQueue->frames[frameIndex];
+        frame.temporaryResources.clear();
+        THROW_IF_FAILED(frame.commandAllocator->Reset());
+        THROW_IF_FAILED(commandList->Reset(frame.commandAllocator.Get(), nullptr));
+    }
+
+    m_uploadStats.copyBatchCount++;
+    m_pendingUploads.clear();
+}
+
+std::vector<std::byte> Device::Download(Microsoft::WRL::ComPtr<ID3D12Resource> buffer)
+{
+    ID3D12Resource* buffers[] = { buffer.Get() };
+    return DownloadBatch(buffers).front().get();
+}
+
+std::vector<std::future<std::vector<std::byte>>> Device::DownloadBatch(gsl::span<ID3D12Resource* const> buffers)
+{
+    TraceScope trace("readback", "readback");
+    FlushUploads();
+
+    struct Readback
+    {
+        ComPtr<ID3D12Resource> resourceToMap;
+        uint64_t offset;
+        size_t sizeInBytes;
+    };
+
+    std::vector<Readback> readbacks;
+    std::vector<D3D12_RESOURCE_BARRIER> barriers;
+    uint64_t readbackBufferSize = 0;
+
+    for (auto buffer : buffers)
+    {
+        if (buffer->GetDesc().Width > std::numeric_limits<size_t>::max())
+        {
+            throw std::invalid_argument(fmt::format("Buffer width '{}' is too large.", buffer->GetDesc().Width));
+        }
+        size_t dataSize = gsl::narrow<size_t>(buffer->GetDesc().Width);
+
+        if (IsCpuVisible(buffer))
+        {
+            readbacks.push_back({ buffer, 0, dataSize });
+        }
+        else
+        {
+            // The readback buffer is assigned below, once its total size is known.
+            readbacks.push_back({ nullptr, readbackBufferSize, dataSize });
+            readbackBufferSize += (dataSize + c_stagingAlignment - 1) / c_stagingAlignment * c_stagingAlignment;
+
+            barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(
+                buffer,
                 D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
-                D3D12_RESOURCE_STATE_COPY_SOURCE)
-        };
+                D3D12_RESOURCE_STATE_COPY_SOURCE));
+        }
+    }
 
-        m_commandList->ResourceBarrier(_countof(barriers), barriers);
-        m_commandList->CopyResource(resourceToMap.Get(), buffer.Get());
-        std::swap(barriers[0].Transition.StateBefore, barriers[0].Transition.StateAfter);
-        m_commandList->ResourceBarrier(_countof(barriers), barriers);
-        ExecuteCommandListAndWait();
+    uint64_t fenceValue = 0;
+    if (readbackBufferSize > 0)
+    {
+        auto readbackBuffer = CreateReadbackBuffer(readbackBufferSize);
+        readbackBuffer->SetName(L"Device::Download");
+
+        auto commandList = m_activeQueue->commandList.Get();
+        RecordBarriers(commandList, barriers);
+        for (size_t i = 0; i < readbacks.size(); i++)
+        {
+            if (!readbacks[i].resourceToMap)
+            {
+                commandList->CopyBufferRegion(readbackBuffer.Get(), readbacks[i].offset, buffers[i], 0, readbacks[i].sizeInBytes);
+                readbacks[i].resourceToMap = readbackBuffer;
+            }
+        }
+
+        for (auto& barrier : barriers)
+        {
+            std::swap(barrier.Transition.StateBefore, barrier.Transition.StateAfter);
+        }
+        RecordBarriers(commandList, barriers);
+
+        fenceValue = ExecuteCommandList();
     }
 
-    std::vector<std::byte> outputBuffer(static_cast<size_t>(buffer->GetDesc().Width));
-    
-    size_t dataSize = gsl::narrow<size_t>(buffer->GetDesc().Width);
-    CD3DX12_RANGE readRange(0, dataSize);
-    void* mappedBufferData = nullptr;
-    THROW_IF_FAILED(resourceToMap->Map(0, &readRange, &mappedBufferData));
-    memcpy(outputBuffer.data(), mappedBufferData, dataSize);
-    resourceToMap->Unmap(0, nullptr);
+    // The futures are deferred: the first one to be retrieved blocks on the fence, and the rest return immediately.
+    QueueFenceTimeline* fenceTimeline = m_activeQueue->fenceTimeline.get();
+    std::vector<std::future<std::vector<std::byte>>> outputBuffers;
+    for (auto& readback : readbacks)
+    {
+        outputBuffers.push_back(std::async(std::launch::deferred, [this, fenceTimeline, fenceValue, readback]
+        {
+            TraceScope trace("readback", "map readback");
+            if (fenceValue > 0)
+            {
+                fenceTimeline->WaitForValue(fenceValue);
+                THROW_IF_FAILED(m_d3d->GetDeviceRemovedReason());
+            }
+
+            std::vector<std::byte> outputBuffer(readback.sizeInBytes);
+
+            CD3DX12_RANGE readRange(gsl::narrow<size_t>(readback.offset), gsl::narrow<size_t>(readback.offset) + readback.sizeInBytes);
+            void* mappedBufferData = nullptr;
+            THROW_IF_FAILED(readback.resourceToMap->Map(0, &readRange, &mappedBufferData));
+            memcpy(outputBuffer.data(), static_cast<const std::byte*>(mappedBufferData) + readback.offset, readback.sizeInBytes);
+            readback.resourceToMap->Unmap(0, nullptr);
+
+            return outputBuffer;
+        }));
+    }
 
-    return outputBuffer;
+    return outputBuffers;
 }
 
-void Device::ExecuteCommandList()
+uint64_t Device::SubmitCommandList(gsl::span<ID3D12CommandList* const> replayCommandLists)
 {
-    THROW_IF_FAILED(m_commandList->Close());
+    DXD_PHASE_SCOPE(CpuPhase::Submit);
+    FlushUploads();
+
+    // Timestamps are resolved at the end of the submission that contains them. The primary queue's worker command
+    // lists execute last.
+    bool submitWorkerCommandLists = m_activeQueue == m_queues.front().get();
+    if (GpuTimingEnabled())
+    {
+        auto resolveCommandList = submitWorkerCommandLists && !m_workerCommandLists.empty() ? 
+            m_workerCommandLists.back().Get() : 
+            m_activeQueue->commandList.Get();
+
+        for (auto& range : m_timestampRing->GetUnresolvedRanges(m_activeQueue->fenceTimeline.get()))
+        {
+            resolveCommandList->ResolveQueryData(
+                m_timestampHeap.Get(), 
+                D3D12_QUERY_TYPE_TIMESTAMP, 
+                range.first, 
+                range.second, 
+                m_timestampReadbackBuffer.Get(), 
+                range.first * sizeof(uint64_t));
+        }
+    }
+
+    THROW_IF_FAILED(m_activeQueue->commandList->Close());
+
+    std::vector<ID3D12CommandList*> commandLists = { m_activeQueue->commandList.Get() };
+    commandLists.insert(commandLists.end(), replayCommandLists.begin(), replayCommandLists.end());
+    if (submitWorkerCommandLists)
+    {
+        for (auto& workerCommandList : m_workerCommandLists)
+        {
+            THROW_IF_FAILED(workerCommandList->Close());
+            commandLists.push_back(workerCommandList.Get());
+        }
+    }
+    m_activeQueue->queue->ExecuteCommandLists(static_cast<uint32_t>(commandLists.size()), commandLists.data());
+
+    uint64_t fenceValue = m_activeQueue->frameRing->SubmitCurrentFrame();
+
+    if (GpuTimingEnabled())
+    {
+        m_timestampRing->Submit(m_activeQueue->fenceTimeline.get(), fenceValue);
+    }
+
+    // Descriptor ranges are retired on the primary queue's timeline.
+    if (m_activeQueue == m_queues.front().get())
+    {
+        m_persistentDescriptors->Submit(fenceValue);
+        m_transientDescriptors->Submit(fenceValue);
+    }
 
-    ID3D12CommandList* commandLists[] = { m_commandList.Get() };
-    m_queue->ExecuteCommandLists(_countof(commandLists), commandLists);
-    THROW_IF_FAILED(m_commandList->Reset(m_commandAllocator.Get(), nullptr));
+    if (m_activeQueue == m_uploadQueue && m_stagingRing)
+    {
+        m_stagingRing->Submit(fenceValue);
+    }
+    return fenceValue;
 }
 
-void Device::ExecuteCommandListAndWait()
+void Device::TraceGpuEvent(TraceRecorder* traceRecorder, IFenceTimeline* timeline, uint64_t startTimestamp, uint64_t endTimestamp)
 {
-    THROW_IF_FAILED(m_commandList->Close());
+    if (!m_clockCalibration)
+    {
+        // The CPU half of the calibration is a raw performance counter value, which doesn't necessarily share an
+        // epoch with the trace clock. Instead, the trace clock is sampled around the call and the GPU timestamp is
+        // placed in the middle, which is accurate to within half the call's duration.
+        auto before = TraceRecorder::Clock::now();
+        uint64_t gpuTimestamp = 0;
+        uint64_t cpuTimestamp = 0;
+        THROW_IF_FAILED(m_queues.front()->queue->GetClockCalibration(&gpuTimestamp, &cpuTimestamp));
+        auto after = TraceRecorder::Clock::now();
+        m_clockCalibration = ClockCalibration{ gpuTimestamp, before + (after - before) / 2 };
+    }
 
-    ID3D12CommandList* commandLists[] = { m_commandList.Get() };
-    m_queue->ExecuteCommandLists(_countof(commandLists), commandLists);
-    WaitForGpuWorkToComplete();
-    THROW_IF_FAILED(m_d3d->GetDeviceRemovedReason());
-    THROW_IF_FAILED(m_commandAllocator->Reset());
-    THROW_IF_FAILED(m_commandList->Reset(m_commandAllocator.Get(), nullptr));
+    // Timestamps that precede the calibration have negative offsets.
+    auto ToCpuTime = [this](uint64_t timestamp)
+    {
+        auto offset = std::chrono::duration<double>(static_cast<int64_t>(timestamp - m_clockCalibration->gpuTimestamp) / double(m_timestampFrequency));
+        return m_clockCalibration->cpuTime + std::chrono::duration_cast<TraceRecorder::Clock::duration>(offset);
+    };
 
-    m_temporaryResources.clear();
+    // Work of different queues (and devices) overlaps, so each queue has its own track. Track IDs are cached until
+    // the recorder changes.
+    if (m_gpuTraceTracks.recorderId != traceRecorder->GetId())
+    {
+        m_gpuTraceTracks = { traceRecorder->GetId(), std::vector<uint32_t>(m_queues.size()) };
+        for (size_t queueIndex = 0; queueIndex < m_queues.size(); queueIndex++)
+        {
+            m_gpuTraceTracks.trackIds[queueIndex] = traceRecorder->GetNamedTrackId(
+                fmt::format("GPU (device {}, queue {})", m_traceDeviceNumber, queueIndex));
+        }
+    }
+
+    size_t queueIndex = 0;
+    while (queueIndex + 1 < m_queues.size() && m_queues[queueIndex]->fenceTimeline.get() != timeline)
+    {
+        queueIndex++;
+    }
+
+    traceRecorder->AddEvent(
+        m_timingTraceName,
+        "gpu",
+        ToCpuTime(startTimestamp),
+        ToCpuTime(endTimestamp),
+        m_gpuTraceTracks.trackIds[queueIndex]);
 }
 
-void Device::RecordTimestamp()
+uint64_t Device::ExecuteCommandList()
 {
-    if (!GpuTimingEnabled())
+    uint64_t fenceValue = SubmitCommandList();
+
+    // The frame's allocators are still in use by the submission, so only the command lists are reset.
+    ResetCommandList(m_activeQueue->frameRing->CurrentFrameIndex(), false);
+    return fenceValue;
+}
+
+void Device::ExecuteCommandListAndWait(gsl::span<ID3D12CommandList* const> replayCommandLists)
+{
+    SubmitCommandList(replayCommandLists);
     {
-        return;
+        DXD_PHASE_SCOPE(CpuPhase::FenceWait);
+        m_activeQueue->frameRing->WaitForAllFrames();
     }
+    THROW_IF_FAILED(m_d3d->GetDeviceRemovedReason());
 
-    m_commandList->EndQuery(m_timestampHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, m_timestampHeadIndex);
-    m_timestampHeadIndex = (m_timestampHeadIndex + 1) % m_timestampCapacity;
-    if (m_timestampCount < m_timestampCapacity)
+    // All frames are idle, so temporaries of every frame can be released. The other frames' allocators
+    // are reset when the ring advances to them.
+    for (auto& frame : m_activeQueue->frames)
     {
-        m_timestampCount++;
+        frame.temporaryResources.clear();
     }
+    ResetCommandList(m_activeQueue->frameRing->CurrentFrameIndex());
 }
 
-std::vector<uint64_t> Device::ResolveTimestamps()
+void Device::ExecuteCommandListAndAdvanceFrame(gsl::span<ID3D12CommandList* const> replayCommandLists)
 {
-    assert(m_timestampCount <= m_timestampCapacity);
+    if (m_activeQueue->frameRing->FrameCount() == 1)
+    {
+        ExecuteCommandListAndWait(replayCommandLists);
+        return;
+    }
 
-    if (!GpuTimingEnabled())
+    SubmitCommandList(replayCommandLists);
+    uint32_t frameIndex;
     {
-        return {};
+        // Advancing waits for the frame's previous submission if it's still in flight.
+        DXD_PHASE_SCOPE(CpuPhase::FenceWait);
+        frameIndex = m_activeQueue->frameRing->AdvanceFrame();
     }
+    THROW_IF_FAILED(m_d3d->GetDeviceRemovedReason());
+
+    m_activeQueue->frames[frameIndex].temporaryResources.clear();
+    ResetCommandList(frameIndex);
+}
 
-    auto timestampReadbackBuffer = CreateReadbackBuffer(sizeof(uint64_t) * m_timestampCount);
+void Device::ResetCommandList(uint32_t frameIndex, bool resetAllocators)
+{
+    auto& frame = m_activeQueue->frames[frameIndex];
+    if (resetAllocators)
+    {
+        THROW_IF_FAILED(frame.commandAllocator->Reset());
+    }
+    THROW_IF_FAILED(m_activeQueue->commandList->Reset(frame.commandAllocator.Get(), nullptr));
 
-    m_commandList->ResolveQueryData(m_timestampHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, 0, m_timestampCount, timestampReadbackBuffer.Get(), 0);
-    ExecuteCommandListAndWait();
+    ID3D12DescriptorHeap* descriptorHeaps[] = { m_descriptorHeap.Get() };
+    m_activeQueue->commandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
 
-    void* pData = nullptr;
-    D3D12_RANGE readRange = { 0, sizeof(uint64_t) * m_timestampCount };
-    timestampReadbackBuffer->Map(0, &readRange, &pData);
+    if (m_activeQueue == m_queues.front().get())
+    {
+        for (size_t i = 0; i < m_workerCommandLists.size(); i++)
+        {
+            if (resetAllocators)
+            {
+                THROW_IF_FAILED(frame.workerCommandAllocators[i]->Reset());
+            }
+            THROW_IF_FAILED(m_workerCommandLists[i]->Reset(frame.workerCommandAllocators[i].Get(), nullptr));
+            m_workerCommandLists[i]->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
+        }
+    }
+}
 
-    std::vector<uint64_t> timestamps;
-    const uint64_t* pTimestamps = reinterpret_cast<uint64_t*>(pData);
-    timestamps.insert(timestamps.end(), pTimestamps, pTimestamps + m_timestampCount);
+void Device::RecordTimestamp()
+{
+    RecordTimestamp(m_activeQueue->commandList.Get());
+}
 
-    m_timestampHeadIndex = 0;
-    m_timestampCount = 0;
+void Device::RecordTimestamp(ID3D12GraphicsCommandList* commandList)
+{
+    if (!GpuTimingEnabled())
+    {
+        return;
+    }
 
-    return timestamps;
+    uint32_t queryIndex = m_timestampRing->Record(m_activeQueue->fenceTimeline.get());
+    commandList->EndQuery(m_timestampHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, queryIndex);
 }
 
 std::vector<double> Device::ResolveTimingSamples()
 {
-    std::vector<uint64_t> timestamps = ResolveTimestamps();
-    if (timestamps.empty())
+    if (!GpuTimingEnabled())
     {
         return {};
     }
 
-    uint64_t frequency;
-    THROW_IF_FAILED(m_queue->GetTimestampFrequency(&frequency));
-
-    std::vector<double> samples(timestamps.size() / 2);
-
-    for (uint32_t i = 0; i < samples.size(); ++i) 
+    if (!m_timestampRing->Drain())
     {
-        uint64_t timestampDelta = (timestamps[2 * i + 1] - timestamps[2 * i]) * 1000;
-        samples[i] = double(timestampDelta) / frequency / m_dispatchRepeat;
+        // Timestamps recorded into the open command list are resolved by submitting it.
+        ExecuteCommandListAndWait();
+        m_timestampRing->Drain();
     }
 
+    std::vector<double> samples(m_timingSamples.begin(), m_timingSamples.end());
+    m_timingSamples.clear();
     return samples;
 }
 
@@ -688,6 +1575,8 @@ std::vector<double> Device::ResolveTimingSamples()
 void Device::EnsureDxcInterfaces()
 {
 #if defined(_GAMING_XBOX) || defined(_AMD64_)
+    // Dispatchables are compiled on multiple threads, which may all query the interfaces at once.
+    std::lock_guard<std::mutex> lock(m_dxcMutex);
     if (!m_dxcCompiler)
     {
         // Lazily create DXC compiler and helpers.
@@ -2,9 +2,42 @@
 
 #include "PixCaptureHelper.h"
 #include "DxModules.h"
+#include "FrameRing.h"
+#include "MemoryTracker.h"
+#include "RangeAllocators.h"
+#include "ThreadPool.h"
+#include "TimestampRing.h"
+#include "TraceRecorder.h"
+
+// Fence timeline of a D3D12 command queue. Every signal uses a new, monotonically increasing fence value.
+class QueueFenceTimeline : public IFenceTimeline
+{
+public:
+    QueueFenceTimeline(ID3D12CommandQueue* queue, ID3D12Fence* fence) : m_queue(queue), m_fence(fence) {}
+
+    uint64_t Signal() override;
+    uint64_t GetCompletedValue() override;
+    void WaitForValue(uint64_t value) override;
+
+    uint64_t LastSignaledValue() const { return m_lastSignaledValue; }
+
+private:
+    ID3D12CommandQueue* m_queue;
+    ID3D12Fence* m_fence;
+    uint64_t m_lastSignaledValue = 0;
+};
 
 // Simplified abstraction for submitting work to a device with a single command queue. Not thread safe.
-// This "device" includes a single command list that is always open for recording work.
+// This "device" includes a single command list that is always open for recording work. The command list
+// records into one of a ring of frames (command allocators), which allows the GPU to execute earlier 
+// submissions while the CPU records the next one (see ExecuteCommandListAndAdvanceFrame).
+//
+// The device may optionally create additional queues of the same type, which allow independent work to execute
+// concurrently. Each queue has its own command list and frames; recording and submission always target the
+// active queue (see SetActiveQueue), which is the primary queue (index 0) unless changed.
+//
+// The primary queue may also have worker command lists, which allow dispatches to be recorded on multiple threads
+// (see EnsureWorkerCommandLists).
 class Device
 {
 public:
@@ -25,6 +58,9 @@ public:
         bool preferCustomHeaps,
         bool usePresentSeparator,
         uint32_t maxGpuTimeMeasurements,
+        uint32_t framesInFlight,
+        uint32_t queueCount,
+        bool useCopyQueueForUploads,
         std::shared_ptr<PixCaptureHelper> pixCaptureHelper,
         std::shared_ptr<D3d12Module> d3dModule,
         std::shared_ptr<DmlModule> dmlModule,
@@ -35,10 +71,16 @@ public:
     D3d12Module* D3DModule() { return m_d3dModule.get(); }
     ID3D12Device9* D3D() { return m_d3d.Get(); }
     IDMLDevice1* DML() { return m_dml.Get(); }
-    ID3D12CommandQueue* GetCommandQueue() { return m_queue.Get(); }
+
+    // Identify the adapter (by LUID) and the settings of the D3D and DML devices, for keys of objects shared between
+    // Devices (e.g. pipeline states and compiled operators). Devices on the same adapter with the same settings share
+    // their D3D device (a singleton per adapter) and DML device, while either is alive.
+    const std::string& GetD3DCacheKey() const { return m_d3dCacheKey; }
+    const std::string& GetDmlCacheKey() const { return m_dmlCacheKey; }
+    ID3D12CommandQueue* GetCommandQueue() { return m_activeQueue->queue.Get(); }
     ID3D12QueryHeap* GetTimestampHeap() { return m_timestampHeap.Get(); }
     D3D12_COMMAND_LIST_TYPE GetCommandListType() const { return m_commandListType; }
-    ID3D12GraphicsCommandList* GetCommandList() { return m_commandList.Get(); }
+    ID3D12GraphicsCommandList* GetCommandList() { return m_activeQueue->commandList.Get(); }
     PixCaptureHelper& GetPixCaptureHelper() { return *m_pixCaptureHelper; }
 
 #ifndef DXCOMPILER_NONE
@@ -47,6 +89,15 @@ public:
     IDxcCompiler3* GetDxcCompiler();
 #endif
 
+    // Live and peak bytes of the memory allocated for this device, by category. Memory is counted from the creation
+    // of a tracked object (see TrackMemory) until the object is destroyed, even if other objects still reference it.
+    MemoryTracker& GetMemoryTracker() { return *m_memoryTracker; }
+
+    // Counts the memory of a committed resource, heap, or descriptor heap in a category until it's destroyed. Placed
+    // resources shouldn't be tracked, since their memory belongs to a heap. The device tracks the memory it allocates
+    // for its own purposes (e.g. staging and readback buffers, and the transient pool).
+    void TrackMemory(ID3D12Object* object, MemoryCategory category);
+
     // Creates either a default buffer or custom buffer based on support for custom heaps
     // and whether or not they are allowed.
     Microsoft::WRL::ComPtr<ID3D12Resource> CreatePreferredDeviceMemoryBuffer(
@@ -67,26 +118,108 @@ public:
         uint64_t alignment = 0,
         D3D12_HEAP_FLAGS heapFlags = D3D12_HEAP_FLAG_NONE);
 
+    // Upload and readback buffers are counted as upload staging and readback memory (see TrackMemory).
     Microsoft::WRL::ComPtr<ID3D12Resource> CreateUploadBuffer(
         uint64_t sizeInBytes,
         D3D12_RESOURCE_FLAGS resourceFlags = D3D12_RESOURCE_FLAG_NONE,
         uint64_t alignment = 0,
         D3D12_HEAP_FLAGS heapFlags = D3D12_HEAP_FLAG_NONE);
 
+    // Creates a heap for buffers that are placed at explicit offsets (e.g. buffers that alias each other), in the
+    // same memory as CreatePreferredDeviceMemoryBuffer.
+    Microsoft::WRL::ComPtr<ID3D12Heap> CreatePreferredDeviceMemoryHeap(uint64_t sizeInBytes);
+
+    Microsoft::WRL::ComPtr<ID3D12Resource> CreatePlacedBuffer(
+        ID3D12Heap* heap, 
+        uint64_t offset, 
+        uint64_t sizeInBytes, 
+        std::wstring_view name = {});
+
     Microsoft::WRL::ComPtr<ID3D12Resource> CreateReadbackBuffer(
         uint64_t sizeInBytes,
         D3D12_RESOURCE_FLAGS resourceFlags = D3D12_RESOURCE_FLAG_NONE,
         uint64_t alignment = 0,
         D3D12_HEAP_FLAGS heapFlags = D3D12_HEAP_FLAG_NONE);
 
-    // Waits for all work submitted to this device's queue to complete.
+    // Range of descriptors in the device's shader-visible CBV/SRV/UAV heap.
+    struct DescriptorRange
+    {
+        D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle = {};
+        D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle = {};
+        uint32_t offset = 0;
+        uint32_t count = 0;
+    };
+
+    // All dispatchables suballocate descriptors from a single shader-visible heap, which is always bound to the 
+    // device command list. This avoids creating heaps per dispatch and switching heaps between dispatches.
+    ID3D12DescriptorHeap* GetDescriptorHeap() { return m_descriptorHeap.Get(); }
+    uint32_t GetDescriptorIncrementSize() const { return m_descriptorIncrementSize; }
+
+    // Allocates descriptors that remain valid until freed (e.g. descriptors reused across iterations). 
+    // Freed descriptors are reused only after the GPU finishes work submitted before the free. Descriptors must be
+    // allocated and freed while the primary queue is active, and freed only once other queues finished using them.
+    DescriptorRange AllocatePersistentDescriptors(uint32_t count);
+    void FreePersistentDescriptors(const DescriptorRange& range);
+
+    // Allocates descriptors that are only valid for the next command list submission on the primary queue.
+    DescriptorRange AllocateTransientDescriptors(uint32_t count);
+
+    // Transient buffers hold scratch data that doesn't need to persist beyond a single dispatch (e.g. DML temporary
+    // resources). Every transient buffer aliases the same placed heap, which is sized to the largest reservation.
+    struct TransientPoolStats
+    {
+        uint64_t capacityInBytes = 0;   // Combined size of the current pool heaps of all queues.
+        uint64_t reservedInBytes = 0;   // Largest reservation or request.
+        uint64_t requestCount = 0;      // Number of AcquireTransientBuffer calls.
+        uint64_t requestedInBytes = 0;  // Sum of all requested sizes (i.e. memory required without aliasing).
+        uint64_t heapCount = 0;         // Number of pool heaps created; more than 1 means the pool had to grow.
+    };
+
+    // Ensures the pool is at least the given size once it is (re)created. Reserving all transient requirements
+    // before acquiring the first buffer avoids growing the pool.
+    void ReserveTransientMemory(uint64_t sizeInBytes);
+
+    // Returns a buffer over the active queue's transient pool, which is at least sizeInBytes large. The contents are
+    // undefined and may be overwritten by any other dispatch that uses transient memory on the same queue. Each queue
+    // has its own pool (created on first use), so commands on different queues can use transient memory concurrently.
+    Microsoft::WRL::ComPtr<ID3D12Resource> AcquireTransientBuffer(uint64_t sizeInBytes);
+
+    const TransientPoolStats& GetTransientPoolStats() const { return m_transientPoolStats; }
+
+    // Waits for all work submitted to this device's queues to complete.
     void WaitForGpuWorkToComplete();
 
-    // Submits all commands recorded into the device's command list for execution.
-    void ExecuteCommandList();
+    // Submits all commands recorded into the device's command list for execution. Returns the fence value that
+    // the active queue signals when the commands finish.
+    uint64_t ExecuteCommandList();
 
     // Submits the device command list for execution and blocks the CPU thread until the commands have finished on the GPU.
-    void ExecuteCommandListAndWait();
+    // Closed replay command lists may be submitted along with it; they execute after the device command list and 
+    // before any worker command lists.
+    void ExecuteCommandListAndWait(gsl::span<ID3D12CommandList* const> replayCommandLists = {});
+
+    // Submits the device command list for execution and moves recording to the next frame. This only blocks if the 
+    // next frame's previous submission is still executing, so up to GetMaxFramesInFlight() submissions may overlap
+    // with CPU recording. Equivalent to ExecuteCommandListAndWait() when there is a single frame.
+    void ExecuteCommandListAndAdvanceFrame(gsl::span<ID3D12CommandList* const> replayCommandLists = {});
+
+    uint32_t GetMaxFramesInFlight() const { return m_activeQueue->frameRing->FrameCount(); }
+
+    // Number of times ExecuteCommandListAndAdvanceFrame() blocked because all frames were in flight.
+    uint64_t GetFrameStallCount() const { return m_activeQueue->frameRing->StallCount(); }
+
+    uint32_t GetQueueCount() const { return static_cast<uint32_t>(m_queues.size()); }
+
+    // Selects the queue that subsequent commands are recorded for and submitted to. Descriptors should only be
+    // allocated or freed while the primary queue is active, since they are retired on its fence.
+    void SetActiveQueue(uint32_t queueIndex);
+    uint32_t GetActiveQueue() const;
+
+    // Returns the fence value signaled by the most recent submission to a queue.
+    uint64_t GetLastSubmittedFenceValue(uint32_t queueIndex) const;
+
+    // Makes the active queue wait (on the GPU, without blocking the CPU) until another queue reaches a fence value.
+    void WaitForQueue(uint32_t queueIndex, uint64_t fenceValue);
 
     // Records the dispatch of an IDMLDispatchable into the device command list.
     void RecordInitialize(IDMLDispatchable* dispatchable, IDMLBindingTable* bindingTable);
@@ -95,28 +228,119 @@ public:
     // Records the dispatch of an HLSL shader.
     void RecordDispatch(const char* name, uint32_t threadGroupX, uint32_t threadGroupY, uint32_t threadGroupZ);
 
-    // Records a GPU timestamp in the device's command list. The device has a limit on the number of 
-    // unresolved timestamps; if this capacity is exceeded, the oldest timestamps are dropped.
+    // A command list (and DML command recorder) that dispatches can be recorded into without going through the
+    // device's own recording state. Recording into different targets on different threads is safe.
+    struct RecordingTarget
+    {
+        ID3D12GraphicsCommandList* commandList;
+        IDMLCommandRecorder* dmlCommandRecorder;
+
+        // Barriers recorded between the repeats of each dispatch (see SetRepeatDispatchBarriers).
+        gsl::span<const D3D12_RESOURCE_BARRIER> repeatBarriers;
+    };
+
+    // Records a dispatch into a target, including its repeats and post-dispatch barriers but without timestamps.
+    // These don't modify the device, so they may be called from worker threads.
+    void RecordDispatch(const RecordingTarget& target, IDMLDispatchable* dispatchable, IDMLBindingTable* bindingTable) const;
+    void RecordDispatch(const RecordingTarget& target, const char* name, uint32_t threadGroupX, uint32_t threadGroupY, uint32_t threadGroupZ) const;
+
+    // Returns the target for the device command list of the active queue.
+    RecordingTarget GetRecordingTarget();
+
+    // A command list with its own allocator and DML command recorder that is recorded once and then submitted any
+    // number of times (e.g. to replay the same dispatches every iteration). Close it after recording, and keep it 
+    // alive until the GPU finishes its last submission.
+    struct ReplayCommandList
+    {
+        Microsoft::WRL::ComPtr<ID3D12CommandAllocator> commandAllocator;
+        Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> commandList;
+        Microsoft::WRL::ComPtr<IDMLCommandRecorder> dmlCommandRecorder;
+
+        RecordingTarget GetRecordingTarget() const { return { commandList.Get(), dmlCommandRecorder.Get(), {} }; }
+    };
+
+    // Creates an open replay command list with the device's descriptor heap set.
+    ReplayCommandList CreateReplayCommandList();
+
+    // Ensures the primary queue has at least the given number of worker command lists. Like the device command list,
+    // worker command lists are always open and have a command allocator per frame; each also has its own DML command
+    // recorder. When the primary queue submits, its worker command lists are executed after the device command list,
+    // in index order, within the same ExecuteCommandLists call.
+    void EnsureWorkerCommandLists(uint32_t count);
+    uint32_t GetWorkerCommandListCount() const { return static_cast<uint32_t>(m_workerCommandLists.size()); }
+    RecordingTarget GetWorkerRecordingTarget(uint32_t index);
+
+    // Sets barriers recorded between the repeats of each recorded dispatch (--dispatch_repeat), in addition to the
+    // fixed post-dispatch barriers. Used for barriers planned from the dispatch's resource hazards.
+    void SetRepeatDispatchBarriers(std::vector<D3D12_RESOURCE_BARRIER> barriers) { m_repeatDispatchBarriers = std::move(barriers); }
+
+    // Records a GPU timestamp in the device's command list. Timestamps are resolved by the submission that contains 
+    // them and read back once that submission's fence completes. The device has a limit on the number of timestamps
+    // that haven't been read back; if it's reached, recording blocks until the oldest submission completes.
     void RecordTimestamp();
 
-    // Resolves and returns all timestamp values recorded since the last call to ResolveTimestamps. 
-    // This is a blocking call that forces the CPU and GPU to sync.
-    std::vector<uint64_t> ResolveTimestamps();
+    // Records a GPU timestamp in another command list (e.g. a worker command list) that is submitted along with 
+    // the device command list.
+    void RecordTimestamp(ID3D12GraphicsCommandList* commandList);
+
+    // Sets a function that receives every timing sample (the duration between a pair of timestamps, divided by the
+    // dispatch repeat) as soon as it's read back, in recording order. Samples are read back without adding sync
+    // points: only submissions that the CPU has already waited on (or that have otherwise completed) are read.
+    void SetTimingSampleCallback(std::function<void(double)> callback) { m_timingSampleCallback = std::move(callback); }
+
+    // Sets the name of the GPU events added to the active trace for the timing samples read back from now on.
+    void SetTimingTraceName(std::string name) { m_timingTraceName = std::move(name); }
 
-    // Calls ResolveTimestamps() and converts timestamp pairs into timing samples.
+    // Submits any unsubmitted timestamps, waits for all timestamps to be read back, and returns the timing samples 
+    // read back since the last call. Only the most recent samples (up to the GPU time measurement limit) are kept; 
+    // use SetTimingSampleCallback to observe all of them.
     std::vector<double> ResolveTimingSamples();
 
     bool GpuTimingEnabled() const { return m_timestampCapacity > 0; }
 
     void KeepAliveUntilNextCommandListDispatch(Microsoft::WRL::ComPtr<IGraphicsUnknown>&& object)
     {
-        m_temporaryResources.emplace_back(std::move(object));
+        m_activeQueue->frames[m_activeQueue->frameRing->CurrentFrameIndex()].temporaryResources.emplace_back(std::move(object));
     }
 
+    // Creates a buffer with the given initial data. The data is staged in a persistent, growable ring of upload
+    // memory, and the copies of consecutive uploads are batched: they're recorded before the next dispatch, download,
+    // or submission of the primary queue (or submitted to a dedicated copy queue, which all queues then wait for).
+    // Uploads should only be made while the primary queue is active. The buffer is counted as a model resource (see
+    // TrackMemory).
     Microsoft::WRL::ComPtr<ID3D12Resource> Upload(uint64_t totalSize, gsl::span<const std::byte> data, std::wstring_view name = {});
 
+    // Replaces the leading bytes of an existing buffer, in the same way as Upload. CPU-visible buffers are written
+    // directly, so the GPU must not be using them (see WaitForGpuWorkToComplete).
+    void UploadTo(ID3D12Resource* buffer, gsl::span<const std::byte> data);
+
+    // Creates a buffer over host memory without copying it (zero copy), by opening the memory as a heap. The address
+    // must be aligned to D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT, and the memory must stay allocated until the
+    // buffer is released. Throws if the adapter can't open existing heaps.
+    Microsoft::WRL::ComPtr<ID3D12Resource> WrapHostMemory(void* data, uint64_t sizeInBytes, std::wstring_view name = {});
+
+    // Records (or, with a copy queue, submits) the copies of all pending uploads.
+    void FlushUploads();
+
+    struct UploadStats
+    {
+        uint64_t uploadCount = 0;           // Number of Upload calls with data.
+        uint64_t uploadedInBytes = 0;       // Sum of all uploaded data sizes.
+        uint64_t copyBatchCount = 0;        // Number of times pending copies were flushed.
+        uint64_t stagingCapacityInBytes = 0;// Size of the current staging buffer.
+        uint64_t stagingBufferCount = 0;    // Number of staging buffers created; more than 1 means the ring had to grow.
+        uint64_t stagingFlushCount = 0;     // Number of submissions forced because the staging ring was full.
+    };
+
+    const UploadStats& GetUploadStats() const { return m_uploadStats; }
+
     std::vector<std::byte> Download(Microsoft::WRL::ComPtr<ID3D12Resource>);
 
+    // Copies every buffer into a single readback allocation and submits the copies without waiting. Each future 
+    // becomes ready (blocking on the submission's fence, if necessary) when its contents are retrieved, so the whole 
+    // batch costs one CPU/GPU round trip. Futures must not outlive the device.
+    std::vector<std::future<std::vector<std::byte>>> DownloadBatch(gsl::span<ID3D12Resource* const> buffers);
+
     void ClearShaderCaches();
 
     static uint32_t GetSizeInBytes(DML_TENSOR_DATA_TYPE dataType);
@@ -126,6 +350,37 @@ public:
 
 private:
     void EnsureDxcInterfaces();
+    void ResetCommandList(uint32_t frameIndex, bool resetAllocators = true);
+    uint64_t SubmitCommandList(gsl::span<ID3D12CommandList* const> replayCommandLists = {});
+    void RecordBarriers(ID3D12GraphicsCommandList* commandList, gsl::span<const D3D12_RESOURCE_BARRIER> barriers) const;
+    uint64_t AllocateStagingMemory(uint64_t sizeInBytes);
+    void CopyUploadData(void* destination, gsl::span<const std::byte> data);
+    DescriptorRange GetDescriptorRange(uint64_t offset, uint32_t count);
+    void TraceGpuEvent(TraceRecorder* traceRecorder, IFenceTimeline* timeline, uint64_t startTimestamp, uint64_t endTimestamp);
+
+    // Resources owned by a single submission. These can be reused/released once its fence value is reached.
+    struct Frame
+    {
+        Microsoft::WRL::ComPtr<ID3D12CommandAllocator> commandAllocator;
+        std::vector<Microsoft::WRL::ComPtr<ID3D12CommandAllocator>> workerCommandAllocators;
+        std::vector<Microsoft::WRL::ComPtr<IGraphicsUnknown>> temporaryResources;
+    };
+
+    // A command queue with its own fence, ring of frames, and command list.
+    struct Queue
+    {
+        Microsoft::WRL::ComPtr<ID3D12CommandQueue> queue;
+        Microsoft::WRL::ComPtr<ID3D12Fence> fence;
+        std::unique_ptr<QueueFenceTimeline> fenceTimeline;
+        std::unique_ptr<FrameRing> frameRing;
+        std::vector<Frame> frames;
+        Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> commandList;
+
+        // Transient pool of the queue (see AcquireTransientBuffer).
+        Microsoft::WRL::ComPtr<ID3D12Heap> transientHeap;
+        Microsoft::WRL::ComPtr<ID3D12Resource> transientBuffer;
+        uint64_t transientCapacityInBytes = 0;
+    };
 
 private:
     std::shared_ptr<PixCaptureHelper> m_pixCaptureHelper;
@@ -135,31 +390,82 @@ private:
     Microsoft::WRL::ComPtr<ID3D12InfoQueue1> m_infoQueue;
 #endif
     std::shared_ptr<DmlModule> m_dmlModule;
+    std::shared_ptr<const Microsoft::WRL::ComPtr<IDMLDevice1>> m_sharedDml;
+    std::string m_d3dCacheKey;
+    std::string m_dmlCacheKey;
     Microsoft::WRL::ComPtr<IDMLDevice1> m_dml;
     Microsoft::WRL::ComPtr<IDMLCommandRecorder> m_commandRecorder;
-    Microsoft::WRL::ComPtr<ID3D12CommandQueue> m_queue;
+    std::vector<Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList>> m_workerCommandLists;
+    std::vector<Microsoft::WRL::ComPtr<IDMLCommandRecorder>> m_workerCommandRecorders;
     Microsoft::WRL::ComPtr<ID3D12QueryHeap> m_timestampHeap;
     uint32_t m_timestampCapacity = 0;
-    uint32_t m_timestampHeadIndex = 0;
-    uint32_t m_timestampCount = 0;
-    Microsoft::WRL::ComPtr<ID3D12Fence> m_fence;
+    Microsoft::WRL::ComPtr<ID3D12Resource> m_timestampReadbackBuffer;
+    std::unique_ptr<TimestampRing> m_timestampRing;
+    uint64_t m_timestampFrequency = 0;
+    std::deque<double> m_timingSamples;
+    std::function<void(double)> m_timingSampleCallback;
+    std::string m_timingTraceName = "GPU work";
+
+    // Pairs a GPU timestamp with the CPU time it was sampled at, to place GPU events on the trace's CPU timeline.
+    // Calibrated when the first GPU event is traced.
+    struct ClockCalibration
+    {
+        uint64_t gpuTimestamp;
+        TraceRecorder::Clock::time_point cpuTime;
+    };
+    std::optional<ClockCalibration> m_clockCalibration;
+
+    // Trace track of each queue, for the recorder they were registered with.
+    struct GpuTraceTracks
+    {
+        uint64_t recorderId = 0;
+        std::vector<uint32_t> trackIds;
+    };
+    GpuTraceTracks m_gpuTraceTracks;
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    Queue* m_activeQueue = nullptr;
+
+    // Uploads are recorded into the upload queue, which is either the primary queue or a dedicated copy queue.
+    std::unique_ptr<Queue> m_copyQueue;
+    Queue* m_uploadQueue = nullptr;
+    Microsoft::WRL::ComPtr<ID3D12Resource> m_stagingBuffer;
+    std::byte* m_stagingBufferData = nullptr;
+    std::unique_ptr<RingAllocator> m_stagingRing;
+    std::unique_ptr<ThreadPool> m_uploadThreadPool;
+
+    // A copy from the staging buffer into an uploaded resource that hasn't been recorded yet.
+    struct PendingUpload
+    {
+        Microsoft::WRL::ComPtr<ID3D12Resource> destination;
+        ID3D12Resource* stagingBuffer;
+        uint64_t stagingOffset;
+        uint64_t sizeInBytes;
+    };
+    std::vector<PendingUpload> m_pendingUploads;
+    UploadStats m_uploadStats;
+    Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_descriptorHeap;
+    uint32_t m_descriptorIncrementSize = 0;
+    std::unique_ptr<FreeListAllocator> m_persistentDescriptors;
+    std::unique_ptr<RingAllocator> m_transientDescriptors;
     D3D12_COMMAND_LIST_TYPE m_commandListType = D3D12_COMMAND_LIST_TYPE_COMPUTE;
-    Microsoft::WRL::ComPtr<ID3D12CommandAllocator> m_commandAllocator;
-    Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> m_commandList;
-    std::vector<Microsoft::WRL::ComPtr<IGraphicsUnknown>> m_temporaryResources;
     uint32_t m_dispatchRepeat = 1;
     std::vector<D3D12_RESOURCE_BARRIER> m_postDispatchBarriers;
+    std::vector<D3D12_RESOURCE_BARRIER> m_repeatDispatchBarriers;
     DWORD m_callbackCookie = 0;
     Microsoft::WRL::ComPtr<IDxDispatchLogger> m_logger;
     bool m_restoreBackgroundProcessing = false;
     bool m_restoreStablePowerState = false;
     std::optional<D3D12_FEATURE_DATA_ARCHITECTURE1> m_architectureSupport;
     bool m_useCustomHeaps = false;
+    uint32_t m_traceDeviceNumber = 0;
+    TransientPoolStats m_transientPoolStats;
+    std::shared_ptr<MemoryTracker> m_memoryTracker = std::make_shared<MemoryTracker>();
 
 #ifndef DXCOMPILER_NONE
     Microsoft::WRL::ComPtr<IDxcUtils> m_dxcUtils;
     Microsoft::WRL::ComPtr<IDxcIncludeHandler> m_dxcIncludeHandler;
     Microsoft::WRL::ComPtr<IDxcCompiler3> m_dxcCompiler;
+    std::mutex m_dxcMutex;
 #endif
 
 #if defined(INCLUDE_DXGI)
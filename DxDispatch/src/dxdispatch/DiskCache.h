@@ -0,0 +1,270 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Builds the value of a cache entry from fixed-size values, byte arrays and strings.
+class CacheEntryWriter
+{
+public:
+    template <typename T>
+    void Write(const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        WriteBytes(&value, sizeof(value));
+    }
+
+    // Writes the size of the data followed by the data.
+    void WriteArray(const void* data, size_t size)
+    {
+        Write<uint64_t>(size);
+        WriteBytes(data, size);
+    }
+
+    void WriteString(const std::string& value)
+    {
+        WriteArray(value.data(), value.size());
+    }
+
+    const std::vector<std::byte>& Data() const { return m_data; }
+
+private:
+    void WriteBytes(const void* data, size_t size)
+    {
+        auto bytes = static_cast<const std::byte*>(data);
+        m_data.insert(m_data.end(), bytes, bytes + size);
+    }
+
+    std::vector<std::byte> m_data;
+};
+
+// Reads the value of a cache entry in the order it was written by a CacheEntryWriter. Throws std::runtime_error
+// if the value ends early, which callers treat like a missing entry.
+class CacheEntryReader
+{
+public:
+    explicit CacheEntryReader(const std::vector<std::byte>& data) : m_data(data) {}
+
+    template <typename T>
+    T Read()
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value;
+        std::memcpy(&value, ReadBytes(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    std::vector<std::byte> ReadArray()
+    {
+        auto size = Read<uint64_t>();
+        auto bytes = ReadBytes(size);
+        return std::vector<std::byte>(bytes, bytes + size);
+    }
+
+    std::string ReadString()
+    {
+        auto size = Read<uint64_t>();
+        return std::string(reinterpret_cast<const char*>(ReadBytes(size)), static_cast<size_t>(size));
+    }
+
+    bool AtEnd() const { return m_offset == m_data.size(); }
+
+private:
+    const std::byte* ReadBytes(uint64_t size)
+    {
+        if (size > m_data.size() - m_offset)
+        {
+            throw std::runtime_error("Cache entry is truncated");
+        }
+        auto bytes = m_data.data() + m_offset;
+        m_offset += static_cast<size_t>(size);
+        return bytes;
+    }
+
+    const std::vector<std::byte>& m_data;
+    size_t m_offset = 0;
+};
+
+// Persistent cache of byte values in a directory, shared by every process that uses the same directory. Each entry
+// is stored in a file named after a hash of its key, and the file also holds the full key, so entries of keys with
+// the same hash are never confused (the later one replaces the earlier one).
+//
+// Entries are written to a temporary file and renamed into place, so a reader (in this or another process) never
+// sees a partially written entry. Loading an entry marks it as used; when the entries exceed the maximum size, the
+// least recently used ones are removed. The cache is best effort: I/O errors only make entries miss.
+class DiskCache
+{
+public:
+    DiskCache(std::filesystem::path directory, uint64_t maxSizeInBytes) :
+        m_directory(std::move(directory)), m_maxSizeInBytes(maxSizeInBytes)
+    {
+    }
+
+    const std::filesystem::path& Directory() const { return m_directory; }
+
+    // 64-bit FNV-1a. Used to name entries and to summarize contents (e.g. of files) that are part of keys.
+    static uint64_t Hash(const void* data, size_t size, uint64_t hash = 0xcbf29ce484222325ull)
+    {
+        auto bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; i++)
+        {
+            hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    std::optional<std::vector<std::byte>> Load(const std::string& key) const
+    {
+        auto path = GetEntryPath(key);
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file)
+        {
+            return std::nullopt;
+        }
+
+        std::vector<std::byte> contents(static_cast<size_t>(file.tellg()));
+        file.seekg(0, std::ios::beg);
+        if (!file.read(reinterpret_cast<char*>(contents.data()), contents.size()))
+        {
+            return std::nullopt;
+        }
+        file.close();
+
+        std::vector<std::byte> value;
+        try
+        {
+            CacheEntryReader reader(contents);
+            if (reader.Read<uint32_t>() != c_magic || reader.Read<uint32_t>() != c_version || reader.ReadString() != key)
+            {
+                return std::nullopt;
+            }
+            value = reader.ReadArray();
+            if (!reader.AtEnd())
+            {
+                return std::nullopt;
+            }
+        }
+        catch (const std::runtime_error&)
+        {
+            return std::nullopt;
+        }
+
+        std::error_code error;
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+        return value;
+    }
+
+    // Returns false if the entry couldn't be written.
+    bool Store(const std::string& key, const std::vector<std::byte>& value) const
+    {
+        std::error_code error;
+        std::filesystem::create_directories(m_directory, error);
+
+        CacheEntryWriter writer;
+        writer.Write(c_magic);
+        writer.Write(c_version);
+        writer.WriteString(key);
+        writer.WriteArray(value.data(), value.size());
+
+        auto path = GetEntryPath(key);
+        auto temporaryPath = path;
+        temporaryPath += GetTemporarySuffix();
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(writer.Data().data()), writer.Data().size());
+            if (!file.flush())
+            {
+                file.close();
+                std::filesystem::remove(temporaryPath, error);
+                return false;
+            }
+        }
+
+        std::filesystem::rename(temporaryPath, path, error);
+        if (error)
+        {
+            std::filesystem::remove(temporaryPath, error);
+            return false;
+        }
+
+        Evict();
+        return true;
+    }
+
+    // Removes the least recently used entries until the entries fit in the maximum size.
+    void Evict() const
+    {
+        struct Entry
+        {
+            std::filesystem::path path;
+            uint64_t size;
+            std::filesystem::file_time_type lastUsed;
+        };
+
+        std::vector<Entry> entries;
+        uint64_t totalSize = 0;
+        std::error_code error;
+        for (auto it = std::filesystem::directory_iterator(m_directory, error); !error && it != std::filesystem::directory_iterator(); it.increment(error))
+        {
+            if (it->path().extension() != c_extension)
+            {
+                continue;
+            }
+
+            std::error_code entryError;
+            Entry entry = { it->path(), it->file_size(entryError), it->last_write_time(entryError) };
+            if (!entryError)
+            {
+                totalSize += entry.size;
+                entries.push_back(std::move(entry));
+            }
+        }
+
+        std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.lastUsed < b.lastUsed; });
+        for (size_t i = 0; i < entries.size() && totalSize > m_maxSizeInBytes; i++)
+        {
+            if (std::filesystem::remove(entries[i].path, error))
+            {
+                totalSize -= entries[i].size;
+            }
+        }
+    }
+
+private:
+    static constexpr uint32_t c_magic = 0x43445844; // 'DXDC'
+    static constexpr uint32_t c_version = 1;
+    static constexpr const char* c_extension = ".dxcache";
+
+    std::filesystem::path GetEntryPath(const std::string& key) const
+    {
+        char name[17];
+        std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(Hash(key.data(), key.size())));
+        return m_directory / (std::string(name) + c_extension);
+    }
+
+    // Temporary files of concurrent writers (threads or processes) must not collide, and don't have the entry
+    // extension, so they're never loaded or counted.
+    static std::string GetTemporarySuffix()
+    {
+        auto time = std::chrono::high_resolution_clock::now().time_since_epoch().count();
+        auto thread = std::hash<std::thread::id>()(std::this_thread::get_id());
+        return ".tmp" + std::to_string(thread) + "_" + std::to_string(time) + "_" + std::to_string(std::random_device()());
+    }
+
+    std::filesystem::path m_directory;
+    uint64_t m_maxSizeInBytes;
+};
@@ -31,9 +31,75 @@ struct Dispatchable
     // Maps bind points (target names) to a source resources.
     using Bindings = std::unordered_map<std::string, std::vector<BindingSource>>;
 
+    // Counts how often Bind() reused existing binding state (hits) instead of rebuilding it (misses).
+    struct BindingCacheStats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+    };
+
+    // A resource read or written by a dispatch. Used to plan barriers between dispatches.
+    struct ResourceAccess
+    {
+        ID3D12Resource* resource;
+        std::string name;
+        bool write;
+        bool transient = false; // From the transient pool of the queue the dispatch runs on.
+    };
+
     virtual ~Dispatchable() = default;
 
+    // Performs the CPU-side work of preparing the dispatchable (e.g. compiling shaders or operators). Compile doesn't
+    // record onto the device's command list, so different dispatchables are compiled concurrently.
+    virtual void Compile() {}
+
+    // Records initialization work (e.g. uploads and operator initialization) onto the device's command list. Called
+    // on the main thread after Compile.
     virtual void Initialize() = 0;
     virtual void Bind(const Bindings& bindings, uint32_t iteration) = 0;
     virtual void Dispatch(const Model::DispatchCommand& args, uint32_t iteration, DeferredBindings& deferredBinings) = 0;
+
+    // Returns true if the dispatchable supports RecordDispatch.
+    virtual bool SupportsRecordingTargets() const { return false; }
+
+    // Records the dispatch into a target other than the device command list, without submitting it or recording
+    // timestamps. Bind() must be called first (on the main thread); recording must not modify shared state, so
+    // different dispatchables can be recorded into different targets concurrently.
+    virtual void RecordDispatch(const Model::DispatchCommand& args, const Device::RecordingTarget& target)
+    {
+        throw std::runtime_error(fmt::format("Dispatchable '{}' can't be recorded into other command lists.", args.dispatchableName));
+    }
+
+    // Returns true if the dispatchable supports SetBindingShapes.
+    virtual bool SupportsBindingShapes() const { return false; }
+
+    // Overrides the shapes of tensors (by name) in the following Bind() calls with iteration 0, on top of the shapes
+    // given on the command line; an empty map restores them. Used to sweep the shapes of a dynamic-shape model
+    // without recreating it.
+    virtual void SetBindingShapes(const std::unordered_map<std::string, std::vector<int64_t>>& shapes)
+    {
+        throw std::runtime_error("This dispatchable doesn't support binding shapes.");
+    }
+
+    // Returns cumulative binding cache stats, or nullopt if the dispatchable doesn't cache bindings.
+    virtual std::optional<BindingCacheStats> GetBindingCacheStats() const { return std::nullopt; }
+
+    // Returns the resources accessed when dispatching with the given (already bound) bindings. By default every
+    // bound resource is conservatively assumed to be written.
+    virtual std::vector<ResourceAccess> GetResourceAccesses(const Bindings& bindings) const
+    {
+        std::vector<ResourceAccess> accesses;
+        for (auto& binding : bindings)
+        {
+            for (auto& source : binding.second)
+            {
+                // Unbound optional tensors have no resource to access.
+                if (source.resource)
+                {
+                    accesses.push_back({ source.resource, source.resourceDesc ? source.resourceDesc->name : binding.first, true });
+                }
+            }
+        }
+        return accesses;
+    }
 };
\ No newline at end of file
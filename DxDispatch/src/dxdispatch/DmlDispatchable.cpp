@@ -9,6 +9,122 @@
 
 using Microsoft::WRL::ComPtr;
 
+static SharedCache<ComPtr<IDMLCompiledOperator>>& GetCompiledOperatorCache()
+{
+    static SharedCache<ComPtr<IDMLCompiledOperator>> cache;
+    return cache;
+}
+
+SharedCacheStats DmlDispatchable::GetCompiledOperatorCacheStats()
+{
+    return GetCompiledOperatorCache().GetStats();
+}
+
+// Appends an encoding of values to a compiled operator cache key. Array sizes and the presence of optional values are
+// encoded along with the values, so two operator descs have the same encoding only if all of their fields are equal.
+class OperatorKeyWriter
+{
+public:
+    explicit OperatorKeyWriter(std::string& key) : m_key(key) {}
+
+    template <typename T>
+    void operator()(const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        m_key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    template <typename T>
+    void operator()(const std::optional<T>& value)
+    {
+        (*this)(value.has_value());
+        if (value)
+        {
+            (*this)(*value);
+        }
+    }
+
+    template <typename T>
+    void operator()(const std::vector<T>& values)
+    {
+        (*this)(values.size());
+        for (auto& value : values)
+        {
+            (*this)(value);
+        }
+    }
+
+    void operator()(const DmlBufferTensorDesc& desc)
+    {
+        (*this)(desc.dataType);
+        (*this)(desc.flags);
+        (*this)(desc.sizes);
+        (*this)(desc.strides);
+        (*this)(desc.totalTensorSizeInBytes);
+        (*this)(desc.guaranteedBaseOffsetAlignment);
+    }
+
+    void operator()(const AbstractOperatorDesc& desc)
+    {
+        (*this)(desc.schema->OperatorType);
+        (*this)(desc.fields.size());
+        for (auto& field : desc.fields)
+        {
+            std::visit(*this, field.GetData());
+        }
+    }
+
+private:
+    std::string& m_key;
+};
+
+// Returns the key of an operator's compiled form, or nullopt if the operator's type is unknown to the schema helpers
+// (in which case it's compiled without being shared).
+static std::optional<std::string> GetCompiledOperatorKey(const std::string& dmlCacheKey, const Model::DmlDispatchableDesc& desc)
+{
+    if (!SchemaHelpers::IsValidOperator(desc.desc->Type))
+    {
+        return std::nullopt;
+    }
+
+    std::string key = dmlCacheKey + ":";
+    OperatorKeyWriter writer(key);
+    writer(desc.compileType);
+    writer(desc.executionFlags);
+    if (desc.compileType == Model::DmlDispatchableDesc::DmlCompileType::DmlCompileGraph)
+    {
+        // Only bind points that require a binding are connected to the graph.
+        for (auto& bindPoint : desc.bindPoints.inputs) { writer(bindPoint.requiredBinding); }
+        for (auto& bindPoint : desc.bindPoints.outputs) { writer(bindPoint.requiredBinding); }
+    }
+    writer(SchemaHelpers::ConvertOperatorDesc(*desc.desc));
+    return key;
+}
+
+template <typename TCompile>
+static std::shared_ptr<const ComPtr<IDMLCompiledOperator>> GetOrCompileOperator(
+    IDMLDevice1* device,
+    const std::optional<std::string>& key, 
+    TCompile&& compile)
+{
+    if (!key)
+    {
+        return std::make_shared<const ComPtr<IDMLCompiledOperator>>(compile());
+    }
+
+    // Keys identify the adapter rather than the DML device, and a compiled operator can only be used with the DML
+    // device that compiled it. Devices with the same key share their DML device, so this only happens if the adapter's
+    // D3D device was recreated while the shared operator was still in use; the operator is then compiled unshared.
+    auto compiledOperator = GetCompiledOperatorCache().GetOrCreate(*key, compile);
+    ComPtr<IDMLDevice1> compiledOperatorDevice;
+    THROW_IF_FAILED((*compiledOperator)->GetDevice(IID_PPV_ARGS(&compiledOperatorDevice)));
+    if (compiledOperatorDevice.Get() != device)
+    {
+        return std::make_shared<const ComPtr<IDMLCompiledOperator>>(compile());
+    }
+    return compiledOperator;
+}
+
 DmlDispatchable::DmlDispatchable(
     std::string_view name, 
     std::shared_ptr<Device> device, 
@@ -39,11 +155,15 @@ DmlDispatchable::DmlDispatchable(
 {
 }
 
-struct BindingData
+DmlDispatchable::~DmlDispatchable()
 {
-    std::vector<DML_BUFFER_BINDING> bufferBindings;
-    std::vector<DML_BINDING_DESC> bindingDescs;
-};
+    if (m_descriptors.count > 0)
+    {
+        m_device->FreePersistentDescriptors(m_descriptors);
+    }
+}
+
+using BindingData = DmlDispatchable::BindingData;
 
 uint64_t SafeMultiply(uint64_t a, uint64_t b)
 {
@@ -152,6 +272,7 @@ void FillBindingData(
                 bindingData.bufferBindings[bufferIndex].Offset = offset;
                 bindingData.bindingDescs[bufferIndex].Type = DML_BINDING_TYPE_BUFFER;
                 bindingData.bindingDescs[bufferIndex].Desc = &bindingData.bufferBindings[bufferIndex];
+                bindingData.resources.push_back(source.resource);
                 bufferIndex++;
             }
         }
@@ -343,140 +464,174 @@ void DmlDispatchable::BuildAndCompileGraph()
 
     std::vector<std::unique_ptr<std::byte[]>> rawData;
     DmlSerializedGraphDesc serializedDesc = DeserializeDmlGraph(blob.data(), rawData);
-    std::unordered_map<std::string, DML_TENSOR_DATA_TYPE> constantDataTypes;
 
     m_bindPoints = GetSerializedBindPoints(serializedDesc);
-    constantDataTypes = ExtractConstantDataTypes(serializedDesc);
-    m_initBindings  = GenerateInitialBindingsFromGraph(serializedDesc, constantDataTypes);
+    m_constantDataTypes = ExtractConstantDataTypes(serializedDesc);
+    m_initBindings  = GenerateInitialBindingsFromGraph(serializedDesc, m_constantDataTypes);
 
+    // Constants loaded from files are uploaded in Initialize, which records onto the device's command list.
     for (const auto& node : serializedDesc.Nodes)
     {
         const auto* constantVariantPtr = std::get_if<DmlSerializedGraphNodeConstantVariant>(&node.Desc);
         if (constantVariantPtr && std::holds_alternative<ConstantName>(*constantVariantPtr))
         {
-            CreateResourceFromConstantNode(node, constantDataTypes);
+            m_constantNodes.push_back(node);
         }
     }
 
-    // Convert to Public Graph Description
-    BucketAllocator allocator;
-    DML_GRAPH_DESC dmlGraphDesc = {};
-    std::vector<Microsoft::WRL::ComPtr<IDMLOperator>> dmlOperators;
-    std::vector<DML_GRAPH_NODE_DESC> dmlGraphNodes;
-    std::vector<DML_GRAPH_EDGE_DESC> dmlInputEdges;
-    std::vector<DML_GRAPH_EDGE_DESC> dmlOutputEdges;
-    std::vector<DML_GRAPH_EDGE_DESC> dmlIntermediateEdges;
-
-    ConvertGraphDesc(
-        serializedDesc,
-        serializedDesc.InputCount,
-        serializedDesc.OutputCount,
-        m_device->DML(),
-        allocator,
-        nullptr, 
-        nullptr, 
-        dmlGraphDesc,
-        dmlOperators,
-        dmlGraphNodes,
-        dmlInputEdges,
-        dmlOutputEdges,
-        dmlIntermediateEdges);
-
-    //Compile the graph
-    THROW_IF_FAILED(m_device->DML()->CompileGraph(
-        &dmlGraphDesc,
-        DML_EXECUTION_FLAG_NONE,
-        IID_PPV_ARGS(&m_compiledOperator)));
+    // The compiled graph only depends on the serialized graph (constants are bound as inputs), so it's shared with
+    // other dispatchables that load the same graph.
+    std::string key = fmt::format("serialized:{}:", m_device->GetDmlCacheKey());
+    key.append(reinterpret_cast<const char*>(blob.data()), blob.size());
+
+    m_sharedCompiledOperator = GetOrCompileOperator(m_device->DML(), key, [&]
+    {
+        // Convert to Public Graph Description
+        BucketAllocator allocator;
+        DML_GRAPH_DESC dmlGraphDesc = {};
+        std::vector<Microsoft::WRL::ComPtr<IDMLOperator>> dmlOperators;
+        std::vector<DML_GRAPH_NODE_DESC> dmlGraphNodes;
+        std::vector<DML_GRAPH_EDGE_DESC> dmlInputEdges;
+        std::vector<DML_GRAPH_EDGE_DESC> dmlOutputEdges;
+        std::vector<DML_GRAPH_EDGE_DESC> dmlIntermediateEdges;
+
+        ConvertGraphDesc(
+            serializedDesc,
+            serializedDesc.InputCount,
+            serializedDesc.OutputCount,
+            m_device->DML(),
+            allocator,
+            nullptr, 
+            nullptr, 
+            dmlGraphDesc,
+            dmlOperators,
+            dmlGraphNodes,
+            dmlInputEdges,
+            dmlOutputEdges,
+            dmlIntermediateEdges);
+
+        //Compile the graph
+        ComPtr<IDMLCompiledOperator> compiledOperator;
+        THROW_IF_FAILED(m_device->DML()->CompileGraph(
+            &dmlGraphDesc,
+            DML_EXECUTION_FLAG_NONE,
+            IID_PPV_ARGS(&compiledOperator)));
+        return compiledOperator;
+    });
+    m_compiledOperator = *m_sharedCompiledOperator;
 }
 
-void DmlDispatchable::Initialize()
+void DmlDispatchable::Compile()
 {
     if (!m_isSerializedGraph)
     {
         const auto& dmlDesc = std::get<Model::DmlDispatchableDesc>(m_desc);
+        auto key = GetCompiledOperatorKey(m_device->GetDmlCacheKey(), dmlDesc);
     
         if (dmlDesc.compileType == Model::DmlDispatchableDesc::DmlCompileType::DmlCompileOp)
         {
             m_logger->LogInfo("Compile Op");
-            THROW_IF_FAILED(m_device->DML()->CompileOperator(
-                m_operator.Get(), 
-                dmlDesc.executionFlags, 
-                IID_PPV_ARGS(m_compiledOperator.ReleaseAndGetAddressOf())));
-            m_compiledOperator->SetName(std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(m_name).data());
-
+            m_sharedCompiledOperator = GetOrCompileOperator(m_device->DML(), key, [&]
+            {
+                ComPtr<IDMLCompiledOperator> compiledOperator;
+                THROW_IF_FAILED(m_device->DML()->CompileOperator(
+                    m_operator.Get(), 
+                    dmlDesc.executionFlags, 
+                    IID_PPV_ARGS(&compiledOperator)));
+                compiledOperator->SetName(std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(m_name).data());
+                return compiledOperator;
+            });
         }
         else if (dmlDesc.compileType == Model::DmlDispatchableDesc::DmlCompileType::DmlCompileGraph)
         {
             m_logger->LogInfo("Compiling op using IDMLDevice1::CompileGraph");
-            DML_GRAPH_DESC dmlGraphDesc = {};
-            std::vector<DML_INPUT_GRAPH_EDGE_DESC> dmlInputGraphEdges;
-            std::vector<DML_GRAPH_EDGE_DESC> dmlInputEdges;
-            
-            std::vector<DML_OUTPUT_GRAPH_EDGE_DESC> dmlOutputGraphEdges;
-            std::vector<DML_GRAPH_EDGE_DESC> dmlOutputEdges;
-            DML_GRAPH_NODE_DESC dmlGraphNodeDesc = {};
-            DML_OPERATOR_GRAPH_NODE_DESC nodeDesc{};
+            m_sharedCompiledOperator = GetOrCompileOperator(m_device->DML(), key, [&]
+            {
+                DML_GRAPH_DESC dmlGraphDesc = {};
+                std::vector<DML_INPUT_GRAPH_EDGE_DESC> dmlInputGraphEdges;
+                std::vector<DML_GRAPH_EDGE_DESC> dmlInputEdges;
 
-            nodeDesc.Operator = m_operator.Get();
-            nodeDesc.Name = m_name.c_str();
+                std::vector<DML_OUTPUT_GRAPH_EDGE_DESC> dmlOutputGraphEdges;
+                std::vector<DML_GRAPH_EDGE_DESC> dmlOutputEdges;
+                DML_GRAPH_NODE_DESC dmlGraphNodeDesc = {};
+                DML_OPERATOR_GRAPH_NODE_DESC nodeDesc{};
 
-            {
-                dmlGraphNodeDesc.Type = DML_GRAPH_NODE_TYPE_OPERATOR;
-                dmlGraphNodeDesc.Desc = &nodeDesc;
-            }
+                nodeDesc.Operator = m_operator.Get();
+                nodeDesc.Name = m_name.c_str();
 
-            dmlInputGraphEdges.resize(dmlDesc.bindPoints.inputs.size());
-            for (size_t i = 0; i < dmlDesc.bindPoints.inputs.size(); i++)
-            {
-                if (dmlDesc.bindPoints.inputs[i].requiredBinding)
                 {
-                    DML_INPUT_GRAPH_EDGE_DESC desc = {};
-                    desc.GraphInputIndex = gsl::narrow_cast<UINT>(i);
-                    desc.ToNodeIndex = 0;
-                    desc.ToNodeInputIndex = gsl::narrow_cast<UINT>(i);
-                    desc.Name = dmlDesc.bindPoints.inputs[i].name.c_str();
-                    dmlInputGraphEdges[i] = desc;
-                    dmlInputEdges.push_back({ DML_GRAPH_EDGE_TYPE_INPUT, &dmlInputGraphEdges[i] });
+                    dmlGraphNodeDesc.Type = DML_GRAPH_NODE_TYPE_OPERATOR;
+                    dmlGraphNodeDesc.Desc = &nodeDesc;
                 }
-            }
 
-            dmlOutputGraphEdges.resize(dmlDesc.bindPoints.outputs.size());
-            for (size_t i = 0; i < dmlDesc.bindPoints.outputs.size(); i++)
-            {
-                if (dmlDesc.bindPoints.outputs[i].requiredBinding)
+                dmlInputGraphEdges.resize(dmlDesc.bindPoints.inputs.size());
+                for (size_t i = 0; i < dmlDesc.bindPoints.inputs.size(); i++)
                 {
-                    DML_OUTPUT_GRAPH_EDGE_DESC desc = {};
-                    desc.GraphOutputIndex = gsl::narrow_cast<UINT>(i);
-                    desc.FromNodeIndex = 0;
-                    desc.FromNodeOutputIndex = gsl::narrow_cast<UINT>(i);
-                    desc.Name = dmlDesc.bindPoints.outputs[i].name.c_str();
-                    dmlOutputGraphEdges[i] = desc;
-                    dmlOutputEdges.push_back({ DML_GRAPH_EDGE_TYPE_OUTPUT, &dmlOutputGraphEdges[i] });
+                    if (dmlDesc.bindPoints.inputs[i].requiredBinding)
+                    {
+                        DML_INPUT_GRAPH_EDGE_DESC desc = {};
+                        desc.GraphInputIndex = gsl::narrow_cast<UINT>(i);
+                        desc.ToNodeIndex = 0;
+                        desc.ToNodeInputIndex = gsl::narrow_cast<UINT>(i);
+                        desc.Name = dmlDesc.bindPoints.inputs[i].name.c_str();
+                        dmlInputGraphEdges[i] = desc;
+                        dmlInputEdges.push_back({ DML_GRAPH_EDGE_TYPE_INPUT, &dmlInputGraphEdges[i] });
+                    }
                 }
-            }
 
-            dmlGraphDesc.InputCount = static_cast<uint32_t>(dmlInputEdges.size());
-            dmlGraphDesc.InputEdges = dmlInputEdges.data();
-            dmlGraphDesc.InputEdgeCount = dmlGraphDesc.InputCount;
+                dmlOutputGraphEdges.resize(dmlDesc.bindPoints.outputs.size());
+                for (size_t i = 0; i < dmlDesc.bindPoints.outputs.size(); i++)
+                {
+                    if (dmlDesc.bindPoints.outputs[i].requiredBinding)
+                    {
+                        DML_OUTPUT_GRAPH_EDGE_DESC desc = {};
+                        desc.GraphOutputIndex = gsl::narrow_cast<UINT>(i);
+                        desc.FromNodeIndex = 0;
+                        desc.FromNodeOutputIndex = gsl::narrow_cast<UINT>(i);
+                        desc.Name = dmlDesc.bindPoints.outputs[i].name.c_str();
+                        dmlOutputGraphEdges[i] = desc;
+                        dmlOutputEdges.push_back({ DML_GRAPH_EDGE_TYPE_OUTPUT, &dmlOutputGraphEdges[i] });
+                    }
+                }
+
+                dmlGraphDesc.InputCount = static_cast<uint32_t>(dmlInputEdges.size());
+                dmlGraphDesc.InputEdges = dmlInputEdges.data();
+                dmlGraphDesc.InputEdgeCount = dmlGraphDesc.InputCount;
 
-            dmlGraphDesc.OutputCount = static_cast<uint32_t>(dmlOutputEdges.size());
-            dmlGraphDesc.OutputEdges = dmlOutputEdges.data();
-            dmlGraphDesc.OutputEdgeCount = dmlGraphDesc.OutputCount;
+                dmlGraphDesc.OutputCount = static_cast<uint32_t>(dmlOutputEdges.size());
+                dmlGraphDesc.OutputEdges = dmlOutputEdges.data();
+                dmlGraphDesc.OutputEdgeCount = dmlGraphDesc.OutputCount;
 
-            dmlGraphDesc.IntermediateEdgeCount = 0;
-            dmlGraphDesc.IntermediateEdges = nullptr;
+                dmlGraphDesc.IntermediateEdgeCount = 0;
+                dmlGraphDesc.IntermediateEdges = nullptr;
 
-            dmlGraphDesc.NodeCount = 1;
-            dmlGraphDesc.Nodes = &dmlGraphNodeDesc;
+                dmlGraphDesc.NodeCount = 1;
+                dmlGraphDesc.Nodes = &dmlGraphNodeDesc;
 
-            THROW_IF_FAILED(m_device->DML()->CompileGraph(&dmlGraphDesc, dmlDesc.executionFlags, IID_PPV_ARGS(&m_compiledOperator)));
-            m_compiledOperator->SetName(std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(fmt::format("Graph_{}", m_name)).data());
-        }   
+                ComPtr<IDMLCompiledOperator> compiledOperator;
+                THROW_IF_FAILED(m_device->DML()->CompileGraph(&dmlGraphDesc, dmlDesc.executionFlags, IID_PPV_ARGS(&compiledOperator)));
+                compiledOperator->SetName(std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(fmt::format("Graph_{}", m_name)).data());
+                return compiledOperator;
+            });
+        }
+        m_compiledOperator = *m_sharedCompiledOperator;
     }
     else
     {
         BuildAndCompileGraph();
     }
+}
+
+void DmlDispatchable::Initialize()
+{
+    for (const auto& node : m_constantNodes)
+    {
+        CreateResourceFromConstantNode(node, m_constantDataTypes);
+    }
+
+    // Temporary resources of all DML dispatchables share the device's transient pool, so reserve the space required 
+    // for dispatch before the pool is created for initialization below.
+    m_device->ReserveTransientMemory(m_compiledOperator->GetBindingProperties().TemporaryResourceSize);
 
     ComPtr<IDMLOperatorInitializer> initializer;
     IDMLCompiledOperator* ops[] = { m_compiledOperator.Get() };
@@ -487,22 +642,14 @@ void DmlDispatchable::Initialize()
 
     auto min = initializer->GetBindingProperties().RequiredDescriptorCount;
 
-    // Create a descriptor heap with at least one descriptor. Even if the op doesn't require any descriptors the
-    // binding table expects valid descriptor handles.
-    ComPtr<ID3D12DescriptorHeap> descriptorHeap;
-    D3D12_DESCRIPTOR_HEAP_DESC descriptorHeapDesc = {};
-    descriptorHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-    descriptorHeapDesc.NumDescriptors = std::max(1u, initializer->GetBindingProperties().RequiredDescriptorCount);
-    descriptorHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-    THROW_IF_FAILED(m_device->D3D()->CreateDescriptorHeap(&descriptorHeapDesc, IID_GRAPHICS_PPV_ARGS(descriptorHeap.ReleaseAndGetAddressOf())));
-
-    ID3D12DescriptorHeap* descriptorHeaps[] = { descriptorHeap.Get() };
-    m_device->GetCommandList()->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
+    // Allocate at least one descriptor. Even if the op doesn't require any descriptors the binding table expects 
+    // valid descriptor handles. The initializer's descriptors are only needed for a single submission.
+    auto descriptors = m_device->AllocateTransientDescriptors(std::max(1u, initializer->GetBindingProperties().RequiredDescriptorCount));
 
     DML_BINDING_TABLE_DESC bindingTableDesc = {};
     bindingTableDesc.Dispatchable = initializer.Get();
-    bindingTableDesc.CPUDescriptorHandle = descriptorHeap->GetCPUDescriptorHandleForHeapStart();
-    bindingTableDesc.GPUDescriptorHandle = descriptorHeap->GetGPUDescriptorHandleForHeapStart();
+    bindingTableDesc.CPUDescriptorHandle = descriptors.cpuHandle;
+    bindingTableDesc.GPUDescriptorHandle = descriptors.gpuHandle;
     bindingTableDesc.SizeInDescriptors = initializer->GetBindingProperties().RequiredDescriptorCount;
 
     ComPtr<IDMLBindingTable> bindingTable;
@@ -537,7 +684,7 @@ void DmlDispatchable::Initialize()
     auto tempBufferSize = initializer->GetBindingProperties().TemporaryResourceSize;
     if (tempBufferSize > 0)
     {
-        ComPtr<ID3D12Resource> tempBuffer = m_device->CreatePreferredDeviceMemoryBuffer(tempBufferSize);
+        ComPtr<ID3D12Resource> tempBuffer = m_device->AcquireTransientBuffer(tempBufferSize);
         DML_BUFFER_BINDING bufferBinding = { tempBuffer.Get(), 0, tempBufferSize };
         DML_BINDING_DESC bindingDesc = { DML_BINDING_TYPE_BUFFER, &bufferBinding };
         bindingTable->BindTemporaryResource(&bindingDesc);
@@ -549,16 +696,47 @@ void DmlDispatchable::Initialize()
     if (persistentBufferSize > 0)
     {
         m_persistentBuffer = m_device->CreatePreferredDeviceMemoryBuffer(persistentBufferSize);
+        m_device->TrackMemory(m_persistentBuffer.Get(), MemoryCategory::DmlPersistent);
         DML_BUFFER_BINDING bufferBinding = { m_persistentBuffer.Get(), 0, persistentBufferSize };
         DML_BINDING_DESC bindingDesc = { DML_BINDING_TYPE_BUFFER, &bufferBinding };
         bindingTable->BindOutputs(1, &bindingDesc);
     }
 
-    m_device->KeepAliveUntilNextCommandListDispatch(std::move(descriptorHeap));
     m_device->RecordInitialize(initializer.Get(), bindingTable.Get());
     m_device->ExecuteCommandListAndWait();
 }
 
+// Returns true if both binding groups reference the same buffer ranges.
+static bool IsSameBindingData(const BindingData& a, const BindingData& b)
+{
+    if (a.bindingDescs.size() != b.bindingDescs.size())
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < a.bindingDescs.size(); i++)
+    {
+        if (a.bindingDescs[i].Type != b.bindingDescs[i].Type)
+        {
+            return false;
+        }
+
+        if (a.bindingDescs[i].Type == DML_BINDING_TYPE_BUFFER)
+        {
+            auto& bufferA = *static_cast<const DML_BUFFER_BINDING*>(a.bindingDescs[i].Desc);
+            auto& bufferB = *static_cast<const DML_BUFFER_BINDING*>(b.bindingDescs[i].Desc);
+            if (bufferA.Buffer != bufferB.Buffer || 
+                bufferA.Offset != bufferB.Offset || 
+                bufferA.SizeInBytes != bufferB.SizeInBytes)
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
 void DmlDispatchable::Bind(const Bindings& bindings, uint32_t iteration)
 {
     auto bindingProps = m_compiledOperator->GetBindingProperties();
@@ -576,62 +754,122 @@ void DmlDispatchable::Bind(const Bindings& bindings, uint32_t iteration)
     FillBindingData(m_bindPoints.inputs, &m_initBindings, &bindings, inputBindingData, m_isSerializedGraph, false, compileType);
     FillBindingData(m_bindPoints.outputs, &m_initBindings, &bindings, outputBindingData, m_isSerializedGraph, false, compileType);
 
-    D3D12_DESCRIPTOR_HEAP_DESC descriptorHeapDesc = {};
-    descriptorHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-    descriptorHeapDesc.NumDescriptors = bindingProps.RequiredDescriptorCount;
-    descriptorHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-    THROW_IF_FAILED(m_device->D3D()->CreateDescriptorHeap(
-        &descriptorHeapDesc, 
-        IID_GRAPHICS_PPV_ARGS(m_descriptorHeap.ReleaseAndGetAddressOf())));
+    // The descriptors, binding table, and temporary resource are created once and reused for every iteration. 
+    // Only the bind points whose resources changed are rebound. Rebinding overwrites descriptors in place, which is
+    // safe because bindings only change between dispatch commands and the Executor waits for the GPU after each one.
+    bool inputsChanged = !m_bindingTable || !IsSameBindingData(inputBindingData, m_boundInputs);
+    bool outputsChanged = !m_bindingTable || !IsSameBindingData(outputBindingData, m_boundOutputs);
 
-    ID3D12DescriptorHeap* descriptorHeaps[] = { m_descriptorHeap.Get() };
-    m_device->GetCommandList()->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
+    if (!m_bindingTable)
+    {
+        m_descriptors = m_device->AllocatePersistentDescriptors(std::max(1u, bindingProps.RequiredDescriptorCount));
 
-    DML_BINDING_TABLE_DESC bindingTableDesc = {};
-    bindingTableDesc.Dispatchable = m_compiledOperator.Get();
-    bindingTableDesc.CPUDescriptorHandle = m_descriptorHeap->GetCPUDescriptorHandleForHeapStart();
-    bindingTableDesc.GPUDescriptorHandle = m_descriptorHeap->GetGPUDescriptorHandleForHeapStart();
-    bindingTableDesc.SizeInDescriptors = bindingProps.RequiredDescriptorCount;
+        DML_BINDING_TABLE_DESC bindingTableDesc = {};
+        bindingTableDesc.Dispatchable = m_compiledOperator.Get();
+        bindingTableDesc.CPUDescriptorHandle = m_descriptors.cpuHandle;
+        bindingTableDesc.GPUDescriptorHandle = m_descriptors.gpuHandle;
+        bindingTableDesc.SizeInDescriptors = bindingProps.RequiredDescriptorCount;
 
-    THROW_IF_FAILED(m_device->DML()->CreateBindingTable(&bindingTableDesc, IID_PPV_ARGS(m_bindingTable.ReleaseAndGetAddressOf())));
+        THROW_IF_FAILED(m_device->DML()->CreateBindingTable(&bindingTableDesc, IID_PPV_ARGS(m_bindingTable.ReleaseAndGetAddressOf())));
 
-    if (inputBindingData.bindingDescs.size() > std::numeric_limits<uint32_t>::max())
-    {
-        throw std::invalid_argument(fmt::format("BindInputs count  '{}' is too large.", inputBindingData.bindingDescs.size()));
+        auto persistentBufferSize = bindingProps.PersistentResourceSize;
+        if (persistentBufferSize > 0)
+        {
+            DML_BUFFER_BINDING bufferBinding = { m_persistentBuffer.Get(), 0, persistentBufferSize };
+            DML_BINDING_DESC bindingDesc = { DML_BINDING_TYPE_BUFFER, &bufferBinding };
+            m_bindingTable->BindPersistentResource(&bindingDesc);
+        }
     }
-    m_bindingTable->BindInputs(static_cast<uint32_t>(inputBindingData.bindingDescs.size()), inputBindingData.bindingDescs.data());
 
-    ComPtr<ID3D12Resource> tempBuffer;
+    // The temporary resource comes from the transient pool of the queue it's dispatched on, so it's only rebound when
+    // the dispatchable moves to another queue (e.g. when it's scheduled in a dispatch graph).
     auto tempBufferSize = bindingProps.TemporaryResourceSize;
-    if (tempBufferSize > 0)
+    if (tempBufferSize > 0 && (!m_temporaryBuffer || m_temporaryBufferQueue != m_device->GetActiveQueue()))
     {
-        tempBuffer = m_device->CreatePreferredDeviceMemoryBuffer(tempBufferSize);
+        m_temporaryBuffer = m_device->AcquireTransientBuffer(tempBufferSize);
+        m_temporaryBufferQueue = m_device->GetActiveQueue();
 
-        DML_BUFFER_BINDING bufferBinding = { tempBuffer.Get(), 0, tempBufferSize };
+        DML_BUFFER_BINDING bufferBinding = { m_temporaryBuffer.Get(), 0, tempBufferSize };
         DML_BINDING_DESC bindingDesc = { DML_BINDING_TYPE_BUFFER, &bufferBinding };
         m_bindingTable->BindTemporaryResource(&bindingDesc);
-        m_device->KeepAliveUntilNextCommandListDispatch(std::move(tempBuffer)); 
     }
 
-    auto persistentBufferSize = bindingProps.PersistentResourceSize;
-    if (persistentBufferSize > 0)
+    if (inputsChanged)
     {
-        DML_BUFFER_BINDING bufferBinding = { m_persistentBuffer.Get(), 0, persistentBufferSize };
-        DML_BINDING_DESC bindingDesc = { DML_BINDING_TYPE_BUFFER, &bufferBinding };
-        m_bindingTable->BindPersistentResource(&bindingDesc);
+        if (inputBindingData.bindingDescs.size() > std::numeric_limits<uint32_t>::max())
+        {
+            throw std::invalid_argument(fmt::format("BindInputs count  '{}' is too large.", inputBindingData.bindingDescs.size()));
+        }
+        m_bindingTable->BindInputs(static_cast<uint32_t>(inputBindingData.bindingDescs.size()), inputBindingData.bindingDescs.data());
+        m_boundInputs = std::move(inputBindingData);
     }
-    if (outputBindingData.bindingDescs.size() > std::numeric_limits<uint32_t>::max())
+
+    if (outputsChanged)
     {
-        throw std::invalid_argument(fmt::format("BindOutputs count  '{}' is too large.", outputBindingData.bindingDescs.size()));
+        if (outputBindingData.bindingDescs.size() > std::numeric_limits<uint32_t>::max())
+        {
+            throw std::invalid_argument(fmt::format("BindOutputs count  '{}' is too large.", outputBindingData.bindingDescs.size()));
+        }
+        m_bindingTable->BindOutputs(static_cast<uint32_t>(outputBindingData.bindingDescs.size()), outputBindingData.bindingDescs.data());
+        m_boundOutputs = std::move(outputBindingData);
     }
-    m_bindingTable->BindOutputs(static_cast<uint32_t>(outputBindingData.bindingDescs.size()), outputBindingData.bindingDescs.data());
 
-    // DML may remove the device if invalid bindings are specified.
-    THROW_IF_FAILED(m_device->DML()->GetDeviceRemovedReason());
+    if (inputsChanged || outputsChanged)
+    {
+        m_bindingCacheStats.misses++;
+
+        // DML may remove the device if invalid bindings are specified.
+        THROW_IF_FAILED(m_device->DML()->GetDeviceRemovedReason());
+    }
+    else
+    {
+        m_bindingCacheStats.hits++;
+    }
+}
+
+std::vector<Dispatchable::ResourceAccess> DmlDispatchable::GetResourceAccesses(const Bindings& bindings) const
+{
+    std::vector<ResourceAccess> accesses;
+
+    auto AddAccesses = [&](const std::vector<Model::DmlDispatchableDesc::BindPoint>& bindPoints, bool write)
+    {
+        for (auto& bindPoint : bindPoints)
+        {
+            auto bindingIterator = bindings.find(bindPoint.name);
+            if (bindingIterator != bindings.end())
+            {
+                for (auto& source : bindingIterator->second)
+                {
+                    // Unbound optional tensors have no resource to access.
+                    if (source.resource)
+                    {
+                        accesses.push_back({ source.resource, source.resourceDesc ? source.resourceDesc->name : bindPoint.name, write });
+                    }
+                }
+            }
+        }
+    };
+
+    AddAccesses(m_bindPoints.inputs, false);
+    AddAccesses(m_bindPoints.outputs, true);
+
+    // The persistent resource is only written by the initializer, but the temporary resource is scratch memory
+    // written by every dispatch (and shared with other DML dispatchables through the queue's transient pool).
+    if (m_temporaryBuffer)
+    {
+        accesses.push_back({ m_temporaryBuffer.Get(), fmt::format("{} (temporary)", m_name), true, true });
+    }
+
+    return accesses;
 }
 
 void DmlDispatchable::Dispatch(const Model::DispatchCommand& args, uint32_t iteration, DeferredBindings& deferredBindings)
 {
     m_device->RecordDispatch(m_compiledOperator.Get(), m_bindingTable.Get());
-    m_device->ExecuteCommandListAndWait();
+    m_device->ExecuteCommandListAndAdvanceFrame();
+}
+
+void DmlDispatchable::RecordDispatch(const Model::DispatchCommand& args, const Device::RecordingTarget& target)
+{
+    m_device->RecordDispatch(target, m_compiledOperator.Get(), m_bindingTable.Get());
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include "DirectMLHelpers/DmlSerializedGraphDesc.h"
+#include "SharedCache.h"
 
 class DmlDispatchable : public Dispatchable
 {
@@ -17,9 +18,30 @@ public:
         const Model::DmlSerializedGraphDispatchableDesc& desc,
         IDxDispatchLogger* logger);
 
+    ~DmlDispatchable();
+
+    void Compile() final;
     void Initialize() final;
     void Bind(const Bindings& bindings, uint32_t iteration) final;
     void Dispatch(const Model::DispatchCommand& args, uint32_t iteration, DeferredBindings& deferredBindings) final;
+    bool SupportsRecordingTargets() const final { return true; }
+    void RecordDispatch(const Model::DispatchCommand& args, const Device::RecordingTarget& target) final;
+    std::optional<BindingCacheStats> GetBindingCacheStats() const final { return m_bindingCacheStats; }
+    std::vector<ResourceAccess> GetResourceAccesses(const Bindings& bindings) const final;
+
+    // Compiled operators are shared by all dispatchables (of any IDxDispatch instance in the process) that compile
+    // the same operator or graph on the same adapter with the same device settings.
+    static SharedCacheStats GetCompiledOperatorCacheStats();
+
+    // Buffer bindings for a group of bind points (e.g. all inputs). Each entry in bindingDescs points
+    // into bufferBindings, unless its type is DML_BINDING_TYPE_NONE. The bound buffers are referenced by
+    // resources, so a cached binding's buffer can't be released and another created at its address.
+    struct BindingData
+    {
+        std::vector<DML_BUFFER_BINDING> bufferBindings;
+        std::vector<DML_BINDING_DESC> bindingDescs;
+        std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> resources;
+    };
 
 private:
     std::string m_name;
@@ -28,13 +50,21 @@ private:
     Dispatchable::Bindings m_initBindings;
     bool m_isSerializedGraph = false;
     Microsoft::WRL::ComPtr<IDMLOperator> m_operator;
+    std::shared_ptr<const Microsoft::WRL::ComPtr<IDMLCompiledOperator>> m_sharedCompiledOperator;
     Microsoft::WRL::ComPtr<IDMLCompiledOperator> m_compiledOperator;
     Microsoft::WRL::ComPtr<ID3D12Resource> m_persistentBuffer;
     Microsoft::WRL::ComPtr<IDMLBindingTable> m_bindingTable;
-    Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_descriptorHeap;
+    Device::DescriptorRange m_descriptors;
+    Microsoft::WRL::ComPtr<ID3D12Resource> m_temporaryBuffer;
+    uint32_t m_temporaryBufferQueue = 0; // Queue whose transient pool m_temporaryBuffer belongs to.
+    BindingData m_boundInputs;
+    BindingData m_boundOutputs;
+    BindingCacheStats m_bindingCacheStats;
     Microsoft::WRL::ComPtr<IDxDispatchLogger> m_logger;
     Model::DmlDispatchableDesc::BindPoints m_bindPoints;
     std::unordered_map<std::string, Microsoft::WRL::ComPtr<ID3D12Resource>> m_resources;
+    std::vector<DmlSerializedGraphNode> m_constantNodes;
+    std::unordered_map<std::string, DML_TENSOR_DATA_TYPE> m_constantDataTypes;
 
     void BuildAndCompileGraph();
     void CreateResourceFromConstantNode(
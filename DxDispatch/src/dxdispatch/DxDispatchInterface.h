@@ -52,6 +52,38 @@ IDxDispatch : public IUnknown
 
  };
 
+// IDxDispatch2 is returned by QueryInterface on an IDxDispatch.
+MIDL_INTERFACE("6A1E0B4C-3F0D-4C8E-9B1A-52D7E4F8C3A9")
+IDxDispatch2 : public IDxDispatch
+{
+    // host access to the model's resources by name, e.g. to set inputs and read outputs between runs. Repeated runs
+    // reuse the same model, compiled dispatchables, and resources, which keep their contents across runs.
+    virtual HRESULT STDMETHODCALLTYPE GetResourceSize(
+                _In_ PCSTR resourceName,
+                _Out_ UINT64* sizeInBytes) = 0;
+
+    // copies host memory into a resource; sizeInBytes must match the resource size
+    virtual HRESULT STDMETHODCALLTYPE SetResourceData(
+                _In_ PCSTR resourceName,
+                _In_ const void* data,
+                UINT64 sizeInBytes) = 0;
+
+    // copies a resource into host memory; sizeInBytes must be at least the resource size
+    virtual HRESULT STDMETHODCALLTYPE GetResourceData(
+                _In_ PCSTR resourceName,
+                _Out_ void* data,
+                UINT64 sizeInBytes) = 0;
+
+    // replaces a resource with a buffer over host memory (zero copy), so the caller reads and writes its contents
+    // directly between runs. The memory must be allocated with VirtualAlloc (aligned to 64KB), at least the resource
+    // size, and stay allocated until the IDxDispatch is released. Fails if the adapter can't open existing heaps.
+    virtual HRESULT STDMETHODCALLTYPE WrapResourceHostMemory(
+                _In_ PCSTR resourceName,
+                _In_ void* data,
+                UINT64 sizeInBytes) = 0;
+
+ };
+
 STDAPI CreateDxDispatchFromString(
    _In_           PCSTR args,                         // DxDispatch commandArgs
    _In_           PCSTR jsonConfig,                   // DxDisPatch Json contents
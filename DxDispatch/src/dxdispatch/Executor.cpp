@@ -15,10 +15,28 @@
 #include "NpyReaderWriter.h"
 #include "CommandLineArgs.h"
 #include "Executor.h"
+#include "BarrierPlanner.h"
+#include "CommandGraph.h"
+#include "ThreadPool.h"
+#include "BackgroundFileWriter.h"
+#include "StreamingStats.h"
+#include "PhaseTiming.h"
+#include "ArrivalSchedule.h"
+#include "AliasingPlanner.h"
 #include <half.hpp>
 
 using Microsoft::WRL::ComPtr;
 
+// Seed of Poisson arrivals, so that open-loop runs issue the same requests every time.
+static constexpr uint64_t c_openLoopSeed = 1;
+
+// Open-loop requests sleep until this long before their arrival and then spin, since sleeps may overshoot.
+static constexpr std::chrono::milliseconds c_openLoopSpinTime(2);
+
+// Output file data that may be queued for the background writer before writeFile commands block. Writes larger than
+// this are still accepted once earlier writes finish.
+static constexpr uint64_t c_maxQueuedFileWriteBytes = 256 * 1024 * 1024;
+
 struct Timer
 {
     std::chrono::steady_clock::time_point start;
@@ -33,15 +51,7 @@ struct Timings
 {
     std::vector<double> rawSamples;
 
-    struct Stats
-    {
-        size_t count;
-        double sum;
-        double average;
-        double median;
-        double min;
-        double max;
-    };
+    using Stats = StreamingStats::Summary;
 
     struct SampleStats
     {
@@ -102,64 +112,194 @@ struct Timings
     }
 };
 
+static std::string GetCommandTraceName(const Model::CommandDesc& desc)
+{
+    if (std::holds_alternative<Model::DispatchCommand>(desc.command))
+    {
+        return fmt::format("{} '{}'", desc.type, std::get<Model::DispatchCommand>(desc.command).dispatchableName);
+    }
+    else if (std::holds_alternative<Model::PrintCommand>(desc.command))
+    {
+        return fmt::format("{} '{}'", desc.type, std::get<Model::PrintCommand>(desc.command).resourceName);
+    }
+    return fmt::format("{} '{}'", desc.type, std::get<Model::WriteFileCommand>(desc.command).resourceName);
+}
+
+static std::vector<BarrierPlanner::Access> GetPlannerAccesses(const std::vector<Dispatchable::ResourceAccess>& accesses)
+{
+    std::vector<BarrierPlanner::Access> plannerAccesses;
+    for (auto& access : accesses)
+    {
+        plannerAccesses.push_back({ access.resource, access.write });
+    }
+    return plannerAccesses;
+}
+
+// Accesses that order commands of a dispatch graph. Transient memory is left out: each queue has its own transient
+// pool, and commands on the same queue execute in order.
+static std::vector<BarrierPlanner::Access> GetGraphAccesses(const std::vector<Dispatchable::ResourceAccess>& accesses)
+{
+    std::vector<BarrierPlanner::Access> graphAccesses;
+    for (auto& access : accesses)
+    {
+        if (!access.transient)
+        {
+            graphAccesses.push_back({ access.resource, access.write });
+        }
+    }
+    return graphAccesses;
+}
+
+static std::vector<D3D12_RESOURCE_BARRIER> GetResourceBarriers(const BarrierPlanner::Barriers& plannedBarriers)
+{
+    std::vector<D3D12_RESOURCE_BARRIER> barriers;
+    for (auto resource : plannedBarriers.uav)
+    {
+        barriers.push_back(CD3DX12_RESOURCE_BARRIER::UAV(static_cast<ID3D12Resource*>(resource)));
+    }
+    for (auto& aliasing : plannedBarriers.aliasing)
+    {
+        barriers.push_back(CD3DX12_RESOURCE_BARRIER::Aliasing(static_cast<ID3D12Resource*>(aliasing.before), static_cast<ID3D12Resource*>(aliasing.after)));
+    }
+    return barriers;
+}
+
 Executor::Executor(Model& model, std::shared_ptr<Device> device, const CommandLineArgs& args, IDxDispatchLogger* logger) : 
-    m_model(model), m_device(device), m_commandLineArgs(args), m_logger(logger)
+    m_model(model), 
+    m_device(device), 
+    m_commandLineArgs(args), 
+    // Dispatchables log while they're compiled on multiple threads, so messages are forwarded one at a time.
+    m_logger(Microsoft::WRL::Make<DxDispatchPrefixedLogger>(logger, std::string(), std::make_shared<std::mutex>()))
 {
+    m_fileWriter = std::make_unique<BackgroundFileWriter>(c_maxQueuedFileWriteBytes);
+
+    // The model is parsed before the executor is created, but it's only counted while the executor uses it.
+    m_hostModelSizeInBytes = model.GetHostPayloadSizeInBytes();
+    m_device->GetMemoryTracker().Allocate(MemoryCategory::HostModel, m_hostModelSizeInBytes);
+
+    if (m_commandLineArgs.ReleaseResources())
+    {
+        PlanReleases();
+    }
+
+    // With --lazy_init, resources and dispatchables are instead created before the first command that uses them.
+    if (m_commandLineArgs.LazyInit())
+    {
+        return;
+    }
+
+    // Aliased resources are placed in a shared heap, and are initialized when their lifetimes begin.
+    if (m_commandLineArgs.AliasResources())
+    {
+        PlanAliasing();
+    }
+
     // Initialize buffer resources.
     {
+        TraceScope trace("init", "upload resources");
         PIXScopedEvent(m_device->GetCommandList(), PIX_COLOR(255, 255, 0), "Initialize resources");
         for (auto& desc : model.GetResourceDescs())
         {
-            // Only buffers are supported right now.
-            assert(std::holds_alternative<Model::BufferDesc>(desc.value));
-            auto& bufferDesc = std::get<Model::BufferDesc>(desc.value);
-            auto wName = std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(desc.name);
-            if (bufferDesc.sizeInBytes > 0)
-            {
-                m_resources[desc.name] = std::move(device->Upload(bufferDesc.sizeInBytes, bufferDesc.initialValues, wName));
-            }
-            else
+            if (m_aliasedResources.find(desc.name) == m_aliasedResources.end())
             {
-                m_resources[desc.name] = nullptr;
+                CreateResource(desc);
             }
         }
     }
-    device->ExecuteCommandListAndWait();
 
-    // Create dispatchables.
+    // The uploads are submitted without waiting, so they execute while the dispatchables are created and compiled.
+    device->ExecuteCommandList();
+
+    if (m_commandLineArgs.GetTimingVerbosity() >= TimingVerbosity::Extended)
+    {
+        auto& uploadStats = m_device->GetUploadStats();
+        m_logger->LogInfo(fmt::format("Uploads: {} resources, {} bytes in {} copy batches, {} byte staging buffer ({} created, {} forced submissions)",
+            uploadStats.uploadCount,
+            uploadStats.uploadedInBytes,
+            uploadStats.copyBatchCount,
+            uploadStats.stagingCapacityInBytes,
+            uploadStats.stagingBufferCount,
+            uploadStats.stagingFlushCount
+        ).c_str());
+    }
+
+    std::vector<const Model::DispatchableDesc*> dispatchableDescs;
     for (auto& desc : model.GetDispatchableDescs())
     {
+        dispatchableDescs.push_back(&desc);
+    }
+    CreateDispatchables(dispatchableDescs);
+
+    // Uploads may still be executing if no dispatchable waited for the GPU, and ONNX dispatchables execute on their
+    // own queue (which doesn't wait for the device's queues).
+    m_device->WaitForGpuWorkToComplete();
+}
+
+void Executor::CreateResource(const Model::ResourceDesc& desc)
+{
+    // Only buffers are supported right now.
+    assert(std::holds_alternative<Model::BufferDesc>(desc.value));
+    auto& bufferDesc = std::get<Model::BufferDesc>(desc.value);
+    auto wName = std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(desc.name);
+    if (bufferDesc.sizeInBytes > 0)
+    {
+        m_resources[desc.name] = std::move(m_device->Upload(bufferDesc.sizeInBytes, bufferDesc.initialValues, wName));
+    }
+    else
+    {
+        m_resources[desc.name] = nullptr;
+    }
+}
+
+bool Executor::CreateMissingResource(const std::string& resourceName)
+{
+    if (m_resources.find(resourceName) != m_resources.end())
+    {
+        return false;
+    }
+
+    TraceScope trace("upload", fmt::format("create '{}'", resourceName));
+    CreateResource(m_model.GetResource(resourceName));
+    return true;
+}
+
+void Executor::CreateDispatchables(gsl::span<const Model::DispatchableDesc* const> descs)
+{
+    // Create dispatchables.
+    for (auto desc : descs)
+    {
+        TraceScope trace("init", fmt::format("create '{}'", desc->name));
         try
         {
-            if (std::holds_alternative<Model::HlslDispatchableDesc>(desc.value))
+            if (std::holds_alternative<Model::HlslDispatchableDesc>(desc->value))
             {
 #ifdef DXCOMPILER_NONE
                 throw std::invalid_argument("HLSL dispatchables require DXCompiler");
 #else
-                m_dispatchables[desc.name] = std::make_unique<HlslDispatchable>(device, std::get<Model::HlslDispatchableDesc>(desc.value), args, m_logger.Get());
+                m_dispatchables[desc->name] = std::make_unique<HlslDispatchable>(m_device, std::get<Model::HlslDispatchableDesc>(desc->value), m_commandLineArgs, m_logger.Get());
 #endif
             }
-            else if (std::holds_alternative<Model::OnnxDispatchableDesc>(desc.value))
+            else if (std::holds_alternative<Model::OnnxDispatchableDesc>(desc->value))
             {
 #ifdef ONNXRUNTIME_NONE
                 throw std::invalid_argument("ONNX dispatchables require ONNX Runtime");
 #else
-                m_dispatchables[desc.name] = std::make_unique<OnnxDispatchable>(device, std::get<Model::OnnxDispatchableDesc>(desc.value), args, m_logger.Get());
+                m_dispatchables[desc->name] = std::make_unique<OnnxDispatchable>(m_device, std::get<Model::OnnxDispatchableDesc>(desc->value), m_commandLineArgs, m_logger.Get());
 #endif
             }
-            else if (std::holds_alternative<Model::DmlSerializedGraphDispatchableDesc>(desc.value)) 
+            else if (std::holds_alternative<Model::DmlSerializedGraphDispatchableDesc>(desc->value)) 
             {
-                auto& dmlSerializedGraphDispatchableDesc = std::get<Model::DmlSerializedGraphDispatchableDesc>(desc.value);
+                auto& dmlSerializedGraphDispatchableDesc = std::get<Model::DmlSerializedGraphDispatchableDesc>(desc->value);
 
-                m_dispatchables[desc.name] = std::make_unique<DmlDispatchable>(
-                    desc.name, 
-                    device, 
+                m_dispatchables[desc->name] = std::make_unique<DmlDispatchable>(
+                    desc->name, 
+                    m_device, 
                     dmlSerializedGraphDispatchableDesc, 
                     m_logger.Get());
             }
             else
             {
-                auto& dmlDispatchableDesc = std::get<Model::DmlDispatchableDesc>(desc.value);
+                auto& dmlDispatchableDesc = std::get<Model::DmlDispatchableDesc>(desc->value);
 
                 Dispatchable::Bindings initBindings;
                 try
@@ -172,103 +312,1377 @@ Executor::Executor(Model& model, std::shared_ptr<Device> device, const CommandLi
                     return;
                 }
 
-                m_dispatchables[desc.name] = std::make_unique<DmlDispatchable>(desc.name, device, dmlDispatchableDesc, initBindings, m_logger.Get());
+                m_dispatchables[desc->name] = std::make_unique<DmlDispatchable>(desc->name, m_device, dmlDispatchableDesc, initBindings, m_logger.Get());
             }
         }
         catch(const std::exception& e)
         {
-            throw std::invalid_argument(fmt::format("ERROR creating dispatchable '{}': {}", desc.name, e.what()));
+            throw std::invalid_argument(fmt::format("ERROR creating dispatchable '{}': {}", desc->name, e.what()));
+        }
+    }
+
+    // Compile dispatchables. Compiling doesn't record onto the device's command list, so dispatchables are compiled
+    // concurrently; their initialization is then recorded one at a time below.
+    {
+        std::vector<std::pair<const std::string, std::unique_ptr<Dispatchable>>*> dispatchables;
+        for (auto desc : descs)
+        {
+            dispatchables.push_back(&*m_dispatchables.find(desc->name));
+        }
+        std::vector<double> compileTimes(dispatchables.size());
+
+        uint32_t threadCount = m_commandLineArgs.CompileThreads();
+        if (threadCount == 0)
+        {
+            threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+        }
+        threadCount = std::max(std::min(threadCount, static_cast<uint32_t>(dispatchables.size())), 1u);
+
+        TraceRecorder* traceRecorder = TraceRecorder::GetActive();
+        auto CompileDispatchable = [&](size_t i)
+        {
+            auto& [name, dispatchable] = *dispatchables[i];
+            try
+            {
+                TraceRecorder::ActiveScope activeTraceRecorder(traceRecorder);
+                TraceScope trace("init", fmt::format("compile '{}'", name));
+                Timer timer;
+                dispatchable->Compile();
+                compileTimes[i] = timer.End().DurationInMilliseconds();
+            }
+            catch (const std::exception& e)
+            {
+                throw std::invalid_argument(fmt::format("ERROR while compiling '{}': {}", name, e.what()));
+            }
+        };
+
+        Timer timer;
+        ThreadPool(threadCount).ParallelFor(dispatchables.size(), CompileDispatchable);
+        timer.End();
+
+        if (m_commandLineArgs.GetTimingVerbosity() >= TimingVerbosity::Extended && !dispatchables.empty())
+        {
+            double compileTimeSum = 0;
+            for (size_t i = 0; i < dispatchables.size(); i++)
+            {
+                m_logger->LogInfo(fmt::format("Compile '{}': {:.4f} ms", dispatchables[i]->first, compileTimes[i]).c_str());
+                compileTimeSum += compileTimes[i];
+            }
+
+            // The saving is the time the compiles would take one after another, minus the time they actually took.
+            m_logger->LogInfo(fmt::format(
+                "Compile dispatchables: {:.4f} ms on {} threads ({:.4f} ms compiling, {:.4f} ms saved)",
+                timer.DurationInMilliseconds(),
+                threadCount,
+                compileTimeSum,
+                std::max(compileTimeSum - timer.DurationInMilliseconds(), 0.0)).c_str());
+        }
+    }
+
+    // Initialize dispatchables.
+    {
+        Timer timer;
+
+        PIXBeginEvent(m_device->GetCommandQueue(), PIX_COLOR(255, 255, 0), "Initialize dispatchables");
+        for (auto desc : descs)
+        {
+            auto& dispatchable = *m_dispatchables.find(desc->name);
+            try
+            {
+                TraceScope trace("init", fmt::format("initialize '{}'", dispatchable.first));
+                timer.Start();
+                PIXBeginEvent(PIX_COLOR(128,255,0), L"Init");
+                dispatchable.second->Initialize();
+                PIXEndEvent();
+                timer.End();
+
+                if (m_commandLineArgs.GetTimingVerbosity() >= TimingVerbosity::Extended)
+                {
+                    m_logger->LogInfo(fmt::format("Initialize '{}': {:.4f} ms", dispatchable.first, timer.DurationInMilliseconds()).c_str());
+                }
+            }
+            catch (const std::exception& e)
+            {
+                throw std::invalid_argument(fmt::format("ERROR while initializing '{}': {}", dispatchable.first, e.what()));
+            }
+        }
+        PIXEndEvent(m_device->GetCommandQueue());
+
+        // The caches are process-wide, so their totals include dispatchables of other IDxDispatch instances.
+        if (m_commandLineArgs.GetTimingVerbosity() >= TimingVerbosity::Extended)
+        {
+            auto operatorStats = DmlDispatchable::GetCompiledOperatorCacheStats();
+            auto pipelineStats = HlslDispatchable::GetPipelineCacheStats();
+            m_logger->LogInfo(fmt::format(
+                "Shared compile cache: DML operators {} hits / {} misses, HLSL pipelines {} hits / {} misses",
+                operatorStats.hits,
+                operatorStats.misses,
+                pipelineStats.hits,
+                pipelineStats.misses).c_str());
+        }
+    }
+}
+
+void Executor::CreateMissingObjects(uint32_t begin, uint32_t end)
+{
+    auto commandDescs = m_model.GetCommands();
+    std::vector<const Model::DispatchableDesc*> dispatchableDescs;
+    bool createdResources = false;
+
+    auto CreateMissingBindingResources = [&](const Model::Bindings& bindings)
+    {
+        for (auto& binding : bindings)
+        {
+            for (auto& source : binding.second)
+            {
+                createdResources |= CreateMissingResource(source.name);
+                if (source.counterName)
+                {
+                    createdResources |= CreateMissingResource(*source.counterName);
+                }
+            }
+        }
+    };
+
+    for (uint32_t i = begin; i < end; i++)
+    {
+        auto& command = commandDescs[i].command;
+        if (auto dispatchCommand = std::get_if<Model::DispatchCommand>(&command))
+        {
+            CreateMissingBindingResources(dispatchCommand->bindings);
+
+            auto& desc = m_model.GetDispatchable(dispatchCommand->dispatchableName);
+            if (m_dispatchables.find(desc.name) == m_dispatchables.end() &&
+                std::find(dispatchableDescs.begin(), dispatchableDescs.end(), &desc) == dispatchableDescs.end())
+            {
+                // Initializers of DML operators are bound when the dispatchable is created.
+                if (auto dmlDesc = std::get_if<Model::DmlDispatchableDesc>(&desc.value))
+                {
+                    CreateMissingBindingResources(dmlDesc->initBindings);
+                }
+                dispatchableDescs.push_back(&desc);
+            }
+        }
+        else
+        {
+            createdResources |= CreateMissingResource(std::holds_alternative<Model::PrintCommand>(command) ?
+                std::get<Model::PrintCommand>(command).resourceName :
+                std::get<Model::WriteFileCommand>(command).resourceName);
+        }
+    }
+
+    if (!createdResources && dispatchableDescs.empty())
+    {
+        return;
+    }
+
+    // Same order as the constructor: the uploads execute while the dispatchables are compiled. Commands don't start
+    // until everything they use is ready, so their timings don't include the creation.
+    m_device->ExecuteCommandList();
+    CreateDispatchables(dispatchableDescs);
+    m_device->WaitForGpuWorkToComplete();
+}
+
+void Executor::PrepareCommands(uint32_t begin, uint32_t end)
+{
+    if (m_commandLineArgs.LazyInit())
+    {
+        CreateMissingObjects(begin, end);
+    }
+    BeginAliasedLifetimes(begin, end);
+}
+
+void Executor::PlanAliasing()
+{
+    auto commandDescs = m_model.GetCommands();
+
+    // Commands of a dispatch batch (see Run) are interleaved, so every run of consecutive dispatch commands that may
+    // be batched is a single step of the lifetimes. Batches are found when the commands run, since that requires
+    // the dispatchables, so this may merge more commands than necessary.
+    bool batched = m_commandLineArgs.RecordThreads() > 0 || m_commandLineArgs.ReplayDispatches();
+    std::vector<uint32_t> steps(commandDescs.size());
+    for (uint32_t i = 0, step = 0; i < commandDescs.size(); i++)
+    {
+        bool continuesBatch = batched && i > 0 &&
+            std::holds_alternative<Model::DispatchCommand>(commandDescs[i - 1].command) &&
+            std::holds_alternative<Model::DispatchCommand>(commandDescs[i].command);
+        step += (i > 0 && !continuesBatch) ? 1 : 0;
+        steps[i] = step;
+    }
+
+    struct Lifetime
+    {
+        uint32_t firstCommand;
+        uint32_t lastCommand;
+    };
+    std::unordered_map<std::string, Lifetime> lifetimes;
+    auto AddUse = [&](const std::string& resourceName, uint32_t commandIndex)
+    {
+        auto lifetime = lifetimes.try_emplace(resourceName, Lifetime{ commandIndex, commandIndex });
+        lifetime.first->second.lastCommand = commandIndex;
+    };
+
+    std::unordered_set<std::string> excludedResources;
+    for (uint32_t i = 0; i < commandDescs.size(); i++)
+    {
+        auto& command = commandDescs[i].command;
+        if (auto dispatchCommand = std::get_if<Model::DispatchCommand>(&command))
+        {
+            for (auto& binding : dispatchCommand->bindings)
+            {
+                for (auto& source : binding.second)
+                {
+                    AddUse(source.name, i);
+                    if (source.counterName)
+                    {
+                        AddUse(*source.counterName, i);
+                    }
+                }
+            }
+
+            // Initializers of DML operators read their bindings when the dispatchable is initialized.
+            auto& desc = m_model.GetDispatchable(dispatchCommand->dispatchableName);
+            if (auto dmlDesc = std::get_if<Model::DmlDispatchableDesc>(&desc.value))
+            {
+                for (auto& binding : dmlDesc->initBindings)
+                {
+                    for (auto& source : binding.second)
+                    {
+                        excludedResources.insert(source.name);
+                    }
+                }
+            }
+        }
+        else
+        {
+            AddUse(std::holds_alternative<Model::PrintCommand>(command) ?
+                std::get<Model::PrintCommand>(command).resourceName :
+                std::get<Model::WriteFileCommand>(command).resourceName, i);
+        }
+    }
+
+    AliasingPlanner planner(D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+    std::vector<const Model::ResourceDesc*> aliasedDescs;
+    uint64_t otherBuffersSizeInBytes = 0;
+    auto AlignedSize = [](uint64_t size)
+    {
+        return (size + D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1) / D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT * D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+    };
+    for (auto& desc : m_model.GetResourceDescs())
+    {
+        auto& bufferDesc = std::get<Model::BufferDesc>(desc.value);
+        auto lifetime = lifetimes.find(desc.name);
+        if (bufferDesc.sizeInBytes == 0 || bufferDesc.useDeferredBinding)
+        {
+            continue;
+        }
+
+        if (lifetime == lifetimes.end() || excludedResources.find(desc.name) != excludedResources.end())
+        {
+            otherBuffersSizeInBytes += AlignedSize(bufferDesc.sizeInBytes);
+            continue;
+        }
+
+        planner.AddBuffer(bufferDesc.sizeInBytes, steps[lifetime->second.firstCommand], steps[lifetime->second.lastCommand]);
+        aliasedDescs.push_back(&desc);
+    }
+
+    auto plan = planner.CreatePlan();
+    if (plan.heapSizeInBytes > 0)
+    {
+        m_aliasingHeap = m_device->CreatePreferredDeviceMemoryHeap(plan.heapSizeInBytes);
+        m_device->TrackMemory(m_aliasingHeap.Get(), MemoryCategory::ModelResources);
+    }
+
+    m_aliasingBeginsBeforeCommand.resize(commandDescs.size());
+    for (size_t i = 0; i < aliasedDescs.size(); i++)
+    {
+        auto& desc = *aliasedDescs[i];
+        auto wName = std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(desc.name);
+        auto resource = m_device->CreatePlacedBuffer(
+            m_aliasingHeap.Get(),
+            plan.offsets[i],
+            std::get<Model::BufferDesc>(desc.value).sizeInBytes,
+            wName);
+
+        m_resources[desc.name] = resource;
+        m_aliasedResources[desc.name] = { resource, &desc, false };
+        m_aliasingBeginsBeforeCommand[lifetimes[desc.name].firstCommand].push_back(desc.name);
+    }
+
+    m_logger->LogInfo(fmt::format(
+        "Resource aliasing: {} of {} buffers share a {} byte heap ({} bytes without aliasing, at most {} bytes live at once). Peak buffer memory: {} bytes -> {} bytes",
+        aliasedDescs.size(),
+        m_model.GetResourceDescs().size(),
+        plan.heapSizeInBytes,
+        plan.unaliasedSizeInBytes,
+        plan.peakLiveSizeInBytes,
+        otherBuffersSizeInBytes + plan.unaliasedSizeInBytes,
+        otherBuffersSizeInBytes + plan.heapSizeInBytes).c_str());
+}
+
+void Executor::BeginAliasedLifetimes(uint32_t begin, uint32_t end)
+{
+    if (m_aliasingBeginsBeforeCommand.empty())
+    {
+        return;
+    }
+
+    std::vector<AliasedResource*> resources;
+    for (uint32_t i = begin; i < end; i++)
+    {
+        for (auto& resourceName : m_aliasingBeginsBeforeCommand[i])
+        {
+            auto& aliasedResource = m_aliasedResources[resourceName];
+            if (!aliasedResource.hostAccessed)
+            {
+                resources.push_back(&aliasedResource);
+            }
+        }
+    }
+
+    if (resources.empty())
+    {
+        return;
+    }
+
+    // The memory may still be in use by the GPU for resources whose lifetimes ended, and uploads to CPU-visible
+    // buffers are written directly. Commands typically wait for the GPU anyway, except within batches.
+    TraceScope trace("upload", "begin aliased lifetimes");
+    m_device->WaitForGpuWorkToComplete();
+
+    std::vector<D3D12_RESOURCE_BARRIER> barriers;
+    for (auto resource : resources)
+    {
+        barriers.push_back(CD3DX12_RESOURCE_BARRIER::Aliasing(nullptr, resource->resource.Get()));
+    }
+    m_device->GetCommandList()->ResourceBarrier(static_cast<uint32_t>(barriers.size()), barriers.data());
+    m_device->ExecuteCommandList();
+
+    // Resources start each run with their initial values, so they're uploaded again whenever their lifetime begins.
+    for (auto resource : resources)
+    {
+        auto& bufferDesc = std::get<Model::BufferDesc>(resource->desc->value);
+        if (!bufferDesc.initialValues.empty())
+        {
+            m_device->UploadTo(resource->resource.Get(), bufferDesc.initialValues);
+        }
+    }
+    m_device->ExecuteCommandList();
+}
+
+void Executor::PlanReleases()
+{
+    auto commandDescs = m_model.GetCommands();
+
+    std::unordered_map<std::string, uint32_t> lastDispatchableUses;
+    for (uint32_t i = 0; i < commandDescs.size(); i++)
+    {
+        if (auto dispatchCommand = std::get_if<Model::DispatchCommand>(&commandDescs[i].command))
+        {
+            lastDispatchableUses[dispatchCommand->dispatchableName] = i;
+        }
+    }
+
+    // Dispatchables hold on to the resources bound to them (in binding tables, descriptors, or ONNX bindings), so a
+    // resource is in use until the last command of every dispatchable it's bound to.
+    std::unordered_map<std::string, uint32_t> lastResourceUses;
+    auto AddResourceUse = [&](const std::string& resourceName, uint32_t commandIndex)
+    {
+        auto& lastUse = lastResourceUses[resourceName];
+        lastUse = std::max(lastUse, commandIndex);
+    };
+
+    auto AddBindingUses = [&](const Model::Bindings& bindings, uint32_t commandIndex)
+    {
+        for (auto& binding : bindings)
+        {
+            for (auto& source : binding.second)
+            {
+                AddResourceUse(source.name, commandIndex);
+                if (source.counterName)
+                {
+                    AddResourceUse(*source.counterName, commandIndex);
+                }
+            }
+        }
+    };
+
+    for (uint32_t i = 0; i < commandDescs.size(); i++)
+    {
+        auto& command = commandDescs[i].command;
+        if (auto dispatchCommand = std::get_if<Model::DispatchCommand>(&command))
+        {
+            uint32_t lastDispatchableUse = lastDispatchableUses[dispatchCommand->dispatchableName];
+            AddBindingUses(dispatchCommand->bindings, lastDispatchableUse);
+
+            auto& desc = m_model.GetDispatchable(dispatchCommand->dispatchableName);
+            if (auto dmlDesc = std::get_if<Model::DmlDispatchableDesc>(&desc.value))
+            {
+                AddBindingUses(dmlDesc->initBindings, lastDispatchableUse);
+            }
+        }
+        else
+        {
+            AddResourceUse(std::holds_alternative<Model::PrintCommand>(command) ?
+                std::get<Model::PrintCommand>(command).resourceName :
+                std::get<Model::WriteFileCommand>(command).resourceName, i);
+        }
+    }
+
+    m_releasesAfterCommand.resize(commandDescs.size());
+    for (auto& [resourceName, lastUse] : lastResourceUses)
+    {
+        m_releasesAfterCommand[lastUse].resources.push_back(resourceName);
+    }
+    for (auto& [dispatchableName, lastUse] : lastDispatchableUses)
+    {
+        m_releasesAfterCommand[lastUse].dispatchables.push_back(dispatchableName);
+    }
+}
+
+void Executor::ReleaseUnusedObjects(uint32_t begin, uint32_t end)
+{
+    if (m_releasesAfterCommand.empty())
+    {
+        return;
+    }
+
+    std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> resources;
+    std::vector<std::unique_ptr<Dispatchable>> dispatchables;
+    uint64_t releasedBytes = 0;
+    for (uint32_t i = begin; i < end; i++)
+    {
+        for (auto& resourceName : m_releasesAfterCommand[i].resources)
+        {
+            auto resource = m_resources.find(resourceName);
+            if (resource != m_resources.end() && m_hostAccessedResources.find(resourceName) == m_hostAccessedResources.end())
+            {
+                if (resource->second)
+                {
+                    releasedBytes += resource->second->GetDesc().Width;
+                    resources.push_back(std::move(resource->second));
+                }
+                m_resources.erase(resource);
+            }
+        }
+
+        for (auto& dispatchableName : m_releasesAfterCommand[i].dispatchables)
+        {
+            auto dispatchable = m_dispatchables.find(dispatchableName);
+            if (dispatchable != m_dispatchables.end())
+            {
+                dispatchables.push_back(std::move(dispatchable->second));
+                m_dispatchables.erase(dispatchable);
+            }
+        }
+    }
+
+    if (resources.empty() && dispatchables.empty())
+    {
+        return;
+    }
+
+    // The GPU may still be executing the last commands that use them. This only adds a sync point after the last
+    // use of each object, which is typically at the end of a stage of the model.
+    TraceScope trace("init", "release unused objects");
+    m_device->WaitForGpuWorkToComplete();
+    size_t resourceCount = resources.size();
+    size_t dispatchableCount = dispatchables.size();
+    resources.clear();
+    dispatchables.clear();
+
+    if (m_commandLineArgs.GetTimingVerbosity() >= TimingVerbosity::Extended)
+    {
+        m_logger->LogInfo(fmt::format("Released {} resources ({} bytes) and {} dispatchables after command {}",
+            resourceCount,
+            releasedBytes,
+            dispatchableCount,
+            end - 1).c_str());
+    }
+}
+
+Executor::~Executor()
+{
+    // Commands run one at a time (through IDxDispatch) may leave writes queued.
+    try
+    {
+        FlushFileWrites();
+    }
+    catch (...)
+    {
+    }
+
+    m_device->GetMemoryTracker().Free(MemoryCategory::HostModel, m_hostModelSizeInBytes);
+}
+
+uint32_t Executor::GetCommandCount()
+{
+    return static_cast<uint32_t>(m_model.GetCommands().size());
+}
+
+void Executor::RunCommand(UINT32 id)
+{
+    auto commandDescs = m_model.GetCommands();
+    auto maxCommands = GetCommandCount();
+    if (id == m_nextId)
+    {
+        if (m_commandLineArgs.PrintCommands())
+        {
+            m_logger->LogCommandStarted((UINT32)id, commandDescs[id].parameters.c_str());
+        }
+
+        try
+        {
+            PrepareCommands(id, id + 1);
+
+            TraceScope trace("command", GetCommandTraceName(commandDescs[id]));
+            std::visit(*this, commandDescs[id].command);
+            ReleaseUnusedObjects(id, id + 1);
+
+            // Commands may also be run one at a time, so writes are reported after the last command in the model.
+            if (id + 1 == maxCommands)
+            {
+                FlushFileWrites();
+            }
+
+            if (m_commandLineArgs.PrintCommands())
+            {
+                m_logger->LogCommandCompleted((UINT32)id, S_OK, "");
+            }
+        }
+        catch (std::exception& ex)
+        {
+            if (m_commandLineArgs.PrintCommands())
+            {
+#ifdef WIN32
+            HRESULT hr = wil::ResultFromCaughtException();
+#else
+            HRESULT hr = E_FAIL;
+#endif
+                m_logger->LogCommandCompleted((UINT32)id, hr, ex.what());
+            }
+            throw;
+        }
+    }
+    else
+    {
+        auto msg = fmt::format("Invalid Id={} ExpectedId={}", id, m_nextId);
+        m_logger->LogError(msg.c_str());
+        throw std::invalid_argument(msg);
+    }
+    if (++m_nextId >= maxCommands)
+    {
+        m_nextId = 0;
+    }
+    return;
+}
+
+
+void Executor::Run()
+{
+    // A run always starts from the first command, even if commands were run individually before it.
+    m_nextId = 0;
+
+    for (uint32_t i = 0, c = GetCommandCount(); i < c;)
+    {
+        bool multipleQueues = m_device->GetQueueCount() > 1;
+        bool replay = m_commandLineArgs.ReplayDispatches();
+        uint32_t sequenceEnd = multipleQueues || replay || m_commandLineArgs.RecordThreads() > 0 ? FindDispatchSequenceEnd(i) : i;
+
+        // Replaying pays off even for a single command, since it skips binding and recording every iteration.
+        if (sequenceEnd - i > 1 || (replay && sequenceEnd > i))
+        {
+            PrepareCommands(i, sequenceEnd);
+
+            if (multipleQueues)
+            {
+                RunDispatchGraph(i, sequenceEnd);
+            }
+            else
+            {
+                RunDispatchBatch(i, sequenceEnd);
+            }
+            ReleaseUnusedObjects(i, sequenceEnd);
+            i = sequenceEnd;
+        }
+        else if (uint32_t outputEnd = FindOutputSequenceEnd(i); outputEnd - i > 1)
+        {
+            PrepareCommands(i, outputEnd);
+
+            RunOutputBatch(i, outputEnd);
+            ReleaseUnusedObjects(i, outputEnd);
+            i = outputEnd;
+        }
+        else
+        {
+            RunCommand(i);
+            i++;
+        }
+    }
+
+    FlushFileWrites();
+
+    if (m_commandLineArgs.GetTimingVerbosity() >= TimingVerbosity::Extended)
+    {
+        LogMemoryUsage();
+    }
+}
+
+void Executor::LogMemoryUsage()
+{
+    auto& memoryTracker = m_device->GetMemoryTracker();
+    auto total = memoryTracker.GetTotalUsage();
+    m_logger->LogInfo(fmt::format("Memory: {} bytes peak, {} bytes live", total.peakInBytes, total.liveInBytes).c_str());
+    for (size_t i = 0; i < static_cast<size_t>(MemoryCategory::Count); i++)
+    {
+        auto category = static_cast<MemoryCategory>(i);
+        auto usage = memoryTracker.GetUsage(category);
+        if (usage.allocationCount > 0)
+        {
+            m_logger->LogInfo(fmt::format("  {}: {} bytes peak, {} bytes live ({} allocations)",
+                GetMemoryCategoryName(category),
+                usage.peakInBytes,
+                usage.liveInBytes,
+                usage.allocationCount).c_str());
+        }
+    }
+}
+
+void Executor::FlushFileWrites()
+{
+    TraceScope trace("readback", "flush file writes");
+    auto results = m_fileWriter->Flush();
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        auto& resourceName = m_queuedFileWriteResources[i];
+        auto targetPath = results[i].path.string();
+        if (results[i].error.empty())
+        {
+            m_logger->LogInfo(fmt::format("Resource '{}' written to '{}'", resourceName, targetPath).c_str());
+        }
+        else
+        {
+            m_logger->LogError(fmt::format("Failed to write resource to file '{}': {}", targetPath, results[i].error).c_str());
+        }
+    }
+    m_queuedFileWriteResources.clear();
+
+    if (!results.empty() && m_commandLineArgs.GetTimingVerbosity() >= TimingVerbosity::Extended)
+    {
+        m_logger->LogInfo(fmt::format("File writes: {} bytes written, {:.4f} ms blocked on I/O",
+            m_fileWriter->WrittenBytes(),
+            m_fileWriter->BlockedMilliseconds()).c_str());
+    }
+}
+
+uint32_t Executor::FindOutputSequenceEnd(uint32_t begin)
+{
+    auto commandDescs = m_model.GetCommands();
+
+    uint32_t end = begin;
+    while (end < commandDescs.size() && !std::holds_alternative<Model::DispatchCommand>(commandDescs[end].command))
+    {
+        end++;
+    }
+
+    return end;
+}
+
+void Executor::RunOutputBatch(uint32_t begin, uint32_t end)
+{
+    TraceScope trace("command", fmt::format("output batch ({} commands)", end - begin));
+    auto commandDescs = m_model.GetCommands();
+
+    // Every command in the sequence reads back a resource; resources named more than once are only read back once.
+    std::vector<std::string> resourceNames;
+    std::vector<ID3D12Resource*> resources;
+    for (uint32_t i = begin; i < end; i++)
+    {
+        auto& command = commandDescs[i].command;
+        auto& resourceName = std::holds_alternative<Model::PrintCommand>(command) ? 
+            std::get<Model::PrintCommand>(command).resourceName : 
+            std::get<Model::WriteFileCommand>(command).resourceName;
+
+        auto resource = FindOutputResource(resourceName);
+        if (resource && std::find(resourceNames.begin(), resourceNames.end(), resourceName) == resourceNames.end())
+        {
+            resourceNames.push_back(resourceName);
+            resources.push_back(resource);
+        }
+    }
+
+    auto readbacks = m_device->DownloadBatch(resources);
+    for (size_t i = 0; i < resourceNames.size(); i++)
+    {
+        m_pendingReadbacks[resourceNames[i]] = readbacks[i].share();
+    }
+
+    try
+    {
+        for (uint32_t i = begin; i < end; i++)
+        {
+            RunCommand(i);
+        }
+    }
+    catch (...)
+    {
+        m_pendingReadbacks.clear();
+        throw;
+    }
+    m_pendingReadbacks.clear();
+}
+
+ID3D12Resource* Executor::FindOutputResource(const std::string& resourceName)
+{
+    auto& bufferDesc = std::get<Model::BufferDesc>(m_model.GetResource(resourceName).value);
+    if (bufferDesc.useDeferredBinding)
+    {
+        auto deferredBinding = m_deferredBinding.find(resourceName);
+        return deferredBinding != m_deferredBinding.end() ? deferredBinding->second.resource.Get() : nullptr;
+    }
+
+    auto resource = m_resources.find(resourceName);
+    return resource != m_resources.end() ? resource->second.Get() : nullptr;
+}
+
+ID3D12Resource* Executor::FindHostAccessibleResource(const std::string& resourceName)
+{
+    if (m_resources.find(resourceName) == m_resources.end())
+    {
+        auto resourceDescs = m_model.GetResourceDescs();
+        bool exists = std::any_of(resourceDescs.begin(), resourceDescs.end(), [&](auto& desc) { return desc.name == resourceName; });
+        if (!exists || !m_commandLineArgs.LazyInit())
+        {
+            throw std::invalid_argument(fmt::format("Resource '{}' does not exist", resourceName));
+        }
+
+        CreateResource(m_model.GetResource(resourceName));
+        m_device->ExecuteCommandList();
+        m_device->WaitForGpuWorkToComplete();
+    }
+
+    // The caller expects the contents of the resource to persist between runs, so it's never released.
+    m_hostAccessedResources.insert(resourceName);
+
+    // ... or aliased. The placed buffer is kept alive, since dispatchables may still reference it.
+    auto aliasedResource = m_aliasedResources.find(resourceName);
+    if (aliasedResource != m_aliasedResources.end() && !aliasedResource->second.hostAccessed)
+    {
+        aliasedResource->second.hostAccessed = true;
+        m_device->WaitForGpuWorkToComplete();
+        CreateResource(*aliasedResource->second.desc);
+        m_device->ExecuteCommandList();
+        m_device->WaitForGpuWorkToComplete();
+    }
+
+    auto resource = FindOutputResource(resourceName);
+    if (!resource)
+    {
+        throw std::invalid_argument(fmt::format("Resource '{}' has no buffer until it's bound by a dispatch (deferred binding)", resourceName));
+    }
+    return resource;
+}
+
+uint64_t Executor::GetResourceSize(const std::string& resourceName)
+{
+    return FindHostAccessibleResource(resourceName)->GetDesc().Width;
+}
+
+void Executor::SetResourceData(const std::string& resourceName, gsl::span<const std::byte> data)
+{
+    auto resource = FindHostAccessibleResource(resourceName);
+    if (data.size() != resource->GetDesc().Width)
+    {
+        throw std::invalid_argument(fmt::format("Resource '{}' is {} bytes, but {} bytes were given", resourceName, resource->GetDesc().Width, data.size()));
+    }
+
+    TraceScope trace("upload", fmt::format("set '{}'", resourceName));
+    m_device->UploadTo(resource, data);
+}
+
+std::vector<std::byte> Executor::GetResourceData(const std::string& resourceName)
+{
+    return m_device->Download(FindHostAccessibleResource(resourceName));
+}
+
+void Executor::WrapResourceHostMemory(const std::string& resourceName, void* data, uint64_t sizeInBytes)
+{
+    auto resource = FindHostAccessibleResource(resourceName);
+    if (std::get<Model::BufferDesc>(m_model.GetResource(resourceName).value).useDeferredBinding)
+    {
+        throw std::invalid_argument(fmt::format("Resource '{}' uses deferred binding, so its buffer is owned by the dispatchable", resourceName));
+    }
+
+    if (sizeInBytes < resource->GetDesc().Width)
+    {
+        throw std::invalid_argument(fmt::format("Resource '{}' is {} bytes, but only {} bytes of host memory were given", resourceName, resource->GetDesc().Width, sizeInBytes));
+    }
+
+    // Dispatchables rebind their resources for every dispatch command, so they pick up the new buffer. Binding caches
+    // hold references to the buffers they bound, so the old buffer is only released once they've rebound.
+    auto wName = std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(resourceName);
+    m_resources[resourceName] = m_device->WrapHostMemory(data, resource->GetDesc().Width, wName);
+}
+
+std::vector<std::byte> Executor::Download(const std::string& resourceName, ID3D12Resource* resource)
+{
+    auto readback = m_pendingReadbacks.find(resourceName);
+    if (readback != m_pendingReadbacks.end())
+    {
+        return readback->second.get();
+    }
+
+    return m_device->Download(resource);
+}
+
+uint32_t Executor::FindDispatchSequenceEnd(uint32_t begin)
+{
+    auto commandDescs = m_model.GetCommands();
+    std::unordered_set<std::string> dispatchableNames;
+
+    uint32_t end = begin;
+    for (; end < commandDescs.size(); end++)
+    {
+        auto dispatchCommand = std::get_if<Model::DispatchCommand>(&commandDescs[end].command);
+        if (!dispatchCommand)
+        {
+            break;
+        }
+
+        if (m_commandLineArgs.LazyInit())
+        {
+            CreateMissingObjects(end, end + 1);
+        }
+
+        // ONNX dispatchables execute on their own queue and can't be recorded into other command lists. A dispatchable
+        // used twice would need two sets of bindings in flight at once, which isn't supported.
+        if (!m_dispatchables[dispatchCommand->dispatchableName]->SupportsRecordingTargets() ||
+            !dispatchableNames.insert(dispatchCommand->dispatchableName).second)
+        {
+            break;
+        }
+    }
+
+    return end;
+}
+
+void Executor::RunDispatchGraph(uint32_t begin, uint32_t end)
+{
+    TraceScope trace("command", fmt::format("dispatch graph ({} commands)", end - begin));
+    auto commandDescs = m_model.GetCommands();
+    if (begin != m_nextId)
+    {
+        auto msg = fmt::format("Invalid Id={} ExpectedId={}", begin, m_nextId);
+        m_logger->LogError(msg.c_str());
+        throw std::invalid_argument(msg);
+    }
+
+    struct GraphNode
+    {
+        const Model::DispatchCommand* command;
+        Dispatchable* dispatchable;
+        Dispatchable::Bindings bindings;
+        std::vector<D3D12_RESOURCE_BARRIER> repeatBarriers;
+    };
+
+    std::vector<GraphNode> nodes;
+    std::vector<std::vector<BarrierPlanner::Access>> nodeAccesses;
+    CommandGraph graph;
+
+    if (m_commandLineArgs.PrintCommands())
+    {
+        for (uint32_t id = begin; id < end; id++)
+        {
+            m_logger->LogCommandStarted(id, commandDescs[id].parameters.c_str());
+        }
+    }
+
+    try
+    {
+        m_deferredBinding.clear();
+
+        // The first Bind() creates any internal resources (e.g. DML temporary buffers), which are part of 
+        // the resources that each dispatch accesses. It also allocates descriptors, so it happens on the primary
+        // queue before the commands fan out to other queues; binds in the loop below reuse them.
+        m_device->SetActiveQueue(0);
+        for (uint32_t id = begin; id < end; id++)
+        {
+            auto& command = std::get<Model::DispatchCommand>(commandDescs[id].command);
+            GraphNode node = { &command, m_dispatchables[command.dispatchableName].get(), ResolveBindings(command.bindings) };
+            node.dispatchable->Bind(node.bindings, 0);
+            nodeAccesses.push_back(GetGraphAccesses(node.dispatchable->GetResourceAccesses(node.bindings)));
+            graph.AddNode(nodeAccesses.back());
+
+            if (m_commandLineArgs.GetAutoBarriersAfterDispatch())
+            {
+                node.repeatBarriers = PlanRepeatDispatchBarriers(command.dispatchableName, *node.dispatchable, node.bindings);
+            }
+            nodes.push_back(std::move(node));
+        }
+    }
+    catch (const std::exception& e)
+    {
+        m_logger->LogError(fmt::format("ERROR while binding resources: {}\n", e.what()).c_str());
+        throw;
+    }
+
+    // Costs are unknown until the commands execute, so every command is assumed to take the same time.
+    auto schedule = graph.ScheduleOnQueues(m_device->GetQueueCount());
+
+    if (m_commandLineArgs.PrintCommands())
+    {
+        m_logger->LogInfo(fmt::format("Dispatch graph: {} commands on {} queues, {} cross-queue waits",
+            nodes.size(), schedule.queueCount, schedule.waitCount).c_str());
+
+        for (size_t i = 0; i < nodes.size(); i++)
+        {
+            std::string waits;
+            for (auto& wait : schedule.nodes[i].waits)
+            {
+                waits += fmt::format(", waits for '{}' (queue {})", nodes[wait.node].command->dispatchableName, wait.queue);
+            }
+            m_logger->LogInfo(fmt::format("  '{}': queue {}{}", nodes[i].command->dispatchableName, schedule.nodes[i].queue, waits).c_str());
+        }
+    }
+
+    // Iterations aren't separated by a CPU wait, so a command must also wait for the commands of the previous
+    // iteration that it has a hazard with on other queues. These are its dependencies on the first iteration in a
+    // graph of two iterations.
+    std::vector<std::vector<size_t>> previousIterationDependencies(nodes.size());
+    {
+        CommandGraph unrolledGraph;
+        for (auto& accesses : nodeAccesses)
+        {
+            unrolledGraph.AddNode(accesses);
+        }
+        for (size_t i = 0; i < nodes.size(); i++)
+        {
+            size_t unrolledNode = unrolledGraph.AddNode(nodeAccesses[i]);
+            for (auto dependency : unrolledGraph.Dependencies(unrolledNode))
+            {
+                if (dependency < nodes.size() && schedule.nodes[dependency].queue != schedule.nodes[i].queue)
+                {
+                    previousIterationDependencies[i].push_back(dependency);
+                }
+            }
+        }
+    }
+
+    Timings cpuTimings;
+    uint32_t iterationsCompleted = 0;
+    std::vector<uint64_t> fenceValues(nodes.size());
+    std::vector<uint64_t> previousFenceValues(nodes.size());
+    m_device->SetTimingTraceName("dispatch graph");
+
+    PIXBeginEvent(PIX_COLOR(128, 255, 0), L"Dispatch Graph Loop");
+    try
+    {
+        Timer loopTimer, iterationTimer;
+        bool timedOut = false;
+
+        for (; !timedOut && iterationsCompleted < m_commandLineArgs.DispatchIterations(); iterationsCompleted++)
+        {
+            TraceScope traceIteration("iteration", "iteration");
+            iterationTimer.Start();
+            previousFenceValues = fenceValues;
+
+            for (size_t i = 0; i < nodes.size(); i++)
+            {
+                auto& scheduledNode = schedule.nodes[i];
+                m_device->SetActiveQueue(scheduledNode.queue);
+                for (auto& wait : scheduledNode.waits)
+                {
+                    m_device->WaitForQueue(wait.queue, fenceValues[wait.node]);
+                }
+                if (iterationsCompleted > 0)
+                {
+                    for (auto dependency : previousIterationDependencies[i])
+                    {
+                        m_device->WaitForQueue(schedule.nodes[dependency].queue, previousFenceValues[dependency]);
+                    }
+                }
+
+                if (m_commandLineArgs.GetAutoBarriersAfterDispatch())
+                {
+                    m_device->SetRepeatDispatchBarriers(nodes[i].repeatBarriers);
+                }
+
+                nodes[i].dispatchable->Bind(nodes[i].bindings, iterationsCompleted);
+                nodes[i].dispatchable->Dispatch(*nodes[i].command, iterationsCompleted, m_deferredBinding);
+                fenceValues[i] = m_device->GetLastSubmittedFenceValue(scheduledNode.queue);
+            }
+
+            // The CPU only waits when a queue's frame ring is full (see ExecuteCommandListAndAdvanceFrame), so
+            // iterations overlap on the GPU.
+            cpuTimings.rawSamples.push_back(iterationTimer.End().DurationInMilliseconds());
+            m_iterationStats.Add(cpuTimings.rawSamples.back());
+
+            if (m_commandLineArgs.TimeToRunInMilliseconds() &&
+                loopTimer.End().DurationInMilliseconds() > m_commandLineArgs.TimeToRunInMilliseconds().value())
+            {
+                timedOut = true;
+            }
+        }
+
+        m_device->SetActiveQueue(0);
+        m_device->WaitForGpuWorkToComplete();
+    }
+    catch (const std::exception& e)
+    {
+        // Descriptors are retired on the primary queue, so dispatchables that are released after this (e.g. when
+        // the executor is destroyed) must not be executing on other queues.
+        m_device->SetActiveQueue(0);
+        m_device->WaitForGpuWorkToComplete();
+
+        m_logger->LogError(fmt::format("Failed to execute dispatch graph: {}", e.what()).c_str());
+        if (m_commandLineArgs.PrintCommands())
+        {
+            for (uint32_t id = begin; id < end; id++)
+            {
+                m_logger->LogCommandCompleted(id, E_FAIL, e.what());
+            }
+        }
+        throw;
+    }
+    PIXEndEvent();
+
+    auto cpuStats = cpuTimings.ComputeStats(m_commandLineArgs.MaxWarmupSamples());
+    m_logger->LogInfo(fmt::format("Dispatch graph ({} commands, {} queues): {} iterations, {:.4f} ms median (CPU)",
+        nodes.size(), schedule.queueCount, iterationsCompleted, cpuStats.hot.median).c_str());
+
+    // Timing samples are resolved in recording order, so the last samples are the commands of the last iterations.
+    auto gpuSamples = m_device->ResolveTimingSamples();
+    size_t gpuIterations = gpuSamples.size() / nodes.size();
+    if (gpuIterations > 0)
+    {
+        size_t firstSample = gpuSamples.size() - gpuIterations * nodes.size();
+        for (size_t i = 0; i < nodes.size(); i++)
+        {
+            Timings nodeTimings;
+            for (size_t iteration = 0; iteration < gpuIterations; iteration++)
+            {
+                nodeTimings.rawSamples.push_back(gpuSamples[firstSample + iteration * nodes.size() + i]);
+            }
+            graph.SetCost(i, nodeTimings.ComputeStats(nodeTimings.rawSamples).median);
+        }
+
+        m_logger->LogInfo(fmt::format("Critical path: {:.4f} ms, total work: {:.4f} ms ({:.2f}x available parallelism) (GPU)",
+            graph.CriticalPath(), graph.TotalWork(), graph.CriticalPath() > 0 ? graph.TotalWork() / graph.CriticalPath() : 1.0).c_str());
+    }
+
+    if (m_commandLineArgs.PrintCommands())
+    {
+        for (uint32_t id = begin; id < end; id++)
+        {
+            m_logger->LogCommandCompleted(id, S_OK, "");
+        }
+    }
+
+    m_nextId = end >= GetCommandCount() ? 0 : end;
+}
+
+void Executor::RunDispatchBatch(uint32_t begin, uint32_t end)
+{
+    TraceScope trace("command", fmt::format("dispatch batch ({} commands)", end - begin));
+    auto commandDescs = m_model.GetCommands();
+    if (begin != m_nextId)
+    {
+        auto msg = fmt::format("Invalid Id={} ExpectedId={}", begin, m_nextId);
+        m_logger->LogError(msg.c_str());
+        throw std::invalid_argument(msg);
+    }
+
+    struct BatchCommand
+    {
+        const Model::DispatchCommand* command;
+        Dispatchable* dispatchable;
+        Dispatchable::Bindings bindings;
+        std::vector<D3D12_RESOURCE_BARRIER> barriers;
+        std::vector<D3D12_RESOURCE_BARRIER> repeatBarriers;
+    };
+
+    std::vector<BatchCommand> commands;
+
+    if (m_commandLineArgs.PrintCommands())
+    {
+        for (uint32_t id = begin; id < end; id++)
+        {
+            m_logger->LogCommandStarted(id, commandDescs[id].parameters.c_str());
+        }
+    }
+
+    try
+    {
+        m_deferredBinding.clear();
+
+        // All commands of an iteration are submitted together, so (in auto mode) barriers are planned for hazards 
+        // between commands as well as between the repeats of each command. The fixed post-dispatch barriers 
+        // already separate every dispatch.
+        BarrierPlanner planner;
+        for (uint32_t id = begin; id < end; id++)
+        {
+            auto& command = std::get<Model::DispatchCommand>(commandDescs[id].command);
+            BatchCommand batchCommand = { &command, m_dispatchables[command.dispatchableName].get(), ResolveBindings(command.bindings) };
+            batchCommand.dispatchable->Bind(batchCommand.bindings, 0);
+
+            if (m_commandLineArgs.GetAutoBarriersAfterDispatch())
+            {
+                auto accesses = GetPlannerAccesses(batchCommand.dispatchable->GetResourceAccesses(batchCommand.bindings));
+                batchCommand.barriers = GetResourceBarriers(planner.AddDispatch(accesses));
+                if (m_commandLineArgs.DispatchRepeat() > 1)
+                {
+                    batchCommand.repeatBarriers = GetResourceBarriers(planner.AddDispatch(accesses));
+                }
+            }
+            commands.push_back(std::move(batchCommand));
+        }
+
+        if (m_commandLineArgs.PrintCommands() && m_commandLineArgs.GetAutoBarriersAfterDispatch())
+        {
+            m_logger->LogInfo(fmt::format("Dispatch batch: {} barriers planned", planner.BarrierCount()).c_str());
+        }
+    }
+    catch (const std::exception& e)
+    {
+        m_logger->LogError(fmt::format("ERROR while binding resources: {}\n", e.what()).c_str());
+        throw;
+    }
+
+    // The batch is split into contiguous chunks, each recorded into its own worker command list. The device
+    // submits the worker command lists in chunk order, so the recorded order is the same regardless of which
+    // thread records each chunk. When replaying, the chunks are instead recorded once into replay command lists,
+    // and only the end timestamp is recorded into a worker command list each iteration.
+    bool replay = m_commandLineArgs.ReplayDispatches();
+    uint32_t threadCount = std::max(m_commandLineArgs.RecordThreads(), 1u);
+    uint32_t chunkCount = std::min(threadCount, static_cast<uint32_t>(commands.size()));
+    m_device->EnsureWorkerCommandLists(replay ? 1 : chunkCount);
+    if (threadCount > 1 && !m_recordThreadPool)
+    {
+        m_recordThreadPool = std::make_unique<ThreadPool>(threadCount);
+    }
+
+    std::vector<Device::ReplayCommandList> replayCommandLists;
+    std::vector<ID3D12CommandList*> replayCommandListPointers;
+
+    auto RecordChunk = [&](size_t chunk)
+    {
+        auto target = replay ? replayCommandLists[chunk].GetRecordingTarget() : m_device->GetWorkerRecordingTarget(static_cast<uint32_t>(chunk));
+        for (size_t i = chunk * commands.size() / chunkCount; i < (chunk + 1) * commands.size() / chunkCount; i++)
+        {
+            if (!commands[i].barriers.empty())
+            {
+                target.commandList->ResourceBarrier(static_cast<uint32_t>(commands[i].barriers.size()), commands[i].barriers.data());
+            }
+            target.repeatBarriers = commands[i].repeatBarriers;
+            commands[i].dispatchable->RecordDispatch(*commands[i].command, target);
+        }
+    };
+
+    Timings cpuTimings;
+    Timings singleThreadRecordTimings;
+    Timings multiThreadRecordTimings;
+    double captureDurationInMilliseconds = 0;
+    uint32_t iterationsCompleted = 0;
+    double loopDurationInMilliseconds = 0;
+    uint64_t initialFrameStallCount = m_device->GetFrameStallCount();
+    uint64_t frameStallCount = 0;
+
+    // Timing samples are divided by the dispatch repeat, but each sample here covers the whole batch.
+    WarmupStats gpuSampleStats(m_commandLineArgs.MaxWarmupSamples());
+    m_device->SetTimingSampleCallback([&](double sample) { gpuSampleStats.Add(sample * m_commandLineArgs.DispatchRepeat()); });
+    m_device->SetTimingTraceName("dispatch batch");
+    auto clearTimingSampleCallback = gsl::finally([&] { m_device->SetTimingSampleCallback(nullptr); });
+
+    PIXBeginEvent(PIX_COLOR(128, 255, 0), L"Dispatch Batch Loop");
+    try
+    {
+        Timer loopTimer, iterationTimer, recordTimer;
+        bool timedOut = false;
+
+        if (replay)
+        {
+            for (uint32_t chunk = 0; chunk < chunkCount; chunk++)
+            {
+                replayCommandLists.push_back(m_device->CreateReplayCommandList());
+            }
+
+            recordTimer.Start();
+            if (m_recordThreadPool)
+            {
+                m_recordThreadPool->ParallelFor(chunkCount, RecordChunk);
+            }
+            else
+            {
+                RecordChunk(0);
+            }
+
+            for (auto& replayCommandList : replayCommandLists)
+            {
+                THROW_IF_FAILED(replayCommandList.commandList->Close());
+                replayCommandListPointers.push_back(replayCommandList.commandList.Get());
+            }
+            captureDurationInMilliseconds = recordTimer.End().DurationInMilliseconds();
+            loopTimer.Start();
+        }
+
+        for (; !timedOut && iterationsCompleted < m_commandLineArgs.DispatchIterations(); iterationsCompleted++)
+        {
+            TraceScope traceIteration("iteration", "iteration");
+            iterationTimer.Start();
+
+            // The device command list is submitted first, so its timestamp marks the start of the batch.
+            if (replay)
+            {
+                // Nothing changes between iterations, so the captured command lists are submitted as they are.
+                m_device->RecordTimestamp();
+                m_device->RecordTimestamp(m_device->GetWorkerRecordingTarget(0).commandList);
+                m_device->ExecuteCommandListAndAdvanceFrame(replayCommandListPointers);
+            }
+            else
+            {
+                for (auto& command : commands)
+                {
+                    command.dispatchable->Bind(command.bindings, iterationsCompleted);
+                }
+
+                m_device->RecordTimestamp();
+
+                recordTimer.Start();
+                if (m_recordThreadPool)
+                {
+                    m_recordThreadPool->ParallelFor(chunkCount, RecordChunk);
+                    multiThreadRecordTimings.rawSamples.push_back(recordTimer.End().DurationInMilliseconds());
+                }
+                else
+                {
+                    for (uint32_t chunk = 0; chunk < chunkCount; chunk++)
+                    {
+                        RecordChunk(chunk);
+                    }
+                    singleThreadRecordTimings.rawSamples.push_back(recordTimer.End().DurationInMilliseconds());
+                }
+
+                m_device->RecordTimestamp(m_device->GetWorkerRecordingTarget(chunkCount - 1).commandList);
+                m_device->ExecuteCommandListAndAdvanceFrame();
+            }
+            cpuTimings.rawSamples.push_back(iterationTimer.End().DurationInMilliseconds());
+            m_iterationStats.Add(cpuTimings.rawSamples.back());
+
+            if (m_commandLineArgs.TimeToRunInMilliseconds() &&
+                loopTimer.End().DurationInMilliseconds() > m_commandLineArgs.TimeToRunInMilliseconds().value())
+            {
+                timedOut = true;
+            }
         }
-    }
 
-    // Compile/initialize dispatchables.
-    {
-        Timer timer;
+        if (m_device->GetMaxFramesInFlight() > 1)
+        {
+            m_device->ExecuteCommandListAndWait();
+        }
+        loopDurationInMilliseconds = loopTimer.End().DurationInMilliseconds();
+        frameStallCount = m_device->GetFrameStallCount() - initialFrameStallCount;
 
-        PIXBeginEvent(m_device->GetCommandQueue(), PIX_COLOR(255, 255, 0), "Initialize dispatchables");
-        for (auto& dispatchable : m_dispatchables)
+        // The timed iterations always record in parallel. For comparison, the same iterations are then recorded on 
+        // this thread alone in a separate, untimed pass (without timestamps, so the GPU times aren't affected).
+        if (m_recordThreadPool && !replay)
         {
-            try
+            TraceScope traceBaseline("command", "dispatch batch record baseline (1 thread)");
+            for (uint32_t iteration = 0; iteration < iterationsCompleted; iteration++)
             {
-                timer.Start();
-                PIXBeginEvent(PIX_COLOR(128,255,0), L"Init");
-                dispatchable.second->Initialize();
-                PIXEndEvent();
-                timer.End();
+                for (auto& command : commands)
+                {
+                    command.dispatchable->Bind(command.bindings, iterationsCompleted + iteration);
+                }
 
-                if (m_commandLineArgs.GetTimingVerbosity() >= TimingVerbosity::Extended)
+                recordTimer.Start();
+                for (uint32_t chunk = 0; chunk < chunkCount; chunk++)
                 {
-                    m_logger->LogInfo(fmt::format("Initialize '{}': {:.4f} ms", dispatchable.first, timer.DurationInMilliseconds()).c_str());
+                    RecordChunk(chunk);
                 }
+                singleThreadRecordTimings.rawSamples.push_back(recordTimer.End().DurationInMilliseconds());
+                m_device->ExecuteCommandListAndAdvanceFrame();
             }
-            catch (const std::exception& e)
+
+            if (m_device->GetMaxFramesInFlight() > 1)
             {
-                throw std::invalid_argument(fmt::format("ERROR while initializing '{}': {}", dispatchable.first, e.what()));
+                m_device->ExecuteCommandListAndWait();
             }
         }
-        PIXEndEvent(m_device->GetCommandQueue());
     }
-}
-
-uint32_t Executor::GetCommandCount()
-{
-    return static_cast<uint32_t>(m_model.GetCommands().size());
-}
-
-void Executor::RunCommand(UINT32 id)
-{
-    auto commandDescs = m_model.GetCommands();
-    auto maxCommands = GetCommandCount();
-    if (id == m_nextId)
+    catch (const std::exception& e)
     {
-        if (m_commandLineArgs.PrintCommands())
+        // Replay command lists are released when this returns, so they must not be executing.
+        if (!replayCommandLists.empty())
         {
-            m_logger->LogCommandStarted((UINT32)id, commandDescs[id].parameters.c_str());
+            m_device->WaitForGpuWorkToComplete();
         }
 
-        try
-        {
-            std::visit(*this, commandDescs[id].command);
-            if (m_commandLineArgs.PrintCommands())
-            {
-                m_logger->LogCommandCompleted((UINT32)id, S_OK, "");
-            }
-        }
-        catch (std::exception& ex)
+        m_logger->LogError(fmt::format("Failed to execute dispatch batch: {}", e.what()).c_str());
+        if (m_commandLineArgs.PrintCommands())
         {
-            if (m_commandLineArgs.PrintCommands())
+            for (uint32_t id = begin; id < end; id++)
             {
-#ifdef WIN32
-            HRESULT hr = wil::ResultFromCaughtException();
-#else
-            HRESULT hr = E_FAIL;
-#endif
-                m_logger->LogCommandCompleted((UINT32)id, hr, ex.what());
+                m_logger->LogCommandCompleted(id, E_FAIL, e.what());
             }
-            throw;
         }
+        throw;
     }
-    else
+    PIXEndEvent();
+
+    m_device->ResolveTimingSamples();
+
+    auto cpuStats = cpuTimings.ComputeStats(m_commandLineArgs.MaxWarmupSamples());
+    auto gpuHotStats = gpuSampleStats.GetHotSummary();
+    std::string gpuTime = gpuSampleStats.Count() == 0 ? "" : fmt::format(", {:.4f} ms median (GPU)", gpuHotStats.median);
+
+    if (replay)
     {
-        auto msg = fmt::format("Invalid Id={} ExpectedId={}", id, m_nextId);
-        m_logger->LogError(msg.c_str());
-        throw std::invalid_argument(msg);
+        m_logger->LogInfo(fmt::format("Dispatch batch ({} commands, {} command lists, replayed): {} iterations, {:.4f} ms median submit (CPU){}",
+            commands.size(), chunkCount, iterationsCompleted, cpuStats.hot.median, gpuTime).c_str());
+
+        m_logger->LogInfo(fmt::format("Capture: {:.4f} ms", captureDurationInMilliseconds).c_str());
     }
-    if ((m_nextId++) >= maxCommands)
+    else
     {
-        m_nextId = 0;
+        m_logger->LogInfo(fmt::format("Dispatch batch ({} commands, {} command lists): {} iterations, {:.4f} ms median (CPU){}",
+            commands.size(), chunkCount, iterationsCompleted, cpuStats.hot.median, gpuTime).c_str());
+
+        auto singleThreadRecordStats = singleThreadRecordTimings.ComputeStats(m_commandLineArgs.MaxWarmupSamples());
+        auto multiThreadRecordStats = multiThreadRecordTimings.ComputeStats(m_commandLineArgs.MaxWarmupSamples());
+        if (multiThreadRecordStats.hot.count > 0)
+        {
+            m_logger->LogInfo(fmt::format("Record: {:.4f} ms median ({} threads), {:.4f} ms median (1 thread, baseline pass), {:.2f}x speedup",
+                multiThreadRecordStats.hot.median,
+                threadCount,
+                singleThreadRecordStats.hot.median,
+                multiThreadRecordStats.hot.median > 0 ? singleThreadRecordStats.hot.median / multiThreadRecordStats.hot.median : 1.0
+            ).c_str());
+        }
+        else
+        {
+            m_logger->LogInfo(fmt::format("Record: {:.4f} ms median (1 thread)", singleThreadRecordStats.hot.median).c_str());
+        }
     }
-    return;
-}
 
+    if (m_device->GetMaxFramesInFlight() > 1 && loopDurationInMilliseconds > 0)
+    {
+        m_logger->LogInfo(fmt::format("Throughput: {:.2f} iterations/s ({} frames in flight, {} stalls)",
+            iterationsCompleted * 1000.0 / loopDurationInMilliseconds,
+            m_device->GetMaxFramesInFlight(),
+            frameStallCount
+        ).c_str());
+    }
 
-void Executor::Run()
-{
-    for (uint32_t i = 0, c = GetCommandCount(); i < c; i++)
+    if (m_commandLineArgs.PrintCommands())
     {
-        RunCommand(i);
+        for (uint32_t id = begin; id < end; id++)
+        {
+            m_logger->LogCommandCompleted(id, S_OK, "");
+        }
     }
-    return;
+
+    m_nextId = end >= GetCommandCount() ? 0 : end;
 }
 
 void Executor::operator()(const Model::DispatchCommand& command)
@@ -278,9 +1692,32 @@ void Executor::operator()(const Model::DispatchCommand& command)
     Timings cpuTimings;
     Timings gpuTimings;
 
+    // GPU samples are streamed into these statistics as they're read back, so the statistics cover every iteration
+    // even when only the most recent raw samples are kept.
+    WarmupStats gpuSampleStats(m_commandLineArgs.MaxWarmupSamples());
+    m_device->SetTimingSampleCallback([&](double sample) { gpuSampleStats.Add(sample); });
+    m_device->SetTimingTraceName(command.dispatchableName);
+    auto clearTimingSampleCallback = gsl::finally([&] { m_device->SetTimingSampleCallback(nullptr); });
+
+    // Bind times are split by whether the dispatchable reused its cached binding state.
+    Timings cachedBindTimings;
+    Timings uncachedBindTimings;
+    auto bindingCacheStats = dispatchable->GetBindingCacheStats();
+
+    // CPU time of each iteration is broken down by phase, which is only measured when it will be printed.
+    std::optional<PhaseRecorder> phaseRecorder;
+    std::vector<WarmupStats> phaseStats;
+    if (c_phaseTimingEnabled && m_commandLineArgs.GetTimingVerbosity() >= TimingVerbosity::Extended)
+    {
+        phaseRecorder.emplace();
+        phaseStats.resize(PhaseRecorder::c_phaseCount, WarmupStats(m_commandLineArgs.MaxWarmupSamples()));
+    }
+
     Dispatchable::Bindings bindings;
+    double resolveBindingsTime = 0;
     try
     {
+        DXD_PHASE_SCOPE(CpuPhase::ResolveBindings);
         m_deferredBinding.clear();
         bindings = ResolveBindings(command.bindings);
     }
@@ -290,9 +1727,48 @@ void Executor::operator()(const Model::DispatchCommand& command)
         throw;
     }
 
+    if (phaseRecorder)
+    {
+        resolveBindingsTime = phaseRecorder->TakeTotals()[static_cast<size_t>(CpuPhase::ResolveBindings)];
+    }
+
+    if (!m_commandLineArgs.GetOnnxBindingShapeSweep().empty() && dispatchable->SupportsBindingShapes())
+    {
+        PIXBeginEvent(PIX_COLOR(128, 255, 0), L"Binding Shape Sweep");
+        try
+        {
+            RunBindingShapeSweep(command, *dispatchable, bindings);
+        }
+        catch (const std::exception& e)
+        {
+            m_logger->LogError(fmt::format("Failed to execute dispatchable: {}", e.what()).c_str());
+            throw;
+        }
+        PIXEndEvent();
+        return;
+    }
+
+    if (m_commandLineArgs.OpenLoopEnabled())
+    {
+        PIXBeginEvent(PIX_COLOR(128, 255, 0), L"Open Loop");
+        try
+        {
+            RunOpenLoopDispatch(command, *dispatchable, bindings);
+        }
+        catch (const std::exception& e)
+        {
+            m_logger->LogError(fmt::format("Failed to execute dispatchable: {}", e.what()).c_str());
+            throw;
+        }
+        PIXEndEvent();
+        return;
+    }
+
     // Dispatch
     uint32_t iterationsCompleted = 0;
     bool timedOut = false;
+    double loopDurationInMilliseconds = 0;
+    uint64_t initialFrameStallCount = m_device->GetFrameStallCount();
     PIXBeginEvent(PIX_COLOR(128, 255, 0), L"Dispatch Loop");
     try
     {
@@ -300,13 +1776,39 @@ void Executor::operator()(const Model::DispatchCommand& command)
 
         for (; !timedOut && iterationsCompleted < m_commandLineArgs.DispatchIterations(); iterationsCompleted++)
         {
+            TraceScope traceIteration("iteration", "iteration");
             iterationTimer.Start();
 
             // Bind
             PIXBeginEvent(PIX_COLOR(128, 255, 0), L"Bind");
             try
             {
-                dispatchable->Bind(bindings, iterationsCompleted);
+                bindTimer.Start();
+                {
+                    DXD_PHASE_SCOPE(CpuPhase::Bind);
+                    dispatchable->Bind(bindings, iterationsCompleted);
+                }
+                double bindTime = bindTimer.End().DurationInMilliseconds();
+
+                // Binds that didn't consult the cache (e.g. ONNX dispatchables only bind the first iteration) aren't counted.
+                if (bindingCacheStats)
+                {
+                    auto previousStats = *bindingCacheStats;
+                    bindingCacheStats = dispatchable->GetBindingCacheStats();
+                    if (bindingCacheStats->hits > previousStats.hits)
+                    {
+                        cachedBindTimings.rawSamples.push_back(bindTime);
+                    }
+                    else if (bindingCacheStats->misses > previousStats.misses)
+                    {
+                        uncachedBindTimings.rawSamples.push_back(bindTime);
+                    }
+                }
+
+                if (iterationsCompleted == 0 && m_commandLineArgs.GetAutoBarriersAfterDispatch())
+                {
+                    m_device->SetRepeatDispatchBarriers(PlanRepeatDispatchBarriers(command.dispatchableName, *dispatchable, bindings));
+                }
             }
             catch (const std::exception& e)
             {
@@ -317,12 +1819,17 @@ void Executor::operator()(const Model::DispatchCommand& command)
 
             // Dispatch
             dispatchTimer.Start();
-            dispatchable->Dispatch(command, iterationsCompleted, m_deferredBinding);
+            {
+                DXD_PHASE_SCOPE(CpuPhase::Record);
+                dispatchable->Dispatch(command, iterationsCompleted, m_deferredBinding);
+            }
             cpuTimings.rawSamples.push_back(dispatchTimer.End().DurationInMilliseconds() / m_commandLineArgs.DispatchRepeat());
 
             // The dispatch interval defaults to 0 (dispatch as fast as possible). However, the user may increase it
             // to potentially introduce a sleep between each iteration.
-            double timeToSleep = std::max(0.0, m_commandLineArgs.MinimumDispatchIntervalInMilliseconds() - iterationTimer.End().DurationInMilliseconds());
+            double iterationTime = iterationTimer.End().DurationInMilliseconds();
+            m_iterationStats.Add(iterationTime);
+            double timeToSleep = std::max(0.0, m_commandLineArgs.MinimumDispatchIntervalInMilliseconds() - iterationTime);
 
             if (m_commandLineArgs.TimeToRunInMilliseconds() &&
                 loopTimer.End().DurationInMilliseconds() + timeToSleep > m_commandLineArgs.TimeToRunInMilliseconds().value())
@@ -332,6 +1839,7 @@ void Executor::operator()(const Model::DispatchCommand& command)
             else
             {
                 // Not particularly precise (may be off by some milliseconds). Consider using OS APIs in the future.
+                DXD_PHASE_SCOPE(CpuPhase::Sleep);
                 std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<size_t>(timeToSleep)));
             }
 
@@ -339,7 +1847,23 @@ void Executor::operator()(const Model::DispatchCommand& command)
             {
                 m_device->DummyPresent();
             }
+
+            if (phaseRecorder)
+            {
+                auto phaseTimes = phaseRecorder->TakeTotals();
+                for (size_t phase = 0; phase < phaseTimes.size(); phase++)
+                {
+                    phaseStats[phase].Add(phaseTimes[phase]);
+                }
+            }
+        }
+
+        // With multiple frames in flight the last iterations may still be executing on the GPU.
+        if (m_device->GetMaxFramesInFlight() > 1)
+        {
+            m_device->ExecuteCommandListAndWait();
         }
+        loopDurationInMilliseconds = loopTimer.End().DurationInMilliseconds();
     }
     catch (const std::exception& e)
     {
@@ -350,18 +1874,17 @@ void Executor::operator()(const Model::DispatchCommand& command)
 
     auto cpuStats = cpuTimings.ComputeStats(m_commandLineArgs.MaxWarmupSamples());
 
-    // GPU timings are capped at a fixed size ring buffer. The first samples may have been 
-    // overwritten, in which case the warmup samples are dropped.
+    // Raw GPU samples are capped at a fixed size, so those of the first iterations may have been dropped.
     gpuTimings.rawSamples = m_device->ResolveTimingSamples();
-    assert(cpuTimings.rawSamples.size() >= gpuTimings.rawSamples.size());
-    auto gpuSamplesOverwritten =  static_cast<uint32_t>(gpuTimings.rawSamples.empty() ? 0 : cpuTimings.rawSamples.size() - gpuTimings.rawSamples.size());
-    auto gpuStats = gpuTimings.ComputeStats(std::max(m_commandLineArgs.MaxWarmupSamples(), gpuSamplesOverwritten) - gpuSamplesOverwritten);
+    assert(gpuSampleStats.Count() >= gpuTimings.rawSamples.size());
+    auto gpuSamplesDropped = static_cast<uint32_t>(gpuSampleStats.Count() - gpuTimings.rawSamples.size());
+    Timings::SampleStats gpuStats = { gpuSampleStats.GetColdSummary(), gpuSampleStats.GetHotSummary() };
 
     if (iterationsCompleted > 0)
     {
         if (m_commandLineArgs.GetTimingVerbosity() == TimingVerbosity::Basic)
         {
-            if (gpuTimings.rawSamples.empty())
+            if (gpuSampleStats.Count() == 0)
             {
                 m_logger->LogInfo(fmt::format("Dispatch '{}': {} iterations, {:.4f} ms median (CPU)",
                     command.dispatchableName, 
@@ -413,22 +1936,73 @@ void Executor::operator()(const Model::DispatchCommand& command)
                 ).c_str());
             }
 
-            if (gpuSamplesOverwritten > 0)
+            if (phaseRecorder)
+            {
+                auto phaseMedian = [&](CpuPhase phase) { return phaseStats[static_cast<size_t>(phase)].GetHotSummary().median; };
+                m_logger->LogInfo(fmt::format("CPU Phases (Hot)   : {:.4f} ms bind, {:.4f} ms record, {:.4f} ms submit, {:.4f} ms fence wait, {:.4f} ms sleep (median), {:.4f} ms resolve bindings (once)",
+                    phaseMedian(CpuPhase::Bind),
+                    phaseMedian(CpuPhase::Record),
+                    phaseMedian(CpuPhase::Submit),
+                    phaseMedian(CpuPhase::FenceWait),
+                    phaseMedian(CpuPhase::Sleep),
+                    resolveBindingsTime
+                ).c_str());
+            }
+
+            if (!cachedBindTimings.rawSamples.empty())
+            {
+                // Use the most recent uncached bind time of this dispatchable to estimate the savings, since all 
+                // iterations of a command may hit the cache if the previous command used the same bindings.
+                auto cachedStats = cachedBindTimings.ComputeStats(gsl::make_span<const double>(cachedBindTimings.rawSamples));
+                if (!uncachedBindTimings.rawSamples.empty())
+                {
+                    m_uncachedBindTimes[command.dispatchableName] = uncachedBindTimings.rawSamples.back();
+                }
+
+                auto uncachedBindTime = m_uncachedBindTimes.find(command.dispatchableName);
+                if (uncachedBindTime != m_uncachedBindTimes.end())
+                {
+                    m_logger->LogInfo(fmt::format("Bind Cache         : {} hits, {} misses, {:.4f} ms median (hit), {:.4f} ms (miss), {:.4f} ms saved",
+                        cachedStats.count, 
+                        uncachedBindTimings.rawSamples.size(),
+                        cachedStats.median,
+                        uncachedBindTime->second,
+                        std::max(0.0, uncachedBindTime->second * cachedStats.count - cachedStats.sum)
+                    ).c_str());
+                }
+            }
+
+            auto& transientPoolStats = m_device->GetTransientPoolStats();
+            if (transientPoolStats.requestCount > 0)
             {
-                m_logger->LogInfo(fmt::format("GPU samples buffer has {} samples overwritten.", gpuSamplesOverwritten).c_str());
+                m_logger->LogInfo(fmt::format("Transient Memory   : {} bytes shared by {} requests ({} bytes without aliasing), {} heaps created",
+                    transientPoolStats.capacityInBytes,
+                    transientPoolStats.requestCount,
+                    transientPoolStats.requestedInBytes,
+                    transientPoolStats.heapCount
+                ).c_str());
             }
         }
 
+        if (m_device->GetMaxFramesInFlight() > 1 && loopDurationInMilliseconds > 0)
+        {
+            m_logger->LogInfo(fmt::format("Throughput: {:.2f} iterations/s ({} frames in flight, {} stalls)",
+                iterationsCompleted * 1000.0 / loopDurationInMilliseconds,
+                m_device->GetMaxFramesInFlight(),
+                m_device->GetFrameStallCount() - initialFrameStallCount
+            ).c_str());
+        }
+
         if (m_commandLineArgs.GetTimingVerbosity() >= TimingVerbosity::All)
         {
             m_logger->LogInfo("The timings of each iteration: ");
 
             for (uint32_t i = 0; i < iterationsCompleted; ++i)
             {
-                if (i < gpuSamplesOverwritten || gpuTimings.rawSamples.empty())
+                if (i < gpuSamplesDropped || i - gpuSamplesDropped >= gpuTimings.rawSamples.size())
                 {
-                    // GPU samples are limited to a fixed size, so the initial iterations
-                    // may not have timing information (overwritten timestamps).
+                    // Raw GPU samples are limited to a fixed size, so the initial iterations
+                    // may not have timing information (dropped samples).
                     m_logger->LogInfo(fmt::format("iteration {}: {:.4f} ms (CPU)",
                         i, cpuTimings.rawSamples[i]
                     ).c_str());
@@ -436,7 +2010,7 @@ void Executor::operator()(const Model::DispatchCommand& command)
                 else
                 {
                     m_logger->LogInfo(fmt::format("iteration {}: {:.4f} ms (CPU), {:.4f} ms (GPU)",
-                        i, cpuTimings.rawSamples[i], gpuTimings.rawSamples[i - gpuSamplesOverwritten]
+                        i, cpuTimings.rawSamples[i], gpuTimings.rawSamples[i - gpuSamplesDropped]
                     ).c_str());
                 }
             }
@@ -444,6 +2018,237 @@ void Executor::operator()(const Model::DispatchCommand& command)
     }
 }
 
+void Executor::RunOpenLoopDispatch(const Model::DispatchCommand& command, Dispatchable& dispatchable, const Dispatchable::Bindings& bindings)
+{
+    using Clock = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+
+    // Each request completes before the next one starts (a single server), so with multiple frames in flight the
+    // GPU work of a request is waited for explicitly.
+    uint32_t iteration = 0;
+    auto runRequest = [&]
+    {
+        dispatchable.Bind(bindings, iteration);
+        if (iteration == 0 && m_commandLineArgs.GetAutoBarriersAfterDispatch())
+        {
+            m_device->SetRepeatDispatchBarriers(PlanRepeatDispatchBarriers(command.dispatchableName, dispatchable, bindings));
+        }
+        dispatchable.Dispatch(command, iteration, m_deferredBinding);
+        if (m_device->GetMaxFramesInFlight() > 1)
+        {
+            m_device->ExecuteCommandListAndWait();
+        }
+        iteration++;
+    };
+
+    // Warmup requests run back to back and aren't measured, so the first scheduled requests don't pay for cold caches.
+    m_device->SetTimingSampleCallback(nullptr);
+    for (uint32_t i = 0; i < std::max(m_commandLineArgs.MaxWarmupSamples(), 1u); i++)
+    {
+        TraceScope traceWarmup("iteration", "warmup");
+        runRequest();
+    }
+    m_device->ResolveTimingSamples();
+
+    // Without rates, the arrival trace is replayed at its own rate.
+    auto& traceIntervals = m_commandLineArgs.ArrivalTraceIntervals();
+    std::vector<std::optional<double>> rates(m_commandLineArgs.OpenLoopRates().begin(), m_commandLineArgs.OpenLoopRates().end());
+    if (rates.empty())
+    {
+        rates.push_back(std::nullopt);
+    }
+
+    for (auto& rate : rates)
+    {
+        auto schedule = !traceIntervals.empty() ? ArrivalSchedule::FromTrace(traceIntervals, rate) :
+            m_commandLineArgs.GetArrivalProcess() == ArrivalProcess::Constant ? ArrivalSchedule::Constant(*rate) :
+            ArrivalSchedule::Poisson(*rate, c_openLoopSeed);
+
+        // Latency is measured from a request's scheduled arrival, so time spent queued behind slower requests is
+        // included. Service time is measured from the request's actual start.
+        StreamingStats latencyStats;
+        StreamingStats serviceStats;
+        StreamingStats gpuStats;
+        m_device->SetTimingSampleCallback([&](double sample) { gpuStats.Add(sample); });
+
+        uint32_t requestCount = 0;
+        uint32_t queuedCount = 0;
+        double lastArrivalTime = 0;
+        auto loadStart = Clock::now();
+        auto lastCompletion = loadStart;
+        auto timeToRun = m_commandLineArgs.TimeToRunInMilliseconds();
+
+        for (; requestCount < m_commandLineArgs.DispatchIterations(); requestCount++)
+        {
+            double arrivalTime = schedule.NextArrivalTime();
+            if (timeToRun && arrivalTime >= *timeToRun)
+            {
+                break;
+            }
+            lastArrivalTime = arrivalTime;
+
+            auto arrival = loadStart + std::chrono::duration_cast<Clock::duration>(Milliseconds(arrivalTime));
+            if (lastCompletion > arrival)
+            {
+                queuedCount++;
+            }
+            else
+            {
+                if (arrival - Clock::now() > c_openLoopSpinTime)
+                {
+                    std::this_thread::sleep_until(arrival - c_openLoopSpinTime);
+                }
+                while (Clock::now() < arrival) {}
+            }
+
+            auto start = Clock::now();
+            {
+                TraceScope traceRequest("iteration", "request");
+                runRequest();
+            }
+            lastCompletion = Clock::now();
+
+            double serviceTime = Milliseconds(lastCompletion - start).count();
+            latencyStats.Add(Milliseconds(lastCompletion - arrival).count());
+            serviceStats.Add(serviceTime);
+            m_iterationStats.Add(serviceTime);
+        }
+        m_device->ResolveTimingSamples();
+
+        if (requestCount == 0)
+        {
+            continue;
+        }
+
+        // The offered rate of an unscaled trace is its mean rate over the requests that were issued. It's unbounded if
+        // all of them arrived at once (e.g. every timestamp in the trace is 0).
+        std::string offeredRate = "unbounded";
+        if (rate || requestCount == 1 || lastArrivalTime > 0)
+        {
+            offeredRate = fmt::format("{:.2f}", rate ? *rate : requestCount > 1 ? (requestCount - 1) * 1000.0 / lastArrivalTime : 0);
+        }
+        double loadDuration = Milliseconds(lastCompletion - loadStart).count();
+        m_logger->LogInfo(fmt::format("Open Loop '{}': {} requests/s offered, {:.2f} requests/s achieved, {} requests ({} queued)",
+            command.dispatchableName,
+            offeredRate,
+            loadDuration > 0 ? requestCount * 1000.0 / loadDuration : 0,
+            requestCount,
+            queuedCount
+        ).c_str());
+
+        m_logger->LogInfo(fmt::format("Latency            : {:.4f} ms p50, {:.4f} ms p90, {:.4f} ms p99, {:.4f} ms max",
+            latencyStats.Percentile(0.5),
+            latencyStats.Percentile(0.9),
+            latencyStats.Percentile(0.99),
+            latencyStats.GetSummary().max
+        ).c_str());
+
+        if (gpuStats.Count() == 0)
+        {
+            m_logger->LogInfo(fmt::format("Service Time       : {:.4f} ms median (CPU)", serviceStats.Percentile(0.5)).c_str());
+        }
+        else
+        {
+            m_logger->LogInfo(fmt::format("Service Time       : {:.4f} ms median (CPU), {:.6f} ms median (GPU)",
+                serviceStats.Percentile(0.5),
+                gpuStats.Percentile(0.5)
+            ).c_str());
+        }
+    }
+}
+
+void Executor::RunBindingShapeSweep(const Model::DispatchCommand& command, Dispatchable& dispatchable, const Dispatchable::Bindings& bindings)
+{
+    struct StepResult
+    {
+        std::string label;
+        uint32_t iterations;
+        double firstBindTime;
+        double firstDispatchTime;
+        StreamingStats::Summary cpuStats;
+        std::optional<StreamingStats::Summary> gpuStats;
+    };
+
+    // Every step binds its shapes on its first iteration, which only reallocates the resources that need to grow.
+    // That iteration also includes any work the session does for new shapes, so it's reported separately.
+    std::vector<StepResult> results;
+    auto restoreBindingShapes = gsl::finally([&] { dispatchable.SetBindingShapes({}); });
+    for (auto& step : m_commandLineArgs.GetOnnxBindingShapeSweep())
+    {
+        TraceScope traceStep("command", fmt::format("binding shapes {}", step.label));
+        dispatchable.SetBindingShapes(step.shapes);
+
+        WarmupStats cpuStats(m_commandLineArgs.MaxWarmupSamples());
+        WarmupStats gpuStats(m_commandLineArgs.MaxWarmupSamples());
+        m_device->SetTimingSampleCallback([&](double sample) { gpuStats.Add(sample); });
+
+        StepResult result = { step.label, 0, 0, 0 };
+        Timer loopTimer, iterationTimer, bindTimer, dispatchTimer;
+        for (; result.iterations < m_commandLineArgs.DispatchIterations(); result.iterations++)
+        {
+            if (m_commandLineArgs.TimeToRunInMilliseconds() &&
+                loopTimer.End().DurationInMilliseconds() > m_commandLineArgs.TimeToRunInMilliseconds().value())
+            {
+                break;
+            }
+
+            TraceScope traceIteration("iteration", "iteration");
+            iterationTimer.Start();
+            bindTimer.Start();
+            dispatchable.Bind(bindings, result.iterations);
+            double bindTime = bindTimer.End().DurationInMilliseconds();
+
+            dispatchTimer.Start();
+            dispatchable.Dispatch(command, result.iterations, m_deferredBinding);
+            double dispatchTime = dispatchTimer.End().DurationInMilliseconds() / m_commandLineArgs.DispatchRepeat();
+
+            if (result.iterations == 0)
+            {
+                result.firstBindTime = bindTime;
+                result.firstDispatchTime = dispatchTime;
+            }
+            cpuStats.Add(dispatchTime);
+            m_iterationStats.Add(iterationTimer.End().DurationInMilliseconds());
+        }
+
+        if (m_device->GetMaxFramesInFlight() > 1)
+        {
+            m_device->ExecuteCommandListAndWait();
+        }
+        m_device->ResolveTimingSamples();
+        m_device->SetTimingSampleCallback(nullptr);
+
+        result.cpuStats = cpuStats.GetHotSummary();
+        if (gpuStats.Count() > 0)
+        {
+            result.gpuStats = gpuStats.GetHotSummary();
+        }
+        results.push_back(std::move(result));
+    }
+
+    size_t labelWidth = std::string_view("Binding Shapes").size();
+    for (auto& result : results)
+    {
+        labelWidth = std::max(labelWidth, result.label.size());
+    }
+
+    m_logger->LogInfo(fmt::format("Binding Shape Sweep '{}': {} shapes", command.dispatchableName, results.size()).c_str());
+    m_logger->LogInfo(fmt::format("  {:<{}}  {:>10}  {:>12}  {:>12}  {:>12}  {:>12}  {:>12}",
+        "Binding Shapes", labelWidth, "Iterations", "Bind (first)", "CPU (first)", "CPU median", "CPU max", "GPU median").c_str());
+    for (auto& result : results)
+    {
+        m_logger->LogInfo(fmt::format("  {:<{}}  {:>10}  {:>9.4f} ms  {:>9.4f} ms  {:>9.4f} ms  {:>9.4f} ms  {:>12}",
+            result.label,
+            labelWidth,
+            result.iterations,
+            result.firstBindTime,
+            result.firstDispatchTime,
+            result.cpuStats.median,
+            result.cpuStats.max,
+            result.gpuStats ? fmt::format("{:.4f} ms", result.gpuStats->median) : "-").c_str());
+    }
+}
+
 template <typename T>
 struct BufferDataView
 {
@@ -548,7 +2353,7 @@ void Executor::operator()(const Model::PrintCommand& command)
         } 
         if (resource)
         {
-            outputValuesStorage = m_device->Download(resource);
+            outputValuesStorage = Download(command.resourceName, resource);
             outputValues = outputValuesStorage;
         }
 
@@ -603,22 +2408,10 @@ void Executor::operator()(const Model::WriteFileCommand& command)
         } 
         if (resource)
         {
-            fileDataStorage = m_device->Download(resource);
+            fileDataStorage = Download(command.resourceName, resource);
             fileData = fileDataStorage;
         }
 
-        std::filesystem::path pathToFile(command.targetPath.c_str());
-        if (!std::filesystem::exists(pathToFile.parent_path()))
-        {
-            std::filesystem::create_directories(pathToFile.parent_path());
-        }
-
-        std::ofstream file(command.targetPath.c_str(), std::ifstream::trunc | std::ifstream::binary);
-        if (!file.is_open())
-        {
-            throw std::ios::failure("Could not open file");
-        }
-
         // If NumPy array, serialize data into .npy file.
         if (IsNpyFilenameExtension(command.targetPath))
         {
@@ -635,8 +2428,13 @@ void Executor::operator()(const Model::WriteFileCommand& command)
             fileData = fileDataStorage;
         }
 
-        file.write(reinterpret_cast<const char*>(fileData.data()), fileData.size());
-        m_logger->LogInfo(fmt::format("Resource '{}' written to '{}'", command.resourceName, command.targetPath).c_str());
+        // The file is written on the background writer's thread; the result is reported by FlushFileWrites.
+        if (fileData.data() != fileDataStorage.data())
+        {
+            fileDataStorage.assign(fileData.begin(), fileData.end());
+        }
+        m_fileWriter->Write(command.targetPath, std::move(fileDataStorage));
+        m_queuedFileWriteResources.push_back(command.resourceName);
     }
     catch (const std::exception& e)
     {
@@ -644,6 +2442,49 @@ void Executor::operator()(const Model::WriteFileCommand& command)
     }
 }
 
+std::vector<D3D12_RESOURCE_BARRIER> Executor::PlanRepeatDispatchBarriers(const std::string& dispatchableName, const Dispatchable& dispatchable, const Dispatchable::Bindings& bindings)
+{
+    auto accesses = dispatchable.GetResourceAccesses(bindings);
+    auto plannerAccesses = GetPlannerAccesses(accesses);
+
+    std::unordered_map<BarrierPlanner::ResourceHandle, std::string> resourceNames;
+    for (auto& access : accesses)
+    {
+        resourceNames[access.resource] = access.name;
+    }
+
+    // Each iteration is submitted in its own command list, so hazards only exist between the repeats of the 
+    // dispatch within an iteration. Every repeat has the same accesses, so the same barriers apply between each pair.
+    BarrierPlanner planner;
+    planner.AddDispatch(plannerAccesses);
+    auto plannedBarriers = planner.AddDispatch(plannerAccesses);
+
+    std::string barrierNames;
+    auto AddBarrierName = [&](const std::string& name)
+    {
+        barrierNames += barrierNames.empty() ? name : ", " + name;
+    };
+
+    for (auto resource : plannedBarriers.uav)
+    {
+        AddBarrierName(fmt::format("UAV({})", resourceNames[resource]));
+    }
+    for (auto& aliasing : plannedBarriers.aliasing)
+    {
+        AddBarrierName(fmt::format("Aliasing({} -> {})", resourceNames[aliasing.before], resourceNames[aliasing.after]));
+    }
+
+    if (m_commandLineArgs.PrintCommands())
+    {
+        m_logger->LogInfo(fmt::format("Barriers between repeats of '{}': {}",
+            dispatchableName, 
+            barrierNames.empty() ? "none" : barrierNames
+        ).c_str());
+    }
+
+    return GetResourceBarriers(plannedBarriers);
+}
+
 Dispatchable::Bindings Executor::ResolveBindings(const Model::Bindings& modelBindings)
 {
     Dispatchable::Bindings bindings;
@@ -1,11 +1,17 @@
 #pragma once
 
+#include <unordered_set>
+#include "StreamingStats.h"
+
 class CommandLineArgs;
+class ThreadPool;
+class BackgroundFileWriter;
 
 class Executor
 {
 public:
     Executor(Model& model, std::shared_ptr<Device> device, const CommandLineArgs& args, IDxDispatchLogger* logger);
+    ~Executor();
 
     uint32_t GetCommandCount();
     void RunCommand(UINT32 id);
@@ -14,8 +20,55 @@ public:
     void operator()(const Model::PrintCommand& command);
     void operator()(const Model::WriteFileCommand& command);
 
+    // Host access to the model's buffers between runs, e.g. to run the same executor again with new inputs. The GPU
+    // must be idle (as it is after Run and RunCommand return).
+    uint64_t GetResourceSize(const std::string& resourceName);
+    void SetResourceData(const std::string& resourceName, gsl::span<const std::byte> data);
+    std::vector<std::byte> GetResourceData(const std::string& resourceName);
+
+    // Replaces a buffer of the model with one over host memory (see Device::WrapHostMemory), so that the caller reads
+    // and writes its contents directly. The memory must stay allocated until the executor is released.
+    void WrapResourceHostMemory(const std::string& resourceName, void* data, uint64_t sizeInBytes);
+
+    // CPU time of every iteration of the dispatch commands (and batches of them) run so far, in milliseconds.
+    const StreamingStats& GetIterationStats() const { return m_iterationStats; }
+
 private:
+    void CreateResource(const Model::ResourceDesc& desc);
+    bool CreateMissingResource(const std::string& resourceName);
+    void CreateDispatchables(gsl::span<const Model::DispatchableDesc* const> descs);
+
+    // Creates the resources and dispatchables used by commands [begin, end) that don't exist yet (--lazy_init).
+    void CreateMissingObjects(uint32_t begin, uint32_t end);
+
+    // Finds the last command that uses each resource and dispatchable, and releases them once commands [begin, end) 
+    // have run if one of those is their last (--release_resources). Released objects are recreated if used again.
+    void PlanReleases();
+    void ReleaseUnusedObjects(uint32_t begin, uint32_t end);
+
+    // Places resources whose lifetimes (first to last command that uses them) don't overlap in the same memory
+    // (--alias_resources), and records the aliasing barriers and initial uploads when their lifetimes begin.
+    void PlanAliasing();
+    void BeginAliasedLifetimes(uint32_t begin, uint32_t end);
+
+    // Prepares the objects used by commands [begin, end) before they run.
+    void PrepareCommands(uint32_t begin, uint32_t end);
+
+    void LogMemoryUsage();
+
     Dispatchable::Bindings ResolveBindings(const Model::Bindings& modelBindings);
+    uint32_t FindDispatchSequenceEnd(uint32_t begin);
+    void RunDispatchGraph(uint32_t begin, uint32_t end);
+    void RunDispatchBatch(uint32_t begin, uint32_t end);
+    void RunOpenLoopDispatch(const Model::DispatchCommand& command, Dispatchable& dispatchable, const Dispatchable::Bindings& bindings);
+    void RunBindingShapeSweep(const Model::DispatchCommand& command, Dispatchable& dispatchable, const Dispatchable::Bindings& bindings);
+    uint32_t FindOutputSequenceEnd(uint32_t begin);
+    void RunOutputBatch(uint32_t begin, uint32_t end);
+    ID3D12Resource* FindOutputResource(const std::string& resourceName);
+    ID3D12Resource* FindHostAccessibleResource(const std::string& resourceName);
+    std::vector<std::byte> Download(const std::string& resourceName, ID3D12Resource* resource);
+    void FlushFileWrites();
+    std::vector<D3D12_RESOURCE_BARRIER> PlanRepeatDispatchBarriers(const std::string& dispatchableName, const Dispatchable& dispatchable, const Dispatchable::Bindings& bindings);
 
 private:
     Model& m_model;
@@ -26,4 +79,43 @@ private:
     Dispatchable::DeferredBindings m_deferredBinding;
     Microsoft::WRL::ComPtr<IDxDispatchLogger> m_logger;
     UINT32 m_nextId = 0;
+
+    // Most recent Bind() time of each dispatchable that missed its binding cache. Used to estimate time saved by cache hits.
+    std::unordered_map<std::string, double> m_uncachedBindTimes;
+
+    // Threads for recording dispatch batches (--record_threads), created on first use.
+    std::unique_ptr<ThreadPool> m_recordThreadPool;
+
+    // Contents of the resources read back together for a run of consecutive output commands, keyed by resource name.
+    std::unordered_map<std::string, std::shared_future<std::vector<std::byte>>> m_pendingReadbacks;
+
+    // Writes output files off the dispatch thread. Names of the resources written since the last flush, in order.
+    std::unique_ptr<BackgroundFileWriter> m_fileWriter;
+    std::vector<std::string> m_queuedFileWriteResources;
+
+    StreamingStats m_iterationStats;
+
+    // Resources and dispatchables to release after each command (empty unless --release_resources is set).
+    struct Releases
+    {
+        std::vector<std::string> resources;
+        std::vector<std::string> dispatchables;
+    };
+    std::vector<Releases> m_releasesAfterCommand;
+
+    // Resources read or written through the host access methods, which are never released or aliased.
+    std::unordered_set<std::string> m_hostAccessedResources;
+
+    // Resources placed in the aliasing heap (empty unless --alias_resources is set). A resource accessed by the host
+    // is replaced with its own buffer, but the placed buffer stays alive.
+    struct AliasedResource
+    {
+        Microsoft::WRL::ComPtr<ID3D12Resource> resource;
+        const Model::ResourceDesc* desc;
+        bool hostAccessed;
+    };
+    std::unordered_map<std::string, AliasedResource> m_aliasedResources;
+    std::vector<std::vector<std::string>> m_aliasingBeginsBeforeCommand;
+    Microsoft::WRL::ComPtr<ID3D12Heap> m_aliasingHeap;
+    uint64_t m_hostModelSizeInBytes = 0;
 };
\ No newline at end of file
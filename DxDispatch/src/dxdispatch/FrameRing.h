@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+// Minimal view of a command queue's fence timeline. Device implements this on top of an ID3D12Fence,
+// and unit tests implement it with a fake queue so that submission logic can be tested without a GPU.
+class IFenceTimeline
+{
+public:
+    virtual ~IFenceTimeline() = default;
+
+    // Enqueues a signal of the next fence value on the queue and returns the signaled value.
+    virtual uint64_t Signal() = 0;
+
+    // Returns the most recent fence value reached by the queue.
+    virtual uint64_t GetCompletedValue() = 0;
+
+    // Blocks the calling thread until the queue reaches the given fence value.
+    virtual void WaitForValue(uint64_t value) = 0;
+};
+
+// Tracks a fixed-size ring of "frames", where each frame owns the resources needed to record one submission
+// (e.g. a command allocator). A frame can be recycled only after the GPU has finished its last submission,
+// so up to FrameCount() submissions may be in flight while the CPU records the next one. A ring with a
+// single frame degenerates into submit-and-wait.
+class FrameRing
+{
+public:
+    FrameRing(IFenceTimeline* timeline, uint32_t frameCount) :
+        m_timeline(timeline),
+        m_frameFenceValues(frameCount, 0)
+    {
+        if (frameCount == 0)
+        {
+            throw std::invalid_argument("FrameRing requires at least one frame.");
+        }
+    }
+
+    uint32_t FrameCount() const { return static_cast<uint32_t>(m_frameFenceValues.size()); }
+    uint32_t CurrentFrameIndex() const { return m_currentFrameIndex; }
+
+    // Number of times AdvanceFrame() had to block on the GPU before a frame could be recycled.
+    uint64_t StallCount() const { return m_stallCount; }
+
+    // Associates the current frame with a new fence signal. Call after the frame's work is submitted.
+    uint64_t SubmitCurrentFrame()
+    {
+        m_frameFenceValues[m_currentFrameIndex] = m_timeline->Signal();
+        return m_frameFenceValues[m_currentFrameIndex];
+    }
+
+    // Moves to the next frame in the ring, blocking until the GPU has finished with that frame's previous
+    // submission (if any). Returns the index of the new current frame, whose resources may now be reset.
+    uint32_t AdvanceFrame()
+    {
+        m_currentFrameIndex = (m_currentFrameIndex + 1) % FrameCount();
+        if (WaitForFrame(m_currentFrameIndex))
+        {
+            m_stallCount++;
+        }
+        return m_currentFrameIndex;
+    }
+
+    // Blocks until every submitted frame has completed on the GPU.
+    void WaitForAllFrames()
+    {
+        for (uint32_t i = 0; i < FrameCount(); i++)
+        {
+            WaitForFrame(i);
+        }
+    }
+
+    // Returns the number of submitted frames that the GPU has not yet completed.
+    uint32_t FramesInFlight()
+    {
+        uint64_t completedValue = m_timeline->GetCompletedValue();
+        uint32_t count = 0;
+        for (auto fenceValue : m_frameFenceValues)
+        {
+            if (fenceValue > completedValue)
+            {
+                count++;
+            }
+        }
+        return count;
+    }
+
+private:
+    // Returns true if the CPU had to wait.
+    bool WaitForFrame(uint32_t frameIndex)
+    {
+        uint64_t fenceValue = m_frameFenceValues[frameIndex];
+        if (fenceValue > m_timeline->GetCompletedValue())
+        {
+            m_timeline->WaitForValue(fenceValue);
+            return true;
+        }
+        return false;
+    }
+
+private:
+    IFenceTimeline* m_timeline;
+    std::vector<uint64_t> m_frameFenceValues;
+    uint32_t m_currentFrameIndex = 0;
+    uint64_t m_stallCount = 0;
+};
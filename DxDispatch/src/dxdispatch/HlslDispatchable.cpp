@@ -8,9 +8,62 @@
 
 using Microsoft::WRL::ComPtr;
 
+static SharedCache<HlslDispatchable::CompiledPipeline>& GetPipelineCache()
+{
+    static SharedCache<HlslDispatchable::CompiledPipeline> cache;
+    return cache;
+}
+
+SharedCacheStats HlslDispatchable::GetPipelineCacheStats()
+{
+    return GetPipelineCache().GetStats();
+}
+
+// Forwards to another include handler, and records the files it loads so that their contents can be checked before
+// a cached shader is used.
+class RecordingIncludeHandler : public Microsoft::WRL::Base<IDxcIncludeHandler>
+{
+public:
+    explicit RecordingIncludeHandler(IDxcIncludeHandler* includeHandler) : m_includeHandler(includeHandler) {}
+
+    HRESULT STDMETHODCALLTYPE LoadSource(_In_z_ LPCWSTR filename, _COM_Outptr_result_maybenull_ IDxcBlob** includeSource) final
+    {
+        HRESULT hr = m_includeHandler->LoadSource(filename, includeSource);
+        if (SUCCEEDED(hr) && *includeSource)
+        {
+            try
+            {
+                m_includes.push_back({
+                    std::wstring_convert<std::codecvt_utf8<wchar_t>>().to_bytes(filename),
+                    DiskCache::Hash((*includeSource)->GetBufferPointer(), (*includeSource)->GetBufferSize()) });
+            }
+            CATCH_RETURN();
+        }
+        return hr;
+    }
+
+    const std::vector<HlslDispatchable::IncludedFile>& Includes() const { return m_includes; }
+
+private:
+    ComPtr<IDxcIncludeHandler> m_includeHandler;
+    std::vector<HlslDispatchable::IncludedFile> m_includes;
+};
+
 HlslDispatchable::HlslDispatchable(std::shared_ptr<Device> device, const Model::HlslDispatchableDesc& desc, const CommandLineArgs& args, IDxDispatchLogger* logger)
     : m_device(device), m_desc(desc), m_forceDisablePrecompiledShadersOnXbox(args.ForceDisablePrecompiledShadersOnXbox()), m_printHlslDisassembly(args.PrintHlslDisassembly()), m_logger(logger)
 {
+    if (args.ShaderCacheDirectory())
+    {
+        m_shaderCache.emplace(*args.ShaderCacheDirectory(), args.ShaderCacheSizeInBytes());
+    }
+}
+
+HlslDispatchable::~HlslDispatchable()
+{
+    if (m_descriptors.count > 0)
+    {
+        m_device->FreePersistentDescriptors(m_descriptors);
+    }
 }
 
 HlslDispatchable::BufferViewType GetViewType(const D3D12_SHADER_INPUT_BIND_DESC& desc)
@@ -128,20 +181,20 @@ BindingData ReflectBindingData(gsl::span<D3D12_SHADER_INPUT_BIND_DESC> shaderInp
     return std::make_tuple(descriptorRanges, bindPoints);
 }
 
-void HlslDispatchable::CreateRootSignatureAndBindingMap()
+ComPtr<ID3DBlob> HlslDispatchable::SerializeRootSignatureAndBindingMap(ID3D12ShaderReflection* shaderReflection, CompiledPipeline& pipeline)
 {
     D3D12_SHADER_DESC shaderDesc = {};
-    THROW_IF_FAILED(m_shaderReflection->GetDesc(&shaderDesc));
+    THROW_IF_FAILED(shaderReflection->GetDesc(&shaderDesc));
     
     std::vector<D3D12_SHADER_INPUT_BIND_DESC> shaderInputDescs(shaderDesc.BoundResources);
     for (uint32_t resourceIndex = 0; resourceIndex < shaderDesc.BoundResources; resourceIndex++)
     {
-        THROW_IF_FAILED(m_shaderReflection->GetResourceBindingDesc(resourceIndex, &shaderInputDescs[resourceIndex]));
+        THROW_IF_FAILED(shaderReflection->GetResourceBindingDesc(resourceIndex, &shaderInputDescs[resourceIndex]));
     }
 
     std::vector<D3D12_ROOT_PARAMETER1> rootParameters;
     auto [descriptorRanges, bindPoints] = ReflectBindingData(shaderInputDescs);
-    m_bindPoints = bindPoints;
+    pipeline.bindPoints = bindPoints;
 
     if (!descriptorRanges.empty())
     {
@@ -173,11 +226,7 @@ void HlslDispatchable::CreateRootSignatureAndBindingMap()
         THROW_HR(hr);
     }
 
-    THROW_IF_FAILED(m_device->D3D()->CreateRootSignature(
-        0, 
-        rootSignatureBlob->GetBufferPointer(), 
-        rootSignatureBlob->GetBufferSize(), 
-        IID_GRAPHICS_PPV_ARGS(m_rootSignature.ReleaseAndGetAddressOf())));
+    return rootSignatureBlob;
 }
 
 void HlslDispatchable::CompileWithDxc()
@@ -187,8 +236,14 @@ void HlslDispatchable::CompileWithDxc()
         throw std::runtime_error("DXC is not available for this platform");
     }
 
+    // Dispatchables are compiled concurrently, and DXC compilers must not be used by multiple threads at once, so
+    // each dispatchable uses its own instances instead of the device's.
+    THROW_IF_FAILED(DxcCreateInstance(CLSID_DxcUtils, IID_PPV_ARGS(&m_dxcUtils)));
+    THROW_IF_FAILED(m_dxcUtils->CreateDefaultIncludeHandler(&m_dxcIncludeHandler));
+    THROW_IF_FAILED(DxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(&m_dxcCompiler)));
+
     ComPtr<IDxcBlobEncoding> source;
-    THROW_IF_FAILED(m_device->GetDxcUtils()->LoadFile(
+    THROW_IF_FAILED(m_dxcUtils->LoadFile(
         m_desc.sourcePath.c_str(),
         nullptr, 
         &source));
@@ -218,12 +273,120 @@ void HlslDispatchable::CompileWithDxc()
         lpcwstrArgs[i] = compilerArgs[i].data();
     }
 
+    // The key covers the source and everything it's compiled with, except for the contents of included files.
+    std::string key = fmt::format("{}:{}:", m_device->GetD3DCacheKey(), m_desc.sourcePath.string());
+    for (auto& arg : compilerArgs)
+    {
+        key.append(reinterpret_cast<const char*>(arg.c_str()), (arg.size() + 1) * sizeof(wchar_t));
+    }
+    key.append(static_cast<const char*>(sourceBuffer.Ptr), sourceBuffer.Size);
+
+    m_pipeline = GetPipelineCache().GetOrCreate(key, [&] { return CompilePipeline(sourceBuffer, lpcwstrArgs); });
+
+    // Pipeline states can only be used with the D3D device that created them, which is the same for every Device on
+    // the adapter unless it was recreated while the shared pipeline was still in use.
+    ComPtr<ID3D12Device9> pipelineDevice;
+    THROW_IF_FAILED(m_pipeline->pipelineState->GetDevice(IID_GRAPHICS_PPV_ARGS(pipelineDevice.GetAddressOf())));
+    if (pipelineDevice.Get() != m_device->D3D())
+    {
+        m_pipeline = std::make_shared<const CompiledPipeline>(CompilePipeline(sourceBuffer, lpcwstrArgs));
+    }
+    m_rootSignature = m_pipeline->rootSignature;
+    m_pipelineState = m_pipeline->pipelineState;
+    m_bindPoints = m_pipeline->bindPoints;
+}
+
+void HlslDispatchable::Initialize()
+{
+    if (m_printHlslDisassembly)
+    {
+        DxcBuffer bytecodeBuffer;
+        bytecodeBuffer.Ptr = m_pipeline->shaderBlob->GetBufferPointer();
+        bytecodeBuffer.Size = m_pipeline->shaderBlob->GetBufferSize();
+        bytecodeBuffer.Encoding = DXC_CP_ACP;
+
+        ComPtr<IDxcResult> result;
+        THROW_IF_FAILED(m_dxcCompiler->Disassemble(
+            &bytecodeBuffer, 
+            IID_PPV_ARGS(&result)
+        ));
+
+        ComPtr<IDxcBlob> disassemblyText;
+        THROW_IF_FAILED(result->GetOutput(
+            DXC_OUT_DISASSEMBLY, 
+            IID_PPV_ARGS(&disassemblyText), 
+            nullptr
+        ));
+
+        m_logger->LogInfo("---------------------------------------------------------");
+        m_logger->LogInfo(static_cast<LPCSTR>(disassemblyText->GetBufferPointer()));
+        m_logger->LogInfo("---------------------------------------------------------");
+    }
+
+    if (!m_bindPoints.empty())
+    {
+        m_descriptors = m_device->AllocatePersistentDescriptors(static_cast<uint32_t>(m_bindPoints.size()));
+    }
+
+    m_dxcCompiler = nullptr;
+    m_dxcIncludeHandler = nullptr;
+    m_dxcUtils = nullptr;
+}
+
+HlslDispatchable::CompiledPipeline HlslDispatchable::CompilePipeline(const DxcBuffer& sourceBuffer, std::vector<LPCWSTR>& args)
+{
+    CompiledPipeline pipeline;
+    std::vector<std::byte> rootSignature;
+
+    std::string shaderCacheKey;
+    if (m_shaderCache)
+    {
+        shaderCacheKey = GetShaderCacheKey(sourceBuffer, args);
+        LoadFromShaderCache(shaderCacheKey, pipeline, rootSignature);
+    }
+
+    if (!pipeline.shaderBlob)
+    {
+        auto includeHandler = Microsoft::WRL::Make<RecordingIncludeHandler>(m_dxcIncludeHandler.Get());
+        auto rootSignatureBlob = CompileShader(sourceBuffer, args, includeHandler.Get(), pipeline);
+        auto rootSignatureBytes = static_cast<const std::byte*>(rootSignatureBlob->GetBufferPointer());
+        rootSignature.assign(rootSignatureBytes, rootSignatureBytes + rootSignatureBlob->GetBufferSize());
+
+        if (m_shaderCache)
+        {
+            StoreInShaderCache(shaderCacheKey, includeHandler->Includes(), pipeline, rootSignature);
+        }
+    }
+
+    THROW_IF_FAILED(m_device->D3D()->CreateRootSignature(
+        0, 
+        rootSignature.data(), 
+        rootSignature.size(), 
+        IID_GRAPHICS_PPV_ARGS(pipeline.rootSignature.ReleaseAndGetAddressOf())));
+
+    D3D12_COMPUTE_PIPELINE_STATE_DESC psoDesc = {};
+    psoDesc.pRootSignature = pipeline.rootSignature.Get();
+    psoDesc.CS.pShaderBytecode = pipeline.shaderBlob->GetBufferPointer();
+    psoDesc.CS.BytecodeLength = pipeline.shaderBlob->GetBufferSize();
+    THROW_IF_FAILED(m_device->D3D()->CreateComputePipelineState(
+        &psoDesc,
+        IID_GRAPHICS_PPV_ARGS(pipeline.pipelineState.ReleaseAndGetAddressOf())));
+
+    return pipeline;
+}
+
+ComPtr<ID3DBlob> HlslDispatchable::CompileShader(
+    const DxcBuffer& sourceBuffer, 
+    std::vector<LPCWSTR>& args, 
+    IDxcIncludeHandler* includeHandler, 
+    CompiledPipeline& pipeline)
+{
     ComPtr<IDxcResult> result;
-    THROW_IF_FAILED(m_device->GetDxcCompiler()->Compile(
+    THROW_IF_FAILED(m_dxcCompiler->Compile(
         &sourceBuffer, 
-        lpcwstrArgs.data(), 
-        static_cast<UINT32>(lpcwstrArgs.size()), 
-        m_device->GetDxcIncludeHandler(), 
+        args.data(), 
+        static_cast<UINT32>(args.size()), 
+        includeHandler, 
         IID_PPV_ARGS(&result)));
 
     ComPtr<IDxcBlobUtf8> errors;
@@ -241,10 +404,9 @@ void HlslDispatchable::CompileWithDxc()
         throw std::invalid_argument("Failed to compile.");
     }
 
-    ComPtr<IDxcBlob> shaderBlob;
     THROW_IF_FAILED(result->GetOutput(
         DXC_OUT_OBJECT, 
-        IID_PPV_ARGS(&shaderBlob), 
+        IID_PPV_ARGS(&pipeline.shaderBlob), 
         nullptr));
 
     ComPtr<IDxcBlob> reflectionBlob;
@@ -272,56 +434,135 @@ void HlslDispatchable::CompileWithDxc()
     reflectionBuffer.Size = reflectionBlob->GetBufferSize();
     reflectionBuffer.Encoding = DXC_CP_ACP;
 
-    THROW_IF_FAILED(m_device->GetDxcUtils()->CreateReflection(
+    ComPtr<ID3D12ShaderReflection> shaderReflection;
+    THROW_IF_FAILED(m_dxcUtils->CreateReflection(
         &reflectionBuffer, 
-        IID_PPV_ARGS(m_shaderReflection.ReleaseAndGetAddressOf())));
+        IID_PPV_ARGS(&shaderReflection)));
 
-    if (m_printHlslDisassembly)
+    return SerializeRootSignatureAndBindingMap(shaderReflection.Get(), pipeline);
+}
+
+// Shader cache keys cover everything a compiled shader depends on, except for included files: which files are
+// included is only known after compiling, so their names and content hashes are stored in the entry instead, and
+// an entry is only used if the files still have the same contents.
+std::string HlslDispatchable::GetShaderCacheKey(const DxcBuffer& sourceBuffer, const std::vector<LPCWSTR>& args)
+{
+    uint32_t dxcMajorVersion = 0;
+    uint32_t dxcMinorVersion = 0;
+    ComPtr<IDxcVersionInfo> versionInfo;
+    if (SUCCEEDED(m_dxcCompiler->QueryInterface(IID_PPV_ARGS(&versionInfo))))
     {
-        DxcBuffer bytecodeBuffer;
-        bytecodeBuffer.Ptr = shaderBlob->GetBufferPointer();
-        bytecodeBuffer.Size = shaderBlob->GetBufferSize();
-        bytecodeBuffer.Encoding = DXC_CP_ACP;
+        THROW_IF_FAILED(versionInfo->GetVersion(&dxcMajorVersion, &dxcMinorVersion));
+    }
 
-        ComPtr<IDxcResult> result;
-        THROW_IF_FAILED(m_device->GetDxcCompiler()->Disassemble(
-            &bytecodeBuffer, 
-            IID_PPV_ARGS(&result)
-        ));
+    std::string key = fmt::format("hlsl:dxc {}.{}:{}:", dxcMajorVersion, dxcMinorVersion, m_desc.sourcePath.string());
+    for (auto arg : args)
+    {
+        key.append(reinterpret_cast<const char*>(arg), (wcslen(arg) + 1) * sizeof(wchar_t));
+    }
+    key.append(static_cast<const char*>(sourceBuffer.Ptr), sourceBuffer.Size);
+    return key;
+}
 
-        ComPtr<IDxcBlob> disassemblyText;
-        THROW_IF_FAILED(result->GetOutput(
-            DXC_OUT_DISASSEMBLY, 
-            IID_PPV_ARGS(&disassemblyText), 
-            nullptr
-        ));
+// Returns the content hash of an included file, or nullopt if it can't be loaded anymore. The file is loaded by a new
+// include handler (of the same kind used to compile), so it's resolved the same way as when it was recorded.
+std::optional<uint64_t> HlslDispatchable::GetIncludeContentHash(const std::string& filename)
+{
+    ComPtr<IDxcIncludeHandler> includeHandler;
+    THROW_IF_FAILED(m_dxcUtils->CreateDefaultIncludeHandler(&includeHandler));
 
-        m_logger->LogInfo("---------------------------------------------------------");
-        m_logger->LogInfo(static_cast<LPCSTR>(disassemblyText->GetBufferPointer()));
-        m_logger->LogInfo("---------------------------------------------------------");
+    ComPtr<IDxcBlob> contents;
+    auto wideFilename = std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(filename);
+    if (FAILED(includeHandler->LoadSource(wideFilename.c_str(), &contents)) || !contents)
+    {
+        return std::nullopt;
     }
+    return DiskCache::Hash(contents->GetBufferPointer(), contents->GetBufferSize());
+}
 
-    CreateRootSignatureAndBindingMap();
+bool HlslDispatchable::LoadFromShaderCache(const std::string& key, CompiledPipeline& pipeline, std::vector<std::byte>& rootSignature)
+{
+    auto value = m_shaderCache->Load(key);
+    if (!value)
+    {
+        return false;
+    }
 
-    D3D12_COMPUTE_PIPELINE_STATE_DESC psoDesc = {};
-    psoDesc.pRootSignature = m_rootSignature.Get();
-    psoDesc.CS.pShaderBytecode = shaderBlob->GetBufferPointer();
-    psoDesc.CS.BytecodeLength = shaderBlob->GetBufferSize();
-    THROW_IF_FAILED(m_device->D3D()->CreateComputePipelineState(
-        &psoDesc,
-        IID_GRAPHICS_PPV_ARGS(m_pipelineState.ReleaseAndGetAddressOf())));
-
-    ComPtr<ID3D12DescriptorHeap> descriptorHeap;
-    D3D12_DESCRIPTOR_HEAP_DESC descriptorHeapDesc = {};
-    descriptorHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-    descriptorHeapDesc.NumDescriptors = static_cast<uint32_t>(m_bindPoints.size());
-    descriptorHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-    THROW_IF_FAILED(m_device->D3D()->CreateDescriptorHeap(
-        &descriptorHeapDesc, 
-        IID_GRAPHICS_PPV_ARGS(m_descriptorHeap.ReleaseAndGetAddressOf())));
+    try
+    {
+        CacheEntryReader reader(*value);
+        auto includeCount = reader.Read<uint64_t>();
+        for (uint64_t i = 0; i < includeCount; i++)
+        {
+            auto filename = reader.ReadString();
+            auto contentHash = reader.Read<uint64_t>();
+            if (GetIncludeContentHash(filename) != contentHash)
+            {
+                return false;
+            }
+        }
+
+        auto shader = reader.ReadArray();
+        auto shaderRootSignature = reader.ReadArray();
+        std::unordered_map<std::string, BindPoint> bindPoints;
+        auto bindPointCount = reader.Read<uint64_t>();
+        for (uint64_t i = 0; i < bindPointCount; i++)
+        {
+            auto name = reader.ReadString();
+            bindPoints[name] = reader.Read<BindPoint>();
+        }
+
+        ComPtr<IDxcBlobEncoding> shaderBlob;
+        THROW_IF_FAILED(m_dxcUtils->CreateBlob(
+            shader.data(), 
+            static_cast<UINT32>(shader.size()), 
+            DXC_CP_ACP, 
+            &shaderBlob));
+
+        pipeline.shaderBlob = shaderBlob;
+        pipeline.bindPoints = std::move(bindPoints);
+        rootSignature = std::move(shaderRootSignature);
+        return true;
+    }
+    catch (const std::runtime_error&)
+    {
+        return false;
+    }
 }
 
-void HlslDispatchable::Initialize()
+void HlslDispatchable::StoreInShaderCache(
+    const std::string& key, 
+    const std::vector<IncludedFile>& includes, 
+    const CompiledPipeline& pipeline, 
+    const std::vector<std::byte>& rootSignature)
+{
+    CacheEntryWriter writer;
+    writer.Write<uint64_t>(includes.size());
+    for (auto& include : includes)
+    {
+        writer.WriteString(include.filename);
+        writer.Write(include.contentHash);
+    }
+
+    writer.WriteArray(pipeline.shaderBlob->GetBufferPointer(), pipeline.shaderBlob->GetBufferSize());
+    writer.WriteArray(rootSignature.data(), rootSignature.size());
+    writer.Write<uint64_t>(pipeline.bindPoints.size());
+    for (auto& [name, bindPoint] : pipeline.bindPoints)
+    {
+        writer.WriteString(name);
+        writer.Write(bindPoint);
+    }
+
+    if (!m_shaderCache->Store(key, writer.Data()))
+    {
+        m_logger->LogWarning(fmt::format(
+            "Could not write '{}' to the shader cache in '{}'", 
+            m_desc.sourcePath.string(), 
+            m_shaderCache->Directory().string()).c_str());
+    }
+}
+
+void HlslDispatchable::Compile()
 {
     if (m_desc.compiler == Model::HlslDispatchableDesc::Compiler::DXC)
     {
@@ -333,9 +574,9 @@ void HlslDispatchable::Initialize()
     }
 }
 
-void HlslDispatchable::Bind(const Bindings& bindings, uint32_t iteration)
+void HlslDispatchable::WriteDescriptors(const Bindings& bindings)
 {
-    uint32_t descriptorIncrementSize = m_device->D3D()->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    uint32_t descriptorIncrementSize = m_device->GetDescriptorIncrementSize();
 
     for (auto& binding : bindings)
     {
@@ -361,7 +602,7 @@ void HlslDispatchable::Bind(const Bindings& bindings, uint32_t iteration)
         auto& bindPoint = bindPointIterator->second;
 
         CD3DX12_CPU_DESCRIPTOR_HANDLE cpuHandle{
-            m_descriptorHeap->GetCPUDescriptorHandleForHeapStart(), 
+            m_descriptors.cpuHandle, 
             static_cast<int>(bindPoint.offsetInDescriptorsFromTableStart), 
             descriptorIncrementSize
         };
@@ -469,15 +710,70 @@ void HlslDispatchable::Bind(const Bindings& bindings, uint32_t iteration)
         }
     }
 
-    m_device->GetCommandList()->SetComputeRootSignature(m_rootSignature.Get());
-    m_device->GetCommandList()->SetPipelineState(m_pipelineState.Get());
-    ID3D12DescriptorHeap* descriptorHeaps[] = { m_descriptorHeap.Get() };
-    m_device->GetCommandList()->SetDescriptorHeaps(ARRAYSIZE(descriptorHeaps), descriptorHeaps);
-    m_device->GetCommandList()->SetComputeRootDescriptorTable(0, m_descriptorHeap->GetGPUDescriptorHandleForHeapStart());
+}
+
+void HlslDispatchable::Bind(const Bindings& bindings, uint32_t iteration)
+{
+    // The bindings of a dispatch command are the same for every iteration, and with multiple frames in flight 
+    // the descriptors may still be referenced by earlier iterations executing on the GPU.
+    if (iteration == 0)
+    {
+        WriteDescriptors(bindings);
+    }
+}
+
+std::vector<Dispatchable::ResourceAccess> HlslDispatchable::GetResourceAccesses(const Bindings& bindings) const
+{
+    std::vector<ResourceAccess> accesses;
+
+    for (auto& binding : bindings)
+    {
+        auto bindPointIterator = m_bindPoints.find(binding.first);
+        if (bindPointIterator == m_bindPoints.end())
+        {
+            continue;
+        }
+
+        // Reflection can't tell whether a UAV is actually written, so all UAVs (and their counters) are writes.
+        bool write = bindPointIterator->second.descriptorType == D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
+
+        for (auto& source : binding.second)
+        {
+            if (!source.resource)
+            {
+                continue;
+            }
+
+            auto& resourceName = source.resourceDesc ? source.resourceDesc->name : binding.first;
+            accesses.push_back({ source.resource, resourceName, write });
+            if (write && source.counterResource)
+            {
+                accesses.push_back({ source.counterResource, fmt::format("{} (counter)", resourceName), true });
+            }
+        }
+    }
+
+    return accesses;
 }
 
 void HlslDispatchable::Dispatch(const Model::DispatchCommand& args, uint32_t iteration, DeferredBindings& deferredBinings)
 {
+    // Root state is set when recording (rather than in Bind) so it lands in whichever command list the dispatch 
+    // is recorded into.
+    auto commandList = m_device->GetCommandList();
+    commandList->SetComputeRootSignature(m_rootSignature.Get());
+    commandList->SetPipelineState(m_pipelineState.Get());
+    commandList->SetComputeRootDescriptorTable(0, m_descriptors.gpuHandle);
+
     m_device->RecordDispatch(args.dispatchableName.c_str(), args.threadGroupCount[0], args.threadGroupCount[1], args.threadGroupCount[2]);
-    m_device->ExecuteCommandListAndWait();
+    m_device->ExecuteCommandListAndAdvanceFrame();
+}
+
+void HlslDispatchable::RecordDispatch(const Model::DispatchCommand& args, const Device::RecordingTarget& target)
+{
+    target.commandList->SetComputeRootSignature(m_rootSignature.Get());
+    target.commandList->SetPipelineState(m_pipelineState.Get());
+    target.commandList->SetComputeRootDescriptorTable(0, m_descriptors.gpuHandle);
+
+    m_device->RecordDispatch(target, args.dispatchableName.c_str(), args.threadGroupCount[0], args.threadGroupCount[1], args.threadGroupCount[2]);
 }
\ No newline at end of file
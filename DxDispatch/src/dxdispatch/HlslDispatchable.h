@@ -1,15 +1,23 @@
 #pragma once
 
 #include "CommandLineArgs.h"
+#include "DiskCache.h"
+#include "SharedCache.h"
 
 class HlslDispatchable : public Dispatchable
 {
 public:
     HlslDispatchable(std::shared_ptr<Device> device, const Model::HlslDispatchableDesc& desc, const CommandLineArgs& args, IDxDispatchLogger* logger);
 
+    ~HlslDispatchable();
+
+    void Compile() final;
     void Initialize() final;
     void Bind(const Bindings& bindings, uint32_t iteration) final;
     void Dispatch(const Model::DispatchCommand& args, uint32_t iteration, DeferredBindings& deferredBinings) final;
+    bool SupportsRecordingTargets() const final { return true; }
+    void RecordDispatch(const Model::DispatchCommand& args, const Device::RecordingTarget& target) final;
+    std::vector<ResourceAccess> GetResourceAccesses(const Bindings& bindings) const final;
 
     enum class BufferViewType
     {
@@ -26,19 +34,57 @@ public:
         uint32_t structureByteStride;
     };
 
+    // Compiled shaders and their pipeline states are shared by all dispatchables (of any IDxDispatch instance in the
+    // process) that compile the same source with the same arguments on the same adapter and D3D feature level.
+    static SharedCacheStats GetPipelineCacheStats();
+
+    struct CompiledPipeline
+    {
+        Microsoft::WRL::ComPtr<IDxcBlob> shaderBlob;
+        Microsoft::WRL::ComPtr<ID3D12RootSignature> rootSignature;
+        Microsoft::WRL::ComPtr<ID3D12PipelineState> pipelineState;
+        std::unordered_map<std::string, BindPoint> bindPoints;
+    };
+
+    struct IncludedFile
+    {
+        std::string filename;
+        uint64_t contentHash;
+    };
+
 private:
     void CompileWithDxc();
-    void CreateRootSignatureAndBindingMap();
+    CompiledPipeline CompilePipeline(const DxcBuffer& sourceBuffer, std::vector<LPCWSTR>& args);
+    Microsoft::WRL::ComPtr<ID3DBlob> CompileShader(
+        const DxcBuffer& sourceBuffer, 
+        std::vector<LPCWSTR>& args, 
+        IDxcIncludeHandler* includeHandler, 
+        CompiledPipeline& pipeline);
+    Microsoft::WRL::ComPtr<ID3DBlob> SerializeRootSignatureAndBindingMap(ID3D12ShaderReflection* shaderReflection, CompiledPipeline& pipeline);
+
+    std::string GetShaderCacheKey(const DxcBuffer& sourceBuffer, const std::vector<LPCWSTR>& args);
+    std::optional<uint64_t> GetIncludeContentHash(const std::string& filename);
+    bool LoadFromShaderCache(const std::string& key, CompiledPipeline& pipeline, std::vector<std::byte>& rootSignature);
+    void StoreInShaderCache(
+        const std::string& key, 
+        const std::vector<IncludedFile>& includes, 
+        const CompiledPipeline& pipeline, 
+        const std::vector<std::byte>& rootSignature);
+    void WriteDescriptors(const Bindings& bindings);
 
 private:
     std::shared_ptr<Device> m_device;
     Model::HlslDispatchableDesc m_desc;
     bool m_forceDisablePrecompiledShadersOnXbox;
-    Microsoft::WRL::ComPtr<ID3D12ShaderReflection> m_shaderReflection;
+    std::shared_ptr<const CompiledPipeline> m_pipeline;
     Microsoft::WRL::ComPtr<ID3D12RootSignature> m_rootSignature;
     Microsoft::WRL::ComPtr<ID3D12PipelineState> m_pipelineState;
-    Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_descriptorHeap;
+    Device::DescriptorRange m_descriptors;
     std::unordered_map<std::string, BindPoint> m_bindPoints;
     bool m_printHlslDisassembly = false;
+    std::optional<DiskCache> m_shaderCache;
+    Microsoft::WRL::ComPtr<IDxcUtils> m_dxcUtils;
+    Microsoft::WRL::ComPtr<IDxcIncludeHandler> m_dxcIncludeHandler;
+    Microsoft::WRL::ComPtr<IDxcCompiler3> m_dxcCompiler;
     Microsoft::WRL::ComPtr<IDxDispatchLogger> m_logger;
 };
\ No newline at end of file
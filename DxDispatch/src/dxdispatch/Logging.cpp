@@ -47,3 +47,38 @@ void STDMETHODCALLTYPE  DxDispatchConsoleLogger::LogCommandCompleted(
     OutputDebugStringA(outputString.c_str());
 #endif
 }
+
+void DxDispatchPrefixedLogger::LogInfo(_In_ PCSTR msg)
+{
+    std::lock_guard<std::mutex> lock(*m_mutex);
+    m_logger->LogInfo((m_prefix + msg).c_str());
+}
+
+void DxDispatchPrefixedLogger::LogWarning(_In_ PCSTR msg)
+{
+    std::lock_guard<std::mutex> lock(*m_mutex);
+    m_logger->LogWarning((m_prefix + msg).c_str());
+}
+
+void DxDispatchPrefixedLogger::LogError(_In_ PCSTR msg)
+{
+    std::lock_guard<std::mutex> lock(*m_mutex);
+    m_logger->LogError((m_prefix + msg).c_str());
+}
+
+void STDMETHODCALLTYPE  DxDispatchPrefixedLogger::LogCommandStarted(
+    UINT32 index,
+    _In_ PCSTR jsonString)
+{
+    std::lock_guard<std::mutex> lock(*m_mutex);
+    m_logger->LogCommandStarted(index, (m_prefix + jsonString).c_str());
+}
+
+void STDMETHODCALLTYPE  DxDispatchPrefixedLogger::LogCommandCompleted(
+    UINT32 index,
+    HRESULT hr,
+    _In_opt_ PCSTR statusString)
+{
+    std::lock_guard<std::mutex> lock(*m_mutex);
+    m_logger->LogCommandCompleted(index, hr, (m_prefix + (statusString ? statusString : "")).c_str());
+}
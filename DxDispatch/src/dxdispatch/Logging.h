@@ -31,3 +31,41 @@ public:
 protected:
     virtual ~DxDispatchConsoleLogger() = default;
 };
+
+// Forwards messages to another logger with a prefix (e.g. the name of a concurrently running instance). Loggers that
+// share a mutex forward one message at a time, so messages of concurrent instances don't interleave.
+class DxDispatchPrefixedLogger : public Microsoft::WRL::Base<IDxDispatchLogger>
+{
+public:
+    DxDispatchPrefixedLogger(IDxDispatchLogger* logger, std::string prefix, std::shared_ptr<std::mutex> mutex) : 
+        m_logger(logger), m_prefix(std::move(prefix)), m_mutex(std::move(mutex))
+    {
+    }
+
+    // IDxDispatchLogger
+    void STDMETHODCALLTYPE  LogInfo(
+        _In_ PCSTR message) final;
+
+    void STDMETHODCALLTYPE  LogWarning(
+        _In_ PCSTR message) final;
+
+    void STDMETHODCALLTYPE  LogError(
+        _In_ PCSTR message) final;
+
+    void STDMETHODCALLTYPE  LogCommandStarted(
+        UINT32 index,
+        _In_ PCSTR jsonString)  final;
+
+    void STDMETHODCALLTYPE  LogCommandCompleted(
+        UINT32 index,
+        HRESULT hr,
+        _In_opt_ PCSTR statusString) final;
+
+protected:
+    virtual ~DxDispatchPrefixedLogger() = default;
+
+private:
+    Microsoft::WRL::ComPtr<IDxDispatchLogger> m_logger;
+    std::string m_prefix;
+    std::shared_ptr<std::mutex> m_mutex;
+};
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+
+enum class MemoryCategory
+{
+    ModelResources,     // Buffers of the model's resources (and the constants of DML graphs).
+    DmlPersistent,      // Persistent resources of DML operators.
+    DmlTemporary,       // Transient pool for temporary resources of DML operators.
+    UploadStaging,      // Staging ring for uploads.
+    Readback,           // Readback buffers for downloads and timestamps.
+    DescriptorHeaps,    // Descriptor heaps.
+    OnnxBindings,       // Buffers allocated for ONNX outputs that aren't bound to the model's resources.
+    HostModel,          // Host memory of the parsed model (e.g. initial values).
+    Count
+};
+
+inline const char* GetMemoryCategoryName(MemoryCategory category)
+{
+    switch (category)
+    {
+    case MemoryCategory::ModelResources: return "model_resources";
+    case MemoryCategory::DmlPersistent: return "dml_persistent";
+    case MemoryCategory::DmlTemporary: return "dml_temporary";
+    case MemoryCategory::UploadStaging: return "upload_staging";
+    case MemoryCategory::Readback: return "readback";
+    case MemoryCategory::DescriptorHeaps: return "descriptor_heaps";
+    case MemoryCategory::OnnxBindings: return "onnx_bindings";
+    case MemoryCategory::HostModel: return "host_model";
+    default: return "unknown";
+    }
+}
+
+// Tracks the live and peak (high-water mark) bytes of allocations in each category, and of all categories together.
+// The total peak is the largest sum of live bytes at any one time, which may be less than the sum of the categories'
+// peaks. Thread safe.
+class MemoryTracker
+{
+public:
+    struct Usage
+    {
+        uint64_t liveInBytes = 0;
+        uint64_t peakInBytes = 0;
+        uint64_t allocationCount = 0;  // Number of allocations made, including freed ones.
+    };
+
+    void Allocate(MemoryCategory category, uint64_t sizeInBytes)
+    {
+        std::scoped_lock lock(m_mutex);
+        auto& usage = m_usages[static_cast<size_t>(category)];
+        usage.liveInBytes += sizeInBytes;
+        usage.peakInBytes = std::max(usage.peakInBytes, usage.liveInBytes);
+        usage.allocationCount++;
+
+        m_total.liveInBytes += sizeInBytes;
+        m_total.peakInBytes = std::max(m_total.peakInBytes, m_total.liveInBytes);
+        m_total.allocationCount++;
+    }
+
+    // Frees are made by destructors, so freeing more bytes than are live in the category doesn't throw: it asserts,
+    // and the category's live bytes are clamped to 0.
+    void Free(MemoryCategory category, uint64_t sizeInBytes)
+    {
+        std::scoped_lock lock(m_mutex);
+        auto& usage = m_usages[static_cast<size_t>(category)];
+        assert(sizeInBytes <= usage.liveInBytes && "MemoryTracker freed more bytes than are live in the category.");
+        sizeInBytes = std::min(sizeInBytes, usage.liveInBytes);
+        usage.liveInBytes -= sizeInBytes;
+        m_total.liveInBytes -= sizeInBytes;
+    }
+
+    Usage GetUsage(MemoryCategory category) const
+    {
+        std::scoped_lock lock(m_mutex);
+        return m_usages[static_cast<size_t>(category)];
+    }
+
+    Usage GetTotalUsage() const
+    {
+        std::scoped_lock lock(m_mutex);
+        return m_total;
+    }
+
+    // Writes the usage as a JSON object, e.g. {"total": {"live_bytes": 0, "peak_bytes": 4096, ...}, "readback": ...}.
+    void WriteJson(std::ostream& stream) const
+    {
+        std::scoped_lock lock(m_mutex);
+        auto WriteUsage = [&](const char* name, const Usage& usage)
+        {
+            stream << "\"" << name << "\": {\"live_bytes\": " << usage.liveInBytes
+                << ", \"peak_bytes\": " << usage.peakInBytes
+                << ", \"allocations\": " << usage.allocationCount << "}";
+        };
+
+        stream << "{";
+        WriteUsage("total", m_total);
+        for (size_t i = 0; i < m_usages.size(); i++)
+        {
+            stream << ", ";
+            WriteUsage(GetMemoryCategoryName(static_cast<MemoryCategory>(i)), m_usages[i]);
+        }
+        stream << "}";
+    }
+
+private:
+    mutable std::mutex m_mutex;
+    std::array<Usage, static_cast<size_t>(MemoryCategory::Count)> m_usages;
+    Usage m_total;
+};
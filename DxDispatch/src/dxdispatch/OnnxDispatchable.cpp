@@ -192,11 +192,22 @@ OnnxDispatchable::OnnxDispatchable(
     const Model::OnnxDispatchableDesc& desc,
     const CommandLineArgs& args,
     IDxDispatchLogger* logger
-    ) : m_device(device), m_desc(desc), m_args(args), m_logger(logger)
+    ) : m_device(device), m_desc(desc), m_args(args), m_bindingShapes(args.GetOnnxBindingShapes()), m_logger(logger)
 {
 }
 
-void OnnxDispatchable::Initialize()
+void OnnxDispatchable::SetBindingShapes(const std::unordered_map<std::string, std::vector<int64_t>>& shapes)
+{
+    m_bindingShapes = m_args.GetOnnxBindingShapes();
+    for (auto& [tensorName, shape] : shapes)
+    {
+        m_bindingShapes[tensorName] = shape;
+    }
+}
+
+// Creating the session optimizes the model and uploads its initializers with the DML execution provider's own command
+// lists, so all of the work is done while compiling.
+void OnnxDispatchable::Compile()
 {
     const OrtApi& ortApi = Ort::GetApi();
     Ort::ThrowOnError(ortApi.GetExecutionProviderApi("DML", ORT_API_VERSION, reinterpret_cast<const void**>(&m_ortDmlApi)));
@@ -267,6 +278,41 @@ void OnnxDispatchable::Initialize()
 
     m_session = Ort::Session(*m_environment, m_desc.sourcePath.wstring().c_str(), sessionOptions);
     m_ioBindings = Ort::IoBinding::IoBinding(*m_session);
+    m_ioBindingsCurrent = false;
+    m_boundValues.Clear();
+
+    // The memory info and tensor types never change for a session, so they aren't queried again by each Bind().
+    m_cpuMemoryInformation = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+    m_dmlMemoryInformation = Ort::MemoryInfo("DML", OrtAllocatorType::OrtDeviceAllocator, 0, OrtMemType::OrtMemTypeDefault);
+
+    m_tensorInfos.clear();
+    for (int bindingPass = 0; bindingPass < 2; ++bindingPass)
+    {
+        const bool isInputTensor = (bindingPass == 0);
+        const size_t tensorCount = isInputTensor ? m_session->GetInputCount() : m_session->GetOutputCount();
+
+        for (size_t tensorIndex = 0; tensorIndex < tensorCount; ++tensorIndex)
+        {
+            TensorInfo tensorInfo = {};
+            tensorInfo.name = GetTensorName(tensorIndex, *m_session, isInputTensor);
+            tensorInfo.isInput = isInputTensor;
+
+            Ort::TypeInfo typeInfo = isInputTensor ? m_session->GetInputTypeInfo(tensorIndex) : m_session->GetOutputTypeInfo(tensorIndex);
+            tensorInfo.isTensor = typeInfo.GetONNXType() == ONNXType::ONNX_TYPE_TENSOR;
+            if (tensorInfo.isTensor)
+            {
+                auto shapeInfo = typeInfo.GetTensorTypeAndShapeInfo();
+                tensorInfo.dataType = shapeInfo.GetElementType();
+                tensorInfo.shape = shapeInfo.GetShape();
+            }
+
+            m_tensorInfos.emplace_back(std::move(tensorInfo));
+        }
+    }
+}
+
+void OnnxDispatchable::Initialize()
+{
 }
 
 void OnnxDispatchable::Bind(const Bindings& jsonBindings, uint32_t iteration)
@@ -282,120 +328,119 @@ void OnnxDispatchable::Bind(const Bindings& jsonBindings, uint32_t iteration)
     // 2. Be strict when using explicit JSON bindings (fail if the binding doesn't make sense).
     // While it may be possible to ignore an invalid binding in JSON to unblock execution, this is most likely not what the user wants.
 
-    m_ioBindings->ClearBoundInputs();
-    m_ioBindings->ClearBoundOutputs();
-    m_mergedBindings.clear();
-
-    Ort::MemoryInfo cpuMemoryInformation = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
-    Ort::MemoryInfo dmlMemoryInformation("DML", OrtAllocatorType::OrtDeviceAllocator, 0, OrtMemType::OrtMemTypeDefault);
+    // Tensor values are cached across Bind() calls, so only tensors whose resource or shape changed since the last
+    // Bind() get new values; m_ioBindings is left as is if no tensor changed.
+    bool bindingsChanged = !m_ioBindingsCurrent;
+    m_ioBindingsCurrent = false;
 
-    for (int bindingPass = 0; bindingPass < 2; ++bindingPass)
+    auto GetDmlValue = [&](TensorBinding& binding) -> Ort::Value*
     {
-        const bool isInputTensor = (bindingPass == 0);
-        const size_t tensorCount = isInputTensor ? m_session->GetInputCount() : m_session->GetOutputCount();
-
-        for (size_t tensorIndex = 0; tensorIndex < tensorCount; ++tensorIndex)
+        bool rebuilt = false;
+        auto& boundValue = m_boundValues.GetOrCreate(binding.name, binding.resource.Get(), binding.shape, [&]
         {
-            TensorBinding binding = {};
-            auto tensorName = GetTensorName(tensorIndex, *m_session, isInputTensor);
-            binding.name = tensorName;
-            binding.isInput = isInputTensor;
-
-            Ort::TypeInfo typeInfo = isInputTensor ? m_session->GetInputTypeInfo(tensorIndex) : m_session->GetOutputTypeInfo(tensorIndex);
-
-            bool isDmlSupportedType = false;
+            BoundValue newValue;
+            newValue.ortValue = CreateTensorFromResource(
+                m_ortDmlApi,
+                *m_dmlMemoryInformation,
+                binding.resource.Get(),
+                binding.shape,
+                binding.dataType,
+                &newValue.wrapper
+            );
+            return newValue;
+        }, &rebuilt);
+
+        binding.ortValueReused = !rebuilt;
+        bindingsChanged |= rebuilt;
+        return &boundValue.ortValue;
+    };
+
+    std::vector<TensorBinding> mergedBindings;
+    mergedBindings.reserve(m_tensorInfos.size());
+
+    for (auto& tensorInfo : m_tensorInfos)
+    {
+        TensorBinding binding = {};
+        auto& tensorName = tensorInfo.name;
+        const bool isInputTensor = tensorInfo.isInput;
+        binding.name = tensorName;
+        binding.isInput = isInputTensor;
 
-            if (typeInfo.GetONNXType() == ONNXType::ONNX_TYPE_TENSOR)
+        if (tensorInfo.isTensor)
+        {
+            auto dataTypeInfo = GetDataTypeInfo(tensorInfo.dataType);
+            binding.isDmlSupportedType = dataTypeInfo.dmlDataType != DML_TENSOR_DATA_TYPE_UNKNOWN;
+
+            // Get shape stored in ONNX model.
+            binding.shape = tensorInfo.shape;
+            binding.dataType = tensorInfo.dataType;
+            
+            // Check if the tensor shape is static or dynamic, which determines if resources can be preallocated.
+            bool tensorShapeHasFreeDimensions = false;
+            for (int64_t& dimSize : binding.shape)
             {
-                auto shapeInfo = typeInfo.GetTensorTypeAndShapeInfo();
-                auto dataTypeInfo = GetDataTypeInfo(shapeInfo.GetElementType());
-                isDmlSupportedType = dataTypeInfo.dmlDataType != DML_TENSOR_DATA_TYPE_UNKNOWN;
-
-                // Get shape stored in ONNX model.
-                binding.shape = shapeInfo.GetShape();
-                binding.dataType = shapeInfo.GetElementType();
-                
-                // Check if the tensor shape is static or dynamic, which determines if resources can be preallocated.
-                bool tensorShapeHasFreeDimensions = false;
-                for (int64_t& dimSize : binding.shape)
+                // Dimensions that aren't statically known/inferrable are "free dimensions" with size -1. 
+                if (dimSize == -1)
                 {
-                    // Dimensions that aren't statically known/inferrable are "free dimensions" with size -1. 
-                    if (dimSize == -1)
+                    // Try fixing any free dimensions that appear on *inputs* to size 1, which may make the graph valid
+                    // for execution (e.g. dim represents batch size). This trick cannot be done for outputs, since their 
+                    // free dimensions may correspond to symbolic dimensions that are only known at runtime. Tensors with 
+                    // free dimensions have "dynamic shapes" and cannot be preallocated; their total size is unknown.
+                    if (isInputTensor)
                     {
-                        // Try fixing any free dimensions that appear on *inputs* to size 1, which may make the graph valid
-                        // for execution (e.g. dim represents batch size). This trick cannot be done for outputs, since their 
-                        // free dimensions may correspond to symbolic dimensions that are only known at runtime. Tensors with 
-                        // free dimensions have "dynamic shapes" and cannot be preallocated; their total size is unknown.
-                        if (isInputTensor)
-                        {
-                            dimSize = 1;
-                        }
-                        else
-                        {
-                            tensorShapeHasFreeDimensions = true;
-                        }
+                        dimSize = 1;
                     }
-                }
-
-                // Override tensorShape with the one specified in JSON, if any.
-                auto jsonBinding = jsonBindings.find(tensorName);
-                ID3D12Resource* jsonResource = nullptr;
-                if (jsonBinding != jsonBindings.end())
-                {
-                    auto& bindingShape = jsonBinding->second[0].shape;
-                    if (!bindingShape.empty())
+                    else
                     {
-                        binding.shape = bindingShape;
-                        tensorShapeHasFreeDimensions = false;
+                        tensorShapeHasFreeDimensions = true;
                     }
+                }
+            }
 
-                    // The JSON binding may also include the name of a JSON resource.
-                    binding.resource = jsonBinding->second[0].resource;
+            // Override tensorShape with the one specified in JSON, if any.
+            auto jsonBinding = jsonBindings.find(tensorName);
+            ID3D12Resource* jsonResource = nullptr;
+            if (jsonBinding != jsonBindings.end())
+            {
+                auto& bindingShape = jsonBinding->second[0].shape;
+                if (!bindingShape.empty())
+                {
+                    binding.shape = bindingShape;
+                    tensorShapeHasFreeDimensions = false;
                 }
 
-                // Override tensorShape with the one specified on the command line, if any.
-                auto commandLineBindingShape = m_args.GetOnnxBindingShapes().find(tensorName);
-                if (commandLineBindingShape != m_args.GetOnnxBindingShapes().end())
+                // The JSON binding may also include the name of a JSON resource.
+                binding.resource = jsonBinding->second[0].resource;
+            }
+
+            // Override tensorShape with the one specified on the command line (or by a shape sweep), if any.
+            auto commandLineBindingShape = m_bindingShapes.find(tensorName);
+            if (commandLineBindingShape != m_bindingShapes.end())
+            {
+                auto& bindingShape = commandLineBindingShape->second;
+                if (!bindingShape.empty())
                 {
-                    auto& bindingShape = commandLineBindingShape->second;
-                    if (!bindingShape.empty())
-                    {
-                        binding.shape = bindingShape;
-                        tensorShapeHasFreeDimensions = false;
-                    }
+                    binding.shape = bindingShape;
+                    tensorShapeHasFreeDimensions = false;
                 }
+            }
 
-                // Attempt to preallocate/wrap resources where possible.
-                if (binding.resource)
+            // Attempt to preallocate/wrap resources where possible.
+            if (binding.resource)
+            {
+                // If a DX resource was explicitly bound in the JSON model, then it has already been allocated.
+                // Simply wrap the existing DX resource as an OrtValue.
+                if (!tensorShapeHasFreeDimensions)
                 {
-                    // If a DX resource was explicitly bound in the JSON model, then it has already been allocated.
-                    // Simply wrap the existing DX resource as an OrtValue.
-                    if (!tensorShapeHasFreeDimensions)
+                    if (binding.isDmlSupportedType)
                     {
-                        if (isDmlSupportedType)
-                        {
-                            binding.ortValue = CreateTensorFromResource(
-                                m_ortDmlApi,
-                                dmlMemoryInformation,
-                                binding.resource.Get(),
-                                binding.shape,
-                                dataTypeInfo.onnxDataType,
-                                &binding.wrapper
-                            );
-                            binding.resourceType = "explicit (DirectX)";
-                        }
-                        else
-                        {
-                            throw std::invalid_argument(fmt::format(
-                                "Binding resource '{}' to tensor '{}' is invalid because the ONNX model tensor's data type is not supported by DML.",
-                                jsonBinding->second[0].resourceDesc->name, 
-                                tensorName
-                            ));
-                        }
+                        binding.ortValue = GetDmlValue(binding);
+                        binding.resourceType = "explicit (DirectX)";
                     }
                     else
                     {
-                        throw std::invalid_argument(fmt::format("Binding resource '{}' to tensor '{}' is invalid because the tensor shape is not static.", 
+                        throw std::invalid_argument(fmt::format(
+                            "Binding resource '{}' to tensor '{}' is invalid because the ONNX model tensor's data type is not supported by DML.",
                             jsonBinding->second[0].resourceDesc->name, 
                             tensorName
                         ));
@@ -403,65 +448,111 @@ void OnnxDispatchable::Bind(const Bindings& jsonBindings, uint32_t iteration)
                 }
                 else
                 {
-                    // Attempt to lazily create resources/bindings for tensors not bound in the JSON model.
-                    // Only tensors with static shapes can be preallocated.
-                    if (!tensorShapeHasFreeDimensions)
+                    throw std::invalid_argument(fmt::format("Binding resource '{}' to tensor '{}' is invalid because the tensor shape is not static.", 
+                        jsonBinding->second[0].resourceDesc->name, 
+                        tensorName
+                    ));
+                }
+            }
+            else
+            {
+                // Attempt to lazily create resources/bindings for tensors not bound in the JSON model.
+                // Only tensors with static shapes can be preallocated.
+                if (!tensorShapeHasFreeDimensions)
+                {
+                    if (binding.isDmlSupportedType)
                     {
-                        if (isDmlSupportedType)
+                        // Convert int64_t tensorShape to uint32_t for DML
+                        std::vector<uint32_t> tensorShapeUint32;
+                        for (int64_t dimSize : binding.shape)
                         {
-                            // Convert int64_t tensorShape to uint32_t for DML
-                            std::vector<uint32_t> tensorShapeUint32;
-                            for (int64_t dimSize : binding.shape)
-                            {
-                                tensorShapeUint32.push_back(static_cast<uint32_t>(std::abs(dimSize)));
-                            }
-
-                            // Scalars have empty shapes. DML stores these as [1].
-                            if (tensorShapeUint32.empty())
-                            {
-                                tensorShapeUint32.push_back(1);
-                            }
-
-                            if (tensorShapeUint32.size() > std::numeric_limits<uint32_t>::max())
-                            {
-                                throw std::invalid_argument(fmt::format("TensorShapeUint32 '{}' is too large.", tensorShapeUint32.size()));
-                            }
-                            binding.resource = m_device->CreatePreferredDeviceMemoryBuffer(DMLCalcBufferTensorSize(
-                                dataTypeInfo.dmlDataType,
-                                static_cast<uint32_t>(tensorShapeUint32.size()),
-                                tensorShapeUint32.data(),
-                                nullptr
-                            ));
-
-                            binding.ortValue = CreateTensorFromResource(
-                                m_ortDmlApi,
-                                dmlMemoryInformation,
-                                binding.resource.Get(),
-                                binding.shape,
-                                dataTypeInfo.onnxDataType,
-                                &binding.wrapper
-                            );
+                            tensorShapeUint32.push_back(static_cast<uint32_t>(std::abs(dimSize)));
+                        }
 
-                            binding.resourceType = "implicit (DirectX)";
+                        // Scalars have empty shapes. DML stores these as [1].
+                        if (tensorShapeUint32.empty())
+                        {
+                            tensorShapeUint32.push_back(1);
                         }
-                        else
+
+                        if (tensorShapeUint32.size() > std::numeric_limits<uint32_t>::max())
+                        {
+                            throw std::invalid_argument(fmt::format("TensorShapeUint32 '{}' is too large.", tensorShapeUint32.size()));
+                        }
+                        uint64_t requiredSize = DMLCalcBufferTensorSize(
+                            dataTypeInfo.dmlDataType,
+                            static_cast<uint32_t>(tensorShapeUint32.size()),
+                            tensorShapeUint32.data(),
+                            nullptr
+                        );
+
+                        // The resource of a previous Bind() is reused if it's large enough (e.g. when the shape
+                        // changes between dispatches); the tensor only covers its leading bytes.
+                        auto& implicitResource = m_implicitResources[tensorName];
+                        bool reused = implicitResource && implicitResource->GetDesc().Width >= requiredSize;
+                        if (!reused)
                         {
-                            // Preallocate as a CPU resource.
-                            binding.ortValue = Ort::Value::CreateTensor(
+                            implicitResource = nullptr;
+                            implicitResource = m_device->CreatePreferredDeviceMemoryBuffer(requiredSize);
+                            m_device->TrackMemory(implicitResource.Get(), MemoryCategory::OnnxBindings);
+                        }
+                        binding.resource = implicitResource;
+                        binding.ortValue = GetDmlValue(binding);
+                        binding.resourceType = reused ? "implicit (DirectX, reused)" : "implicit (DirectX)";
+                    }
+                    else
+                    {
+                        // Preallocate as a CPU resource.
+                        bool rebuilt = false;
+                        auto& boundValue = m_boundValues.GetOrCreate(tensorName, nullptr, binding.shape, [&]
+                        {
+                            BoundValue newValue;
+                            newValue.ortValue = Ort::Value::CreateTensor(
                                 static_cast<OrtAllocator*>(Ort::AllocatorWithDefaultOptions()), 
                                 binding.shape.data(),
                                 binding.shape.size(), 
                                 dataTypeInfo.onnxDataType
                             );
+                            return newValue;
+                        }, &rebuilt);
 
-                            binding.resourceType = "implicit (CPU)";
-                        }
+                        binding.ortValue = &boundValue.ortValue;
+                        binding.ortValueReused = !rebuilt;
+                        bindingsChanged |= rebuilt;
+                        binding.resourceType = "implicit (CPU)";
                     }
                 }
             }
+        }
 
-            // Finally, set the ORT IO binding for the tensor.
-            if (isInputTensor)
+        if (!binding.ortValue)
+        {
+            // The tensor may have been preallocated by a previous Bind() (e.g. with a different binding shape).
+            bindingsChanged |= m_boundValues.Erase(tensorName);
+            if (!isInputTensor)
+            {
+                binding.resourceType = binding.isDmlSupportedType ? "deferred (DirectX)" : "deferred (CPU)";
+            }
+        }
+
+        mergedBindings.emplace_back(std::move(binding));
+    }
+
+    m_mergedBindings = std::move(mergedBindings);
+
+    // Finally, set the ORT IO bindings. They're rebound from scratch if any tensor changed, since outputs allocated
+    // by the execution provider during a previous Session::Run may no longer fit the new input shapes.
+    if (bindingsChanged)
+    {
+        m_ioBindings->ClearBoundInputs();
+        m_ioBindings->ClearBoundOutputs();
+
+        for (size_t i = 0; i < m_mergedBindings.size(); i++)
+        {
+            auto& binding = m_mergedBindings[i];
+            auto& tensorName = binding.name;
+
+            if (binding.isInput)
             {
                 if (binding.ortValue)
                 {
@@ -470,13 +561,11 @@ void OnnxDispatchable::Bind(const Bindings& jsonBindings, uint32_t iteration)
                 else
                 {
                     // Only non-tensor inputs should remain unbound.
-                    assert(typeInfo.GetONNXType() != ONNXType::ONNX_TYPE_TENSOR);
+                    assert(!m_tensorInfos[i].isTensor);
                 }
             }
             else
             {
-                assert(!isInputTensor);
-
                 if (binding.ortValue)
                 {
                     m_ioBindings->BindOutput(tensorName.c_str(), *binding.ortValue);
@@ -484,15 +573,20 @@ void OnnxDispatchable::Bind(const Bindings& jsonBindings, uint32_t iteration)
                 else
                 {
                     // Let the execution provider allocate the output.
-                    m_ioBindings->BindOutput(tensorName.c_str(), isDmlSupportedType ? dmlMemoryInformation : cpuMemoryInformation);
-                    binding.resourceType = isDmlSupportedType ? "deferred (DirectX)" : "deferred (CPU)";
+                    m_ioBindings->BindOutput(tensorName.c_str(), binding.isDmlSupportedType ? *m_dmlMemoryInformation : *m_cpuMemoryInformation);
                 }
             }
-
-            m_mergedBindings.emplace_back(std::move(binding));
         }
+
+        m_bindingCacheStats.misses++;
+    }
+    else
+    {
+        m_bindingCacheStats.hits++;
     }
 
+    m_ioBindingsCurrent = true;
+
     if (m_args.PrintVerboseOnnxBindingInfo())
     {
         for (auto& binding : m_mergedBindings)
@@ -511,6 +605,10 @@ void OnnxDispatchable::Bind(const Bindings& jsonBindings, uint32_t iteration)
             }
             shapeString += "]";
             m_logger->LogInfo(fmt::format("  Shape     = {}", shapeString).c_str());
+            if (binding.ortValue)
+            {
+                m_logger->LogInfo(fmt::format("  Value     = {}", binding.ortValueReused ? "reused" : "created").c_str());
+            }
             m_logger->LogInfo("");
         }
     }
@@ -3,6 +3,7 @@
 #include <onnxruntime_cxx_api.h>
 #include "dml_provider_factory.h"
 #include "CommandLineArgs.h"
+#include "TensorValueCache.h"
 
 class OnnxDispatchable : public Dispatchable
 {
@@ -13,9 +14,13 @@ public:
         const CommandLineArgs& args,
         IDxDispatchLogger* logger);
 
+    void Compile() final;
     void Initialize() final;
     void Bind(const Bindings& bindings, uint32_t iteration) final;
     void Dispatch(const Model::DispatchCommand& args, uint32_t iteration, DeferredBindings& defferedBindings) final;
+    bool SupportsBindingShapes() const final { return true; }
+    void SetBindingShapes(const std::unordered_map<std::string, std::vector<int64_t>>& shapes) final;
+    std::optional<BindingCacheStats> GetBindingCacheStats() const final { return m_bindingCacheStats; }
 
 private:
     std::shared_ptr<Device> m_device;
@@ -25,6 +30,30 @@ private:
     const OrtDmlApi* m_ortDmlApi = nullptr;
     const CommandLineArgs& m_args;
 
+    // Names and types of the session's inputs and outputs, which are queried once after the session is created.
+    struct TensorInfo
+    {
+        std::string name;
+        bool isInput;
+        bool isTensor;
+        ONNXTensorElementDataType dataType;
+        std::vector<int64_t> shape;
+    };
+    std::vector<TensorInfo> m_tensorInfos;
+    std::optional<Ort::MemoryInfo> m_cpuMemoryInformation;
+    std::optional<Ort::MemoryInfo> m_dmlMemoryInformation;
+
+    // A tensor value and, for DX resources, the DML execution provider allocation that wraps the resource.
+    struct BoundValue
+    {
+        Microsoft::WRL::ComPtr<IUnknown> wrapper;
+        Ort::Value ortValue{ nullptr };
+    };
+
+    // Values of preallocated tensors, which are only rebuilt when a tensor's resource or shape changes. The
+    // wrappers hold references to the resources.
+    TensorValueCache<ID3D12Resource*, BoundValue> m_boundValues;
+
     struct TensorBinding
     {
         std::string name;
@@ -32,15 +61,28 @@ private:
         std::vector<int64_t> shape;
         ONNXTensorElementDataType dataType;
         bool isInput;
+        bool isDmlSupportedType;
         Microsoft::WRL::ComPtr<ID3D12Resource> resource;
-        Microsoft::WRL::ComPtr<IUnknown> wrapper;
-        std::optional<Ort::Value> ortValue;
+        Ort::Value* ortValue = nullptr;  // Points into m_boundValues; null if the tensor isn't preallocated.
+        bool ortValueReused = false;
     };
 
     // ONNX dispatchables allow resources & bindings to be lazily instantiated. The merged bindings 
     // are the union of JSON bindings and bindings to lazily-allocated resources from the first Bind().
     std::vector<TensorBinding> m_mergedBindings;
 
+    // Command-line binding shapes, with any overrides from SetBindingShapes.
+    std::unordered_map<std::string, std::vector<int64_t>> m_bindingShapes;
+
+    // Resources allocated for implicit bindings, by tensor name. These are kept across Bind() calls and only
+    // replaced when a tensor's shape needs a larger buffer.
+    std::unordered_map<std::string, Microsoft::WRL::ComPtr<ID3D12Resource>> m_implicitResources;
+
     std::optional<Ort::IoBinding> m_ioBindings;
+
+    // False until the merged bindings are bound to m_ioBindings, or if the last Bind() failed partway.
+    bool m_ioBindingsCurrent = false;
+    BindingCacheStats m_bindingCacheStats;
+
     Microsoft::WRL::ComPtr<IDxDispatchLogger> m_logger;
 };
\ No newline at end of file
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include "TraceRecorder.h"
+
+// Scoped instrumentation of the CPU time spent in the phases of a dispatch iteration. While a PhaseRecorder is alive
+// it's active on the thread that created it, and DXD_PHASE_SCOPE(phase) charges the time until the end of the
+// enclosing block to a phase. Time in nested scopes is only charged to the innermost phase, so phases never overlap
+// (e.g. the fence wait inside a dispatch isn't also counted as recording). Scopes on a thread without an active
+// recorder only check a thread-local pointer, and DXD_PHASE_SCOPE expands to nothing unless DXD_PHASE_TIMING is
+// defined. Phases are also recorded as events of the thread's active TraceRecorder, if any.
+enum class CpuPhase : uint32_t
+{
+    ResolveBindings,
+    Bind,
+    Record,
+    Submit,
+    FenceWait,
+    Sleep,
+    Count
+};
+
+#ifdef DXD_PHASE_TIMING
+constexpr bool c_phaseTimingEnabled = true;
+#else
+constexpr bool c_phaseTimingEnabled = false;
+#endif
+
+constexpr const char* GetCpuPhaseName(CpuPhase phase)
+{
+    switch (phase)
+    {
+    case CpuPhase::ResolveBindings: return "resolve bindings";
+    case CpuPhase::Bind: return "bind";
+    case CpuPhase::Record: return "record";
+    case CpuPhase::Submit: return "submit";
+    case CpuPhase::FenceWait: return "fence wait";
+    case CpuPhase::Sleep: return "sleep";
+    default: return "unknown";
+    }
+}
+
+class PhaseRecorder
+{
+public:
+    static constexpr size_t c_phaseCount = static_cast<size_t>(CpuPhase::Count);
+
+    // Milliseconds spent in each phase, indexed by CpuPhase.
+    using Totals = std::array<double, c_phaseCount>;
+
+    PhaseRecorder() : m_previousRecorder(s_activeRecorder)
+    {
+        s_activeRecorder = this;
+    }
+
+    ~PhaseRecorder()
+    {
+        s_activeRecorder = m_previousRecorder;
+    }
+
+    PhaseRecorder(const PhaseRecorder&) = delete;
+    PhaseRecorder& operator=(const PhaseRecorder&) = delete;
+
+    static PhaseRecorder* GetActive() { return s_activeRecorder; }
+
+    // Returns the time spent in each phase since the previous call (or construction) and starts over. Time in a
+    // phase that's still in progress is included up to now.
+    Totals TakeTotals()
+    {
+        Charge();
+        Totals totals = m_totals;
+        m_totals = {};
+        return totals;
+    }
+
+    // Starts charging time to a phase. Returns the phase that was interrupted, which resumes on Exit.
+    CpuPhase Enter(CpuPhase phase)
+    {
+        Charge();
+        CpuPhase interruptedPhase = m_currentPhase;
+        m_currentPhase = phase;
+        return interruptedPhase;
+    }
+
+    void Exit(CpuPhase interruptedPhase)
+    {
+        Charge();
+        m_currentPhase = interruptedPhase;
+    }
+
+private:
+    void Charge()
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (m_currentPhase != CpuPhase::Count)
+        {
+            m_totals[static_cast<size_t>(m_currentPhase)] += std::chrono::duration<double, std::milli>(now - m_lastChargeTime).count();
+        }
+        m_lastChargeTime = now;
+    }
+
+private:
+    static inline thread_local PhaseRecorder* s_activeRecorder = nullptr;
+
+    PhaseRecorder* m_previousRecorder;
+    CpuPhase m_currentPhase = CpuPhase::Count; // Count means time isn't charged to any phase.
+    std::chrono::steady_clock::time_point m_lastChargeTime = std::chrono::steady_clock::now();
+    Totals m_totals = {};
+};
+
+class PhaseScope
+{
+public:
+    explicit PhaseScope(CpuPhase phase) : 
+        m_recorder(PhaseRecorder::GetActive()), 
+        m_traceRecorder(TraceRecorder::GetActive()),
+        m_phase(phase)
+    {
+        if (m_recorder)
+        {
+            m_interruptedPhase = m_recorder->Enter(phase);
+        }
+        if (m_traceRecorder)
+        {
+            m_traceStart = TraceRecorder::Clock::now();
+        }
+    }
+
+    ~PhaseScope()
+    {
+        if (m_recorder)
+        {
+            m_recorder->Exit(m_interruptedPhase);
+        }
+        if (m_traceRecorder)
+        {
+            m_traceRecorder->AddEvent(GetCpuPhaseName(m_phase), "phase", m_traceStart, TraceRecorder::Clock::now());
+        }
+    }
+
+    PhaseScope(const PhaseScope&) = delete;
+    PhaseScope& operator=(const PhaseScope&) = delete;
+
+private:
+    PhaseRecorder* m_recorder;
+    TraceRecorder* m_traceRecorder;
+    CpuPhase m_phase;
+    CpuPhase m_interruptedPhase = CpuPhase::Count;
+    TraceRecorder::Clock::time_point m_traceStart;
+};
+
+#ifdef DXD_PHASE_TIMING
+#define DXD_PHASE_SCOPE_NAME_INNER(line) phaseScope##line
+#define DXD_PHASE_SCOPE_NAME(line) DXD_PHASE_SCOPE_NAME_INNER(line)
+#define DXD_PHASE_SCOPE(phase) PhaseScope DXD_PHASE_SCOPE_NAME(__LINE__)(phase)
+#else
+#define DXD_PHASE_SCOPE(phase)
+#endif
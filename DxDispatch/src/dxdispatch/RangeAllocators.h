@@ -0,0 +1,305 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+#include "FrameRing.h"
+
+// Suballocators for a fixed-size range of GPU-visible memory (e.g. descriptors in a shader-visible heap).
+// Ranges that may still be referenced by submitted GPU work are only reused once the queue's fence timeline
+// passes the value of the submission that referenced them. Both allocators follow the same protocol: call
+// Submit() with the fence value signaled after each submission, and any allocations/frees made since the
+// previous Submit() are associated with that value.
+
+// Allocates transient ranges that are valid for a single submission. Ranges are allocated in a ring and
+// retired in submission order, so allocation is a pointer bump. If the ring is full, Allocate() blocks on the
+// oldest submission.
+class RingAllocator
+{
+public:
+    RingAllocator(IFenceTimeline* timeline, uint64_t capacity) : m_timeline(timeline), m_capacity(capacity)
+    {
+        if (capacity == 0)
+        {
+            throw std::invalid_argument("RingAllocator capacity must be non-zero.");
+        }
+    }
+
+    uint64_t Capacity() const { return m_capacity; }
+
+    // Size of all ranges that aren't yet retired (including space skipped when an allocation wraps around).
+    uint64_t UsedSize() const { return m_usedSize; }
+
+    // Number of times Allocate() had to wait for the GPU.
+    uint64_t StallCount() const { return m_stallCount; }
+
+    // Returns the offset of a contiguous range of the requested size.
+    uint64_t Allocate(uint64_t size)
+    {
+        if (size == 0 || size > m_capacity)
+        {
+            throw std::invalid_argument("RingAllocator allocation size must be non-zero and fit in the ring.");
+        }
+
+        Retire();
+        while (true)
+        {
+            auto offset = TryAllocateRange(size);
+            if (offset)
+            {
+                return *offset;
+            }
+
+            if (m_submissions.empty())
+            {
+                throw std::runtime_error("RingAllocator is full and no submitted ranges can be retired.");
+            }
+
+            m_stallCount++;
+            m_timeline->WaitForValue(m_submissions.front().fenceValue);
+            Retire();
+        }
+    }
+
+    // Like Allocate(), but returns nullopt instead of waiting for the GPU when the ring is full (or when the
+    // size doesn't fit in the ring at all).
+    std::optional<uint64_t> TryAllocate(uint64_t size)
+    {
+        if (size == 0)
+        {
+            throw std::invalid_argument("RingAllocator allocation size must be non-zero.");
+        }
+
+        if (size > m_capacity)
+        {
+            return std::nullopt;
+        }
+
+        Retire();
+        return TryAllocateRange(size);
+    }
+
+    // Size of allocations made since the last Submit().
+    uint64_t UnsubmittedSize() const { return m_unsubmittedSize; }
+
+    void Submit(uint64_t fenceValue)
+    {
+        if (m_unsubmittedSize > 0)
+        {
+            m_submissions.push_back({ fenceValue, m_unsubmittedSize });
+            m_unsubmittedSize = 0;
+        }
+    }
+
+    // Reclaims the ranges of all completed submissions.
+    void Retire()
+    {
+        uint64_t completedValue = m_timeline->GetCompletedValue();
+        while (!m_submissions.empty() && m_submissions.front().fenceValue <= completedValue)
+        {
+            m_tail = (m_tail + m_submissions.front().size) % m_capacity;
+            m_usedSize -= m_submissions.front().size;
+            m_submissions.pop_front();
+        }
+
+        if (m_usedSize == 0)
+        {
+            // Nothing is allocated, so restart at the beginning to maximize the contiguous space.
+            m_head = 0;
+            m_tail = 0;
+        }
+    }
+
+private:
+    std::optional<uint64_t> TryAllocateRange(uint64_t size)
+    {
+        uint64_t offset = 0;
+        uint64_t consumedSize = size;
+
+        if (m_usedSize == m_capacity)
+        {
+            return std::nullopt;
+        }
+        else if (m_head >= m_tail)
+        {
+            // Free space is [head, capacity) followed by [0, tail).
+            if (m_capacity - m_head >= size)
+            {
+                offset = m_head;
+            }
+            else if (m_tail >= size)
+            {
+                // Skip the end of the ring, which is retired along with this allocation.
+                offset = 0;
+                consumedSize += m_capacity - m_head;
+            }
+            else
+            {
+                return std::nullopt;
+            }
+        }
+        else
+        {
+            // Free space is [head, tail).
+            if (m_tail - m_head >= size)
+            {
+                offset = m_head;
+            }
+            else
+            {
+                return std::nullopt;
+            }
+        }
+
+        m_head = (offset + size) % m_capacity;
+        m_usedSize += consumedSize;
+        m_unsubmittedSize += consumedSize;
+        return offset;
+    }
+
+private:
+    struct Submission
+    {
+        uint64_t fenceValue;
+        uint64_t size;
+    };
+
+    IFenceTimeline* m_timeline;
+    uint64_t m_capacity;
+    uint64_t m_head = 0;
+    uint64_t m_tail = 0;
+    uint64_t m_usedSize = 0;
+    uint64_t m_unsubmittedSize = 0;
+    uint64_t m_stallCount = 0;
+    std::deque<Submission> m_submissions;
+};
+
+// Allocates long-lived ranges (first fit). Freed ranges become available once the GPU completes the next
+// submission, since work recorded before the free may still reference them.
+class FreeListAllocator
+{
+public:
+    FreeListAllocator(IFenceTimeline* timeline, uint64_t capacity) : m_timeline(timeline), m_capacity(capacity)
+    {
+        if (capacity > 0)
+        {
+            m_freeRanges[0] = capacity;
+        }
+    }
+
+    uint64_t Capacity() const { return m_capacity; }
+    uint64_t UsedSize() const { return m_usedSize; }
+
+    // Returns the offset of a contiguous range of the requested size.
+    uint64_t Allocate(uint64_t size)
+    {
+        if (size == 0)
+        {
+            throw std::invalid_argument("FreeListAllocator allocation size must be non-zero.");
+        }
+
+        Retire();
+        while (true)
+        {
+            for (auto it = m_freeRanges.begin(); it != m_freeRanges.end(); it++)
+            {
+                if (it->second >= size)
+                {
+                    uint64_t offset = it->first;
+                    uint64_t remainingSize = it->second - size;
+                    m_freeRanges.erase(it);
+                    if (remainingSize > 0)
+                    {
+                        m_freeRanges[offset + size] = remainingSize;
+                    }
+                    m_usedSize += size;
+                    return offset;
+                }
+            }
+
+            if (m_pendingFrees.empty())
+            {
+                throw std::runtime_error("FreeListAllocator has no free range large enough for the allocation.");
+            }
+
+            m_timeline->WaitForValue(m_pendingFrees.front().fenceValue);
+            Retire();
+        }
+    }
+
+    void Free(uint64_t offset, uint64_t size)
+    {
+        if (size > 0)
+        {
+            m_unsubmittedFrees.push_back({ offset, size });
+        }
+    }
+
+    void Submit(uint64_t fenceValue)
+    {
+        for (auto& range : m_unsubmittedFrees)
+        {
+            m_pendingFrees.push_back({ fenceValue, range });
+        }
+        m_unsubmittedFrees.clear();
+    }
+
+    // Returns freed ranges of all completed submissions to the free list.
+    void Retire()
+    {
+        uint64_t completedValue = m_timeline->GetCompletedValue();
+        while (!m_pendingFrees.empty() && m_pendingFrees.front().fenceValue <= completedValue)
+        {
+            AddFreeRange(m_pendingFrees.front().range);
+            m_pendingFrees.pop_front();
+        }
+    }
+
+private:
+    struct Range
+    {
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    struct PendingFree
+    {
+        uint64_t fenceValue;
+        Range range;
+    };
+
+    void AddFreeRange(Range range)
+    {
+        m_usedSize -= range.size;
+
+        // Coalesce with the adjacent free ranges, if any.
+        auto next = m_freeRanges.lower_bound(range.offset);
+        if (next != m_freeRanges.end() && range.offset + range.size == next->first)
+        {
+            range.size += next->second;
+            next = m_freeRanges.erase(next);
+        }
+        if (next != m_freeRanges.begin())
+        {
+            auto previous = std::prev(next);
+            if (previous->first + previous->second == range.offset)
+            {
+                previous->second += range.size;
+                return;
+            }
+        }
+        m_freeRanges[range.offset] = range.size;
+    }
+
+private:
+    IFenceTimeline* m_timeline;
+    uint64_t m_capacity;
+    uint64_t m_usedSize = 0;
+    std::map<uint64_t, uint64_t> m_freeRanges; // offset -> size
+    std::vector<Range> m_unsubmittedFrees;
+    std::deque<PendingFree> m_pendingFrees;
+};
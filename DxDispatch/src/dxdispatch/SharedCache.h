@@ -0,0 +1,92 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+struct SharedCacheStats
+{
+    uint64_t hits = 0;      // Requests that shared an existing object.
+    uint64_t misses = 0;    // Requests that created an object.
+};
+
+// Shares objects that are expensive to create (e.g. compiled operators and pipeline states) between everything that
+// requests them with the same key, which must identify everything the object depends on. The cache only holds weak
+// references: an object is released with its last user, and the next request for its key creates it again.
+//
+// Objects are created without holding the cache's lock, so objects of different keys are created concurrently. If
+// two threads miss the same key at once, both create an object and the one inserted first is shared.
+template <typename TValue>
+class SharedCache
+{
+public:
+    template <typename TCreate>
+    std::shared_ptr<const TValue> GetOrCreate(const std::string& key, TCreate&& create)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto entry = m_entries.find(key);
+            if (entry != m_entries.end())
+            {
+                if (auto value = entry->second.lock())
+                {
+                    m_stats.hits++;
+                    return value;
+                }
+            }
+        }
+
+        auto created = std::make_shared<const TValue>(create());
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.misses++;
+        auto& entry = m_entries[key];
+        if (auto value = entry.lock())
+        {
+            return value;
+        }
+        entry = created;
+
+        // Entries of released objects are removed as the cache grows, so it stays proportional to the live objects.
+        if (m_entries.size() > 2 * m_liveEntryCountAtLastPrune)
+        {
+            for (auto it = m_entries.begin(); it != m_entries.end();)
+            {
+                it = it->second.expired() ? m_entries.erase(it) : std::next(it);
+            }
+            m_liveEntryCountAtLastPrune = std::max<size_t>(m_entries.size(), c_minPruneSize);
+        }
+
+        return created;
+    }
+
+    SharedCacheStats GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+    // Number of keys whose objects are still in use.
+    size_t GetLiveCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        size_t count = 0;
+        for (auto& entry : m_entries)
+        {
+            count += entry.second.expired() ? 0 : 1;
+        }
+        return count;
+    }
+
+private:
+    static constexpr size_t c_minPruneSize = 16;
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, std::weak_ptr<const TValue>> m_entries;
+    size_t m_liveEntryCountAtLastPrune = c_minPruneSize;
+    SharedCacheStats m_stats;
+};
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+// Accumulates statistics of a stream of non-negative samples (e.g. timings in milliseconds) in constant memory.
+// The first c_exactSampleCapacity samples are kept, so percentiles of shorter streams are exact; after that the
+// samples move into a histogram of logarithmic buckets, and percentiles are approximated to within
+// c_bucketGrowth / 2 relative error. Count, sum, min, and max are always exact.
+class StreamingStats
+{
+public:
+    static constexpr size_t c_exactSampleCapacity = 4096;
+    static constexpr double c_bucketGrowth = 0.005;
+    static constexpr double c_minBucketValue = 1e-6;
+    static constexpr double c_maxBucketValue = 1e7;
+
+    struct Summary
+    {
+        size_t count;
+        double sum;
+        double average;
+        double median;
+        double min;
+        double max;
+    };
+
+    void Add(double sample)
+    {
+        m_count++;
+        m_sum += sample;
+        m_min = std::min(m_min, sample);
+        m_max = std::max(m_max, sample);
+
+        if (m_buckets.empty())
+        {
+            m_samples.push_back(sample);
+            if (m_samples.size() > c_exactSampleCapacity)
+            {
+                MoveSamplesToBuckets();
+            }
+        }
+        else
+        {
+            m_buckets[BucketIndex(sample)]++;
+        }
+    }
+
+    // Adds the samples of another stream, as if they had been added to this one.
+    void Merge(const StreamingStats& other)
+    {
+        if (other.m_buckets.empty())
+        {
+            for (auto sample : other.m_samples)
+            {
+                Add(sample);
+            }
+            return;
+        }
+
+        if (m_buckets.empty())
+        {
+            MoveSamplesToBuckets();
+        }
+
+        m_count += other.m_count;
+        m_sum += other.m_sum;
+        m_min = std::min(m_min, other.m_min);
+        m_max = std::max(m_max, other.m_max);
+        for (size_t i = 0; i < m_buckets.size(); i++)
+        {
+            m_buckets[i] += other.m_buckets[i];
+        }
+    }
+
+    size_t Count() const { return m_count; }
+
+    // Returns the sample at the given fraction of the sorted samples (sorted[floor(fraction * count)]), e.g. 0.5 for
+    // the median. Returns 0 if there are no samples.
+    double Percentile(double fraction) const
+    {
+        if (m_count == 0)
+        {
+            return 0;
+        }
+
+        size_t rank = std::min(m_count - 1, static_cast<size_t>(fraction * m_count));
+        if (m_buckets.empty())
+        {
+            std::vector<double> samples = m_samples;
+            std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+            return samples[rank];
+        }
+
+        uint64_t cumulativeCount = 0;
+        for (size_t i = 0; i < m_buckets.size(); i++)
+        {
+            cumulativeCount += m_buckets[i];
+            if (cumulativeCount > rank)
+            {
+                // The first and last buckets are unbounded, so their samples are represented by the min and max.
+                if (i == 0)
+                {
+                    return m_min;
+                }
+                if (i == m_buckets.size() - 1)
+                {
+                    return m_max;
+                }
+
+                // Geometric center of the bucket, which can't lie outside the observed range.
+                double center = c_minBucketValue * std::pow(1 + c_bucketGrowth, i - 0.5);
+                return std::clamp(center, m_min, m_max);
+            }
+        }
+
+        return m_max;
+    }
+
+    Summary GetSummary() const
+    {
+        Summary summary = {};
+        if (m_count > 0)
+        {
+            summary.count = m_count;
+            summary.sum = m_sum;
+            summary.average = m_sum / m_count;
+            summary.median = Percentile(0.5);
+            summary.min = m_min;
+            summary.max = m_max;
+        }
+        return summary;
+    }
+
+private:
+    void MoveSamplesToBuckets()
+    {
+        m_buckets.resize(BucketIndex(c_maxBucketValue) + 1);
+        for (auto exactSample : m_samples)
+        {
+            m_buckets[BucketIndex(exactSample)]++;
+        }
+        m_samples.clear();
+        m_samples.shrink_to_fit();
+    }
+
+    static size_t BucketIndex(double sample)
+    {
+        // Bucket 0 holds everything up to the minimum value; bucket i covers (min * g^(i-1), min * g^i].
+        if (!(sample > c_minBucketValue))
+        {
+            return 0;
+        }
+
+        double index = std::ceil(std::log(std::min(sample, c_maxBucketValue) / c_minBucketValue) / std::log1p(c_bucketGrowth));
+        return static_cast<size_t>(index);
+    }
+
+private:
+    size_t m_count = 0;
+    double m_sum = 0;
+    double m_min = std::numeric_limits<double>::max();
+    double m_max = std::numeric_limits<double>::lowest();
+    std::vector<double> m_samples;
+    std::vector<uint64_t> m_buckets;
+};
+
+// Splits a stream of samples into "cold" samples from the first (warmup) iterations and "hot" samples from the rest.
+// Up to maxWarmupSamples samples are cold, but at least one sample is always hot: the most recent sample is held back
+// until the next one arrives, so it counts as hot if the stream ends within the warmup.
+class WarmupStats
+{
+public:
+    explicit WarmupStats(size_t maxWarmupSamples) : m_maxWarmupSamples(maxWarmupSamples) {}
+
+    void Add(double sample)
+    {
+        if (m_latest)
+        {
+            auto& stats = m_cold.Count() < m_maxWarmupSamples ? m_cold : m_hot;
+            stats.Add(*m_latest);
+        }
+        m_latest = sample;
+    }
+
+    size_t Count() const { return m_cold.Count() + m_hot.Count() + (m_latest ? 1 : 0); }
+
+    StreamingStats::Summary GetColdSummary() const { return m_cold.GetSummary(); }
+
+    StreamingStats::Summary GetHotSummary() const
+    {
+        if (!m_latest)
+        {
+            return m_hot.GetSummary();
+        }
+
+        StreamingStats hot = m_hot;
+        hot.Add(*m_latest);
+        return hot.GetSummary();
+    }
+
+private:
+    size_t m_maxWarmupSamples;
+    StreamingStats m_cold;
+    StreamingStats m_hot;
+    std::optional<double> m_latest;
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Caches the value bound to each tensor of a dispatchable (e.g. an OrtValue and the allocation it wraps), so the value
+// is only rebuilt when the tensor's resource or shape changes. Resources are compared by identity, so a cached value
+// should hold a reference to its resource: otherwise a new resource could be created at the address of a released one
+// and be mistaken for it.
+template <typename TResource, typename TValue>
+class TensorValueCache
+{
+public:
+    // Returns the cached value of the tensor if it was created for the same resource and shape; otherwise, replaces
+    // it with the value returned by create(). Sets 'rebuilt' to whether create() was called.
+    template <typename TCreate>
+    TValue& GetOrCreate(
+        const std::string& tensorName,
+        TResource resource,
+        const std::vector<int64_t>& shape,
+        TCreate&& create,
+        bool* rebuilt = nullptr)
+    {
+        auto entry = m_entries.find(tensorName);
+        if (entry != m_entries.end() && entry->second.resource == resource && entry->second.shape == shape)
+        {
+            if (rebuilt) { *rebuilt = false; }
+            return entry->second.value;
+        }
+
+        // The stale value is released first, so its memory can be reused by the new value.
+        if (entry != m_entries.end())
+        {
+            m_entries.erase(entry);
+        }
+
+        auto& newEntry = m_entries.emplace(tensorName, Entry{ resource, shape, create() }).first->second;
+        if (rebuilt) { *rebuilt = true; }
+        return newEntry.value;
+    }
+
+    // Removes the tensor's value (e.g. when the tensor is no longer bound to a value). Returns true if it was cached.
+    bool Erase(const std::string& tensorName)
+    {
+        return m_entries.erase(tensorName) > 0;
+    }
+
+    void Clear()
+    {
+        m_entries.clear();
+    }
+
+    size_t GetSize() const
+    {
+        return m_entries.size();
+    }
+
+private:
+    struct Entry
+    {
+        TResource resource;
+        std::vector<int64_t> shape;
+        TValue value;
+    };
+
+    std::unordered_map<std::string, Entry> m_entries;
+};
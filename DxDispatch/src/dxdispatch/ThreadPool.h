@@ -0,0 +1,136 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of threads for running data-parallel loops (e.g. recording command lists). The calling thread takes
+// part in each loop, so a pool with a thread count of N creates N - 1 worker threads. Loops are not reentrant:
+// ParallelFor must not be called concurrently or from within a loop body.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(uint32_t threadCount)
+    {
+        for (uint32_t i = 1; i < threadCount; i++)
+        {
+            m_workers.emplace_back([this] { WorkerMain(); });
+        }
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_shutdown = true;
+        }
+        m_jobAvailable.notify_all();
+
+        for (auto& worker : m_workers)
+        {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    uint32_t ThreadCount() const { return static_cast<uint32_t>(m_workers.size() + 1); }
+
+    // Calls func(i) exactly once for every i in [0, count), distributing the calls across threads, and blocks until
+    // all calls finish. If any call throws, the first exception is rethrown after the remaining calls finish.
+    void ParallelFor(size_t count, const std::function<void(size_t)>& func)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_func = &func;
+            m_count = count;
+            m_nextIndex = 0;
+            m_activeWorkers = m_workers.size();
+            m_exception = nullptr;
+            m_generation++;
+        }
+        m_jobAvailable.notify_all();
+
+        RunJob();
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_jobFinished.wait(lock, [this] { return m_activeWorkers == 0; });
+        m_func = nullptr;
+
+        if (m_exception)
+        {
+            std::rethrow_exception(m_exception);
+        }
+    }
+
+private:
+    void WorkerMain()
+    {
+        uint64_t lastGeneration = 0;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_jobAvailable.wait(lock, [&] { return m_shutdown || m_generation != lastGeneration; });
+                if (m_shutdown)
+                {
+                    return;
+                }
+                lastGeneration = m_generation;
+            }
+
+            RunJob();
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_activeWorkers--;
+            }
+            m_jobFinished.notify_one();
+        }
+    }
+
+    void RunJob()
+    {
+        for (size_t i = m_nextIndex++; i < m_count; i = m_nextIndex++)
+        {
+            try
+            {
+                (*m_func)(i);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_exception)
+                {
+                    m_exception = std::current_exception();
+                }
+            }
+        }
+    }
+
+private:
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_jobAvailable;
+    std::condition_variable m_jobFinished;
+    bool m_shutdown = false;
+
+    // Current job. Written under the mutex before workers are woken, so workers can read it without locking.
+    const std::function<void(size_t)>* m_func = nullptr;
+    size_t m_count = 0;
+    std::atomic<size_t> m_nextIndex{ 0 };
+    size_t m_activeWorkers = 0;
+    uint64_t m_generation = 0;
+    std::exception_ptr m_exception;
+};
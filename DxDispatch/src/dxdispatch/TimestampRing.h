@@ -0,0 +1,179 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "FrameRing.h"
+
+// Bookkeeping for a ring of GPU timestamp queries that are resolved incrementally. Each submission resolves the
+// timestamps recorded into it (see GetUnresolvedRanges) into a readback buffer with the same layout as the query
+// heap, and the values are consumed in recording order once the submission's fence completes. Consecutive pairs of
+// timestamps (start, end) are passed to a callback, along with the timeline the pair was submitted on, so the memory
+// used doesn't grow with the number of timestamps.
+//
+// Consuming never adds a sync point: Poll only checks fences that have already completed (e.g. because the caller
+// waited on a frame), and Record only blocks when every query in the ring belongs to an incomplete submission.
+class TimestampRing
+{
+public:
+    using PairCallback = std::function<void(IFenceTimeline* timeline, uint64_t startTimestamp, uint64_t endTimestamp)>;
+
+    // resolvedValues must point to the readback memory for capacity timestamps, indexed by query index.
+    TimestampRing(uint32_t capacity, const uint64_t* resolvedValues, PairCallback onPair) :
+        m_queries(capacity),
+        m_resolvedValues(resolvedValues),
+        m_onPair(std::move(onPair))
+    {
+        if (capacity == 0 || capacity % 2 != 0)
+        {
+            throw std::invalid_argument("TimestampRing capacity must be a positive even number.");
+        }
+    }
+
+    uint32_t Capacity() const { return static_cast<uint32_t>(m_queries.size()); }
+
+    // Number of times Record blocked because the ring was full.
+    uint64_t StallCount() const { return m_stallCount; }
+
+    // Returns the query index for a new timestamp that will be submitted on the given timeline.
+    uint32_t Record(IFenceTimeline* timeline)
+    {
+        if (m_head - m_tail == Capacity())
+        {
+            auto& oldest = m_queries[QueryIndex(m_tail)];
+            if (!oldest.timeline)
+            {
+                throw std::runtime_error(
+                    "Too many GPU timestamps were recorded without being submitted. Increase the GPU time measurement limit.");
+            }
+
+            if (oldest.fenceValue > oldest.timeline->GetCompletedValue())
+            {
+                oldest.timeline->WaitForValue(oldest.fenceValue);
+                m_stallCount++;
+            }
+            Poll();
+        }
+
+        uint32_t queryIndex = QueryIndex(m_head++);
+        m_queries[queryIndex] = {};
+        m_unresolved[timeline].push_back(queryIndex);
+        return queryIndex;
+    }
+
+    // Returns the query ranges (first index, count) recorded for a timeline since its last submission. These must be
+    // resolved by the submission passed to Submit.
+    std::vector<std::pair<uint32_t, uint32_t>> GetUnresolvedRanges(IFenceTimeline* timeline) const
+    {
+        std::vector<std::pair<uint32_t, uint32_t>> ranges;
+        auto unresolved = m_unresolved.find(timeline);
+        if (unresolved == m_unresolved.end())
+        {
+            return ranges;
+        }
+
+        for (auto queryIndex : unresolved->second)
+        {
+            if (!ranges.empty() && ranges.back().first + ranges.back().second == queryIndex)
+            {
+                ranges.back().second++;
+            }
+            else
+            {
+                ranges.push_back({ queryIndex, 1 });
+            }
+        }
+        return ranges;
+    }
+
+    // Associates the timestamps recorded for a timeline with its latest submission, then consumes any completed ones.
+    void Submit(IFenceTimeline* timeline, uint64_t fenceValue)
+    {
+        auto unresolved = m_unresolved.find(timeline);
+        if (unresolved != m_unresolved.end())
+        {
+            for (auto queryIndex : unresolved->second)
+            {
+                m_queries[queryIndex] = { timeline, fenceValue };
+            }
+            m_unresolved.erase(unresolved);
+        }
+
+        Poll();
+    }
+
+    // Consumes timestamps, in recording order, up to the first one whose submission hasn't completed. Doesn't block.
+    void Poll()
+    {
+        while (m_tail < m_head)
+        {
+            auto& query = m_queries[QueryIndex(m_tail)];
+            if (!query.timeline || query.fenceValue > query.timeline->GetCompletedValue())
+            {
+                break;
+            }
+            Consume();
+        }
+    }
+
+    // Blocks until every submitted timestamp has been consumed. Returns false if unsubmitted timestamps remain.
+    bool Drain()
+    {
+        while (m_tail < m_head)
+        {
+            auto& query = m_queries[QueryIndex(m_tail)];
+            if (!query.timeline)
+            {
+                return false;
+            }
+
+            if (query.fenceValue > query.timeline->GetCompletedValue())
+            {
+                query.timeline->WaitForValue(query.fenceValue);
+            }
+            Consume();
+        }
+        return true;
+    }
+
+private:
+    struct Query
+    {
+        IFenceTimeline* timeline = nullptr; // Null until the timestamp is submitted.
+        uint64_t fenceValue = 0;
+    };
+
+    uint32_t QueryIndex(uint64_t sequenceNumber) const { return static_cast<uint32_t>(sequenceNumber % Capacity()); }
+
+    void Consume()
+    {
+        uint32_t queryIndex = QueryIndex(m_tail);
+        uint64_t value = m_resolvedValues[queryIndex];
+
+        // Timestamps are paired by position in the recording order, which starts at 0 and the capacity is even.
+        if (m_tail++ % 2 == 0)
+        {
+            m_startTimestamp = value;
+        }
+        else
+        {
+            m_onPair(m_queries[queryIndex].timeline, m_startTimestamp, value);
+        }
+    }
+
+private:
+    std::vector<Query> m_queries;
+    const uint64_t* m_resolvedValues;
+    PairCallback m_onPair;
+
+    // Sequence numbers: timestamps in [m_tail, m_head) are recorded but not yet consumed.
+    uint64_t m_head = 0;
+    uint64_t m_tail = 0;
+
+    std::unordered_map<IFenceTimeline*, std::vector<uint32_t>> m_unresolved;
+    uint64_t m_startTimestamp = 0;
+    uint64_t m_stallCount = 0;
+};
@@ -0,0 +1,264 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Collects timeline events of a run and writes them in the Chrome Trace Event format (viewable in Perfetto or
+// chrome://tracing). A recorder is active on a thread while an ActiveScope for it is alive, and TraceScope records
+// the enclosing block as an event of the active recorder; without one, scopes do nothing.
+//
+// Each thread appends to its own buffer, so recording doesn't lock or contend with other threads (only a thread's
+// first event of a recorder registers its buffer). Buffers are read by Write, which must not race with recording:
+// call it once the threads that recorded events are idle (e.g. at exit).
+class TraceRecorder
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    TraceRecorder() : m_id(s_nextId++), m_origin(Clock::now()) {}
+
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    static TraceRecorder* GetActive() { return s_activeRecorder; }
+
+    // Makes a recorder (or none, if null) active on the current thread until the scope ends.
+    class ActiveScope
+    {
+    public:
+        explicit ActiveScope(TraceRecorder* recorder) : m_previousRecorder(s_activeRecorder)
+        {
+            s_activeRecorder = recorder;
+        }
+
+        ~ActiveScope()
+        {
+            s_activeRecorder = m_previousRecorder;
+        }
+
+        ActiveScope(const ActiveScope&) = delete;
+        ActiveScope& operator=(const ActiveScope&) = delete;
+
+    private:
+        TraceRecorder* m_previousRecorder;
+    };
+
+    uint64_t GetId() const { return m_id; }
+
+    // Returns the ID of the named track, adding it on first use. Named tracks hold events that don't belong to the
+    // thread that recorded them (e.g. GPU work, which is read back later): events on one track must not overlap
+    // unless nested, so each independent timeline (e.g. a queue) needs a track of its own. Locks the recorder, so
+    // callers should cache the ID (see GetId).
+    uint32_t GetNamedTrackId(const std::string& trackName)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& track : m_namedTracks)
+        {
+            if (track.second == trackName)
+            {
+                return track.first;
+            }
+        }
+        m_namedTracks.emplace_back(m_nextTrackId, trackName);
+        return m_nextTrackId++;
+    }
+
+    // Adds an event to the current thread's track.
+    void AddEvent(std::string name, const char* category, Clock::time_point start, Clock::time_point end)
+    {
+        auto& buffer = GetThreadBuffer();
+        AddEvent(buffer, std::move(name), category, start, end, buffer.trackId);
+    }
+
+    // Adds an event to a track returned by GetNamedTrackId.
+    void AddEvent(std::string name, const char* category, Clock::time_point start, Clock::time_point end, uint32_t trackId)
+    {
+        AddEvent(GetThreadBuffer(), std::move(name), category, start, end, trackId);
+    }
+
+    size_t GetEventCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        size_t count = 0;
+        for (auto& buffer : m_threadBuffers)
+        {
+            count += buffer.second->events.size();
+        }
+        return count;
+    }
+
+    void Write(std::ostream& stream) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        const char* separator = "\n";
+        for (auto& track : m_namedTracks)
+        {
+            stream << separator;
+            WriteTrackName(stream, track.first, track.second);
+            separator = ",\n";
+        }
+        for (auto& buffer : m_threadBuffers)
+        {
+            stream << separator;
+            WriteTrackName(stream, buffer.second->trackId, "Thread " + std::to_string(buffer.second->threadNumber));
+            separator = ",\n";
+        }
+
+        stream << std::fixed << std::setprecision(3);
+        for (auto& buffer : m_threadBuffers)
+        {
+            for (auto& event : buffer.second->events)
+            {
+                stream << separator << "{\"ph\":\"X\",\"pid\":1,\"tid\":" << event.trackId << ",\"name\":";
+                WriteString(stream, event.name);
+                stream << ",\"cat\":";
+                WriteString(stream, event.category);
+                stream << ",\"ts\":" << event.start << ",\"dur\":" << event.duration << "}";
+                separator = ",\n";
+            }
+        }
+        stream << "\n]}\n";
+    }
+
+private:
+    struct Event
+    {
+        std::string name;
+        const char* category;
+        double start; // Microseconds since the recorder was created.
+        double duration; // Microseconds.
+        uint32_t trackId;
+    };
+
+    struct ThreadBuffer
+    {
+        uint32_t trackId;
+        uint32_t threadNumber;
+        std::vector<Event> events;
+    };
+
+    // The buffer of the most recently used recorder is cached on each thread. Recorders are identified by a unique
+    // ID rather than their address, which may be reused by a later recorder.
+    struct CachedThreadBuffer
+    {
+        uint64_t recorderId;
+        ThreadBuffer* buffer;
+    };
+
+    ThreadBuffer& GetThreadBuffer()
+    {
+        if (s_cachedThreadBuffer.recorderId != m_id)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto& buffer = m_threadBuffers[std::this_thread::get_id()];
+            if (!buffer)
+            {
+                buffer = std::make_unique<ThreadBuffer>();
+                buffer->trackId = m_nextTrackId++;
+                buffer->threadNumber = static_cast<uint32_t>(m_threadBuffers.size());
+            }
+            s_cachedThreadBuffer = { m_id, buffer.get() };
+        }
+        return *s_cachedThreadBuffer.buffer;
+    }
+
+    void AddEvent(ThreadBuffer& buffer, std::string name, const char* category, Clock::time_point start, Clock::time_point end, uint32_t trackId)
+    {
+        buffer.events.push_back({
+            std::move(name),
+            category,
+            ToMicroseconds(start),
+            std::chrono::duration<double, std::micro>(end - start).count(),
+            trackId
+        });
+    }
+
+    double ToMicroseconds(Clock::time_point time) const
+    {
+        return std::chrono::duration<double, std::micro>(time - m_origin).count();
+    }
+
+    static void WriteTrackName(std::ostream& stream, uint32_t trackId, const std::string& name)
+    {
+        stream << "{\"ph\":\"M\",\"pid\":1,\"tid\":" << trackId << ",\"name\":\"thread_name\",\"args\":{\"name\":";
+        WriteString(stream, name);
+        stream << "}}";
+    }
+
+    static void WriteString(std::ostream& stream, const std::string& value)
+    {
+        stream << '"';
+        for (char c : value)
+        {
+            if (c == '"' || c == '\\')
+            {
+                stream << '\\' << c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                constexpr const char* hexDigits = "0123456789abcdef";
+                stream << "\\u00" << hexDigits[c >> 4] << hexDigits[c & 0xF];
+            }
+            else
+            {
+                stream << c;
+            }
+        }
+        stream << '"';
+    }
+
+private:
+    static inline std::atomic<uint64_t> s_nextId = 1;
+    static inline thread_local TraceRecorder* s_activeRecorder = nullptr;
+    static inline thread_local CachedThreadBuffer s_cachedThreadBuffer = {};
+
+    uint64_t m_id;
+    Clock::time_point m_origin;
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::thread::id, std::unique_ptr<ThreadBuffer>> m_threadBuffers;
+    std::vector<std::pair<uint32_t, std::string>> m_namedTracks;
+    uint32_t m_nextTrackId = 1;
+};
+
+// Records the time until the end of the enclosing block as an event of the thread's active trace recorder, if any.
+class TraceScope
+{
+public:
+    TraceScope(const char* category, std::string name) : m_recorder(TraceRecorder::GetActive()), m_category(category)
+    {
+        if (m_recorder)
+        {
+            m_name = std::move(name);
+            m_start = TraceRecorder::Clock::now();
+        }
+    }
+
+    ~TraceScope()
+    {
+        if (m_recorder)
+        {
+            m_recorder->AddEvent(std::move(m_name), m_category, m_start, TraceRecorder::Clock::now());
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    TraceRecorder* m_recorder;
+    const char* m_category;
+    std::string m_name;
+    TraceRecorder::Clock::time_point m_start;
+};
@@ -8,6 +8,7 @@
 #include "CommandLineArgs.h"
 #include "ModuleInfo.h"
 #include "dxDispatchWrapper.h"
+#include "TraceRecorder.h"
 
 using namespace Microsoft::WRL;
 
@@ -95,6 +96,12 @@ HRESULT DxDispatch::RuntimeClassInitialize(
         throw;
     }
 
+    if (m_options->TraceFilePath())
+    {
+        m_traceRecorder = std::make_unique<TraceRecorder>();
+    }
+    TraceRecorder::ActiveScope activeTrace(m_traceRecorder.get());
+
     // Needs to be constructed *before* D3D12 device. A warning is printed if DXCore.dll is loaded first,
     // even though the D3D12Device isn't created yet, so we create the capture helper first to avoid this
     // message.
@@ -157,29 +164,10 @@ HRESULT DxDispatch::RuntimeClassInitialize(
     
     try
     {
-            m_options->SetAdapter(dxDispatchAdapter->GetAdapter());
-            m_device = std::make_shared<Device>(
-                dxDispatchAdapter->GetAdapter(),
-                D3D_FEATURE_LEVEL_1_0_GENERIC,
-                m_options->DmlFeatureLevel(),
-                m_options->DebugLayersEnabled(),
-                m_options->CommandListType(),
-                m_options->DispatchRepeat(),
-                m_options->GetUavBarrierAfterDispatch(),
-                m_options->GetAliasingBarrierAfterDispatch(),
-                m_options->ClearShaderCaches(),
-                m_options->DisableGpuTimeout(),
-                m_options->EnableDred(),
-                m_options->DisableBackgroundProcessing(),
-                m_options->SetStablePowerState(),
-                m_options->PreferCustomHeaps(),
-                m_options->GetPresentSeparator(),
-                m_options->MaxGpuTimeMeasurements(),
-                m_pixCaptureHelper,
-                m_d3dModule,
-                m_dmlModule,
-                m_logger.Get()
-            );
+        TraceScope trace("init", "create device");
+        m_adapter = dxDispatchAdapter->GetAdapter();
+        m_options->SetAdapter(m_adapter.Get());
+        m_device = CreateDevice(m_pixCaptureHelper, m_logger.Get());
     }
     catch(const std::exception& e)
     {
@@ -189,73 +177,15 @@ HRESULT DxDispatch::RuntimeClassInitialize(
 
     m_logger->LogInfo(fmt::format("Running on '{}'", dxDispatchAdapter->GetDescription()).c_str());
 
-    auto inputPath = m_options->InputPath();
-    auto outputPath = m_options->OutputPath();
+    if (jsonConfig)
+    {
+        m_jsonConfig = jsonConfig;
+    }
 
     try
     {
-        if (!inputPath.has_value())
-        {
-            if (model.has_value())
-            {
-                inputPath = model.value().parent_path();
-            }
-            else
-            {
-                inputPath = std::filesystem::current_path();
-            }
-        }
-        if (!outputPath.has_value())
-        {
-            outputPath = std::filesystem::current_path();
-        }
-
-        if (jsonConfig)
-        {
-            std::string_view fileContent(jsonConfig);
-
-            rapidjson::Document doc;
-
-            constexpr rapidjson::ParseFlag parseFlags = rapidjson::ParseFlag(
-                rapidjson::kParseFullPrecisionFlag |
-                rapidjson::kParseCommentsFlag |
-                rapidjson::kParseTrailingCommasFlag |
-                rapidjson::kParseStopWhenDoneFlag);
-
-            std::vector<char> input{ jsonConfig, jsonConfig + strlen(jsonConfig) };
-            doc.ParseInsitu<parseFlags>(&input[0]);
-            m_modelWrapper = std::unique_ptr<ModelWrapper>(new ModelWrapper(
-                JsonParsers::ParseModel(
-                    doc,
-                    fileContent,
-                    inputPath.value(),
-                    outputPath.value())));
-        }
-        else if (model.value().extension() == ".json")
-        {
-            m_modelWrapper = std::unique_ptr<ModelWrapper>(new ModelWrapper(JsonParsers::ParseModel(
-                model.value(),
-                inputPath.value(),
-                outputPath.value())));
-        }
-        else if (model.value().extension() == ".onnx")
-        {
-    #ifdef ONNXRUNTIME_NONE
-            throw std::invalid_argument("ONNX dispatchables require ONNX Runtime");
-    #else
-            auto name = model.value().filename().string();
-            m_modelWrapper = std::unique_ptr<ModelWrapper>(
-                new ModelWrapper(
-                    Model(
-                        {}, // resource
-                        { {name, Model::OnnxDispatchableDesc{model.value()}} },  // dispatchables
-                        { {"dispatch", name, Model::DispatchCommand{name, {}, {}} } }, // commands
-                        BucketAllocator{})
-                )
-            );
-    #endif
-        }
-        else
+        m_modelWrapper = LoadModel(model, m_jsonConfig ? &*m_jsonConfig : nullptr);
+        if (!m_modelWrapper)
         {
             m_logger->LogError("Expected a .json or .onnx file");
             return E_NOTIMPL;
@@ -268,6 +198,106 @@ HRESULT DxDispatch::RuntimeClassInitialize(
     return S_OK;
 } CATCH_RETURN();
 
+std::shared_ptr<Device> DxDispatch::CreateDevice(std::shared_ptr<PixCaptureHelper> pixCaptureHelper, IDxDispatchLogger* logger)
+{
+    return std::make_shared<Device>(
+        m_adapter.Get(),
+        D3D_FEATURE_LEVEL_1_0_GENERIC,
+        m_options->DmlFeatureLevel(),
+        m_options->DebugLayersEnabled(),
+        m_options->CommandListType(),
+        m_options->DispatchRepeat(),
+        m_options->GetUavBarrierAfterDispatch(),
+        m_options->GetAliasingBarrierAfterDispatch(),
+        m_options->ClearShaderCaches(),
+        m_options->DisableGpuTimeout(),
+        m_options->EnableDred(),
+        m_options->DisableBackgroundProcessing(),
+        m_options->SetStablePowerState(),
+        m_options->PreferCustomHeaps(),
+        m_options->GetPresentSeparator(),
+        m_options->MaxGpuTimeMeasurements(),
+        m_options->FramesInFlight(),
+        m_options->QueueCount(),
+        m_options->UseCopyQueueForUploads(),
+        pixCaptureHelper,
+        m_d3dModule,
+        m_dmlModule,
+        logger
+    );
+}
+
+std::unique_ptr<ModelWrapper> DxDispatch::LoadModel(const std::optional<std::filesystem::path>& modelPath, const std::string* jsonConfig)
+{
+    TraceScope trace("init", "parse model");
+
+    auto inputPath = m_options->InputPath();
+    auto outputPath = m_options->OutputPath();
+
+    if (!inputPath.has_value())
+    {
+        if (modelPath.has_value())
+        {
+            inputPath = modelPath.value().parent_path();
+        }
+        else
+        {
+            inputPath = std::filesystem::current_path();
+        }
+    }
+    if (!outputPath.has_value())
+    {
+        outputPath = std::filesystem::current_path();
+    }
+
+    if (jsonConfig)
+    {
+        std::string_view fileContent(*jsonConfig);
+
+        rapidjson::Document doc;
+
+        constexpr rapidjson::ParseFlag parseFlags = rapidjson::ParseFlag(
+            rapidjson::kParseFullPrecisionFlag |
+            rapidjson::kParseCommentsFlag |
+            rapidjson::kParseTrailingCommasFlag |
+            rapidjson::kParseStopWhenDoneFlag);
+
+        std::vector<char> input{ jsonConfig->begin(), jsonConfig->end() };
+        input.push_back('\0');
+        doc.ParseInsitu<parseFlags>(&input[0]);
+        return std::make_unique<ModelWrapper>(
+            JsonParsers::ParseModel(
+                doc,
+                fileContent,
+                inputPath.value(),
+                outputPath.value()));
+    }
+    else if (modelPath.value().extension() == ".json")
+    {
+        return std::make_unique<ModelWrapper>(JsonParsers::ParseModel(
+            modelPath.value(),
+            inputPath.value(),
+            outputPath.value()));
+    }
+    else if (modelPath.value().extension() == ".onnx")
+    {
+#ifdef ONNXRUNTIME_NONE
+        throw std::invalid_argument("ONNX dispatchables require ONNX Runtime");
+#else
+        auto name = modelPath.value().filename().string();
+        return std::make_unique<ModelWrapper>(
+            Model(
+                {}, // resource
+                { {name, Model::OnnxDispatchableDesc{modelPath.value()}} },  // dispatchables
+                { {"dispatch", name, Model::DispatchCommand{name, {}, {}} } }, // commands
+                BucketAllocator{})
+        );
+#endif
+    }
+
+    return nullptr;
+}
+
 HRESULT DxDispatch::RunAll() try
 {
     auto lock = std::scoped_lock(m_lock);
@@ -276,12 +306,21 @@ HRESULT DxDispatch::RunAll() try
         m_logger->LogError(fmt::format("{} called before initialize", __FUNCTION__).c_str());
         return E_UNEXPECTED;
     }
+    TraceRecorder::ActiveScope activeTrace(m_traceRecorder.get());
 
     try
     {
         RETURN_IF_FAILED(m_pixCaptureHelper->BeginCapturableWork());
-        m_executor = std::make_unique<Executor>(m_modelWrapper->Value(), m_device, *m_options, m_logger.Get());
-        m_executor->Run();
+        if (m_options->InstanceCount() > 1 || !m_options->ConcurrentModelPaths().empty())
+        {
+            RunConcurrentInstances();
+        }
+        else
+        {
+            // The executor is kept across runs, so running again (e.g. with new resource data) doesn't upload the
+            // model's resources or create its dispatchables again.
+            GetExecutor().Run();
+        }
         RETURN_IF_FAILED(m_pixCaptureHelper->EndCapturableWork());
     }
     catch(const std::exception& e)
@@ -294,6 +333,130 @@ HRESULT DxDispatch::RunAll() try
     
 } CATCH_RETURN();
 
+void DxDispatch::RunConcurrentInstances()
+{
+    struct Instance
+    {
+        std::string name;
+        std::unique_ptr<ModelWrapper> model;
+        std::shared_ptr<Device> device;
+        Microsoft::WRL::ComPtr<IDxDispatchLogger> logger;
+        std::unique_ptr<Executor> executor;
+        double durationInMilliseconds = 0;
+        std::exception_ptr error;
+    };
+
+    // The model is followed by the concurrent models, with every model repeated for each instance. The first instance
+    // uses the model and device that are already created; the others get their own device (and queues) on the same
+    // adapter, since a device records and submits work from one thread at a time.
+    std::vector<std::optional<std::filesystem::path>> modelPaths = { m_options->ModelPath() };
+    modelPaths.insert(modelPaths.end(), m_options->ConcurrentModelPaths().begin(), m_options->ConcurrentModelPaths().end());
+
+    auto logMutex = std::make_shared<std::mutex>();
+    std::vector<Instance> instances;
+    for (size_t modelIndex = 0; modelIndex < modelPaths.size(); modelIndex++)
+    {
+        auto& modelPath = modelPaths[modelIndex];
+        bool isMainModel = modelIndex == 0;
+        for (uint32_t copy = 0; copy < m_options->InstanceCount(); copy++)
+        {
+            Instance instance;
+            instance.name = modelPath ? modelPath->filename().string() : "model";
+            instance.logger = Microsoft::WRL::Make<DxDispatchPrefixedLogger>(
+                m_logger.Get(), 
+                fmt::format("[{}] ", instances.size()), 
+                logMutex);
+
+            if (instances.empty())
+            {
+                instance.device = m_device;
+            }
+            else
+            {
+                TraceScope trace("init", "create device");
+                auto pixCaptureHelper = std::make_shared<PixCaptureHelper>(PixCaptureType::None, m_options->PixCaptureName());
+                instance.device = CreateDevice(pixCaptureHelper, instance.logger.Get());
+            }
+
+            if (!instances.empty() || !isMainModel)
+            {
+                instance.model = LoadModel(modelPath, isMainModel && m_jsonConfig ? &*m_jsonConfig : nullptr);
+                if (!instance.model)
+                {
+                    throw std::invalid_argument(fmt::format("Expected a .json or .onnx file: '{}'", modelPath->string()));
+                }
+            }
+
+            auto& model = instance.model ? instance.model->Value() : m_modelWrapper->Value();
+            instance.executor = std::make_unique<Executor>(model, instance.device, *m_options, instance.logger.Get());
+            instances.push_back(std::move(instance));
+        }
+    }
+
+    // Instances are created (uploads and compilation) one at a time, then start running together.
+    std::promise<void> startSignal;
+    std::shared_future<void> start = startSignal.get_future().share();
+    std::vector<std::thread> threads;
+    for (auto& instance : instances)
+    {
+        threads.emplace_back([this, start, &instance]
+        {
+            TraceRecorder::ActiveScope activeTrace(m_traceRecorder.get());
+            start.wait();
+
+            auto startTime = std::chrono::steady_clock::now();
+            try
+            {
+                instance.executor->Run();
+            }
+            catch (...)
+            {
+                instance.error = std::current_exception();
+            }
+            instance.durationInMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+        });
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+    startSignal.set_value();
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    double durationInMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+    auto LogStats = [&](const std::string& label, const StreamingStats& stats, double milliseconds)
+    {
+        m_logger->LogInfo(fmt::format("{}: {} iterations, {:.2f} iterations/s, {:.4f} ms p50, {:.4f} ms p90, {:.4f} ms p99, {:.4f} ms max",
+            label,
+            stats.Count(),
+            milliseconds > 0 ? stats.Count() * 1000.0 / milliseconds : 0.0,
+            stats.Percentile(0.5),
+            stats.Percentile(0.9),
+            stats.Percentile(0.99),
+            stats.Count() > 0 ? stats.GetSummary().max : 0.0
+        ).c_str());
+    };
+
+    StreamingStats aggregateStats;
+    for (size_t i = 0; i < instances.size(); i++)
+    {
+        auto& stats = instances[i].executor->GetIterationStats();
+        LogStats(fmt::format("Instance {} '{}'", i, instances[i].name), stats, instances[i].durationInMilliseconds);
+        aggregateStats.Merge(stats);
+    }
+    LogStats(fmt::format("Aggregate ({} instances)", instances.size()), aggregateStats, durationInMilliseconds);
+
+    for (size_t i = 0; i < instances.size(); i++)
+    {
+        if (instances[i].error)
+        {
+            m_logger->LogError(fmt::format("Instance {} '{}' failed", i, instances[i].name).c_str());
+            std::rethrow_exception(instances[i].error);
+        }
+    }
+}
+
 UINT32 DxDispatch::GetCommandCount()
 {
     auto lock = std::scoped_lock(m_lock);
@@ -302,11 +465,8 @@ UINT32 DxDispatch::GetCommandCount()
         m_logger->LogError(fmt::format("{} called before initialize", __FUNCTION__).c_str());
         return E_UNEXPECTED;
     }
-    if (m_executor == nullptr)
-    {
-        m_executor = std::make_unique<Executor>(m_modelWrapper->Value(), m_device, *m_options, m_logger.Get());
-    }
-    return m_executor->GetCommandCount();
+    TraceRecorder::ActiveScope activeTrace(m_traceRecorder.get());
+    return GetExecutor().GetCommandCount();
 }
 
 HRESULT DxDispatch::RunCommand(
@@ -318,13 +478,11 @@ HRESULT DxDispatch::RunCommand(
         m_logger->LogError(fmt::format("{} called before initialize", __FUNCTION__).c_str());
         return E_UNEXPECTED;
     }
-    if (m_executor == nullptr)
-    {
-        m_executor = std::make_unique<Executor>(m_modelWrapper->Value(), m_device, *m_options, m_logger.Get());
-    }
+    TraceRecorder::ActiveScope activeTrace(m_traceRecorder.get());
+    auto& executor = GetExecutor();
     try
     {
-        m_executor->RunCommand(index);
+        executor.RunCommand(index);
     }
     catch(const std::exception& e)
     {
@@ -334,6 +492,24 @@ HRESULT DxDispatch::RunCommand(
     return S_OK;
 }  CATCH_RETURN();
 
+HRESULT DxDispatch::QueryInterface(
+    REFIID riid,
+    _COM_Outptr_  void **ppvObject)
+{
+    // IDxDispatch2 extends IDxDispatch, so the base interface is returned by the same pointer.
+    if (riid == __uuidof(IDxDispatch))
+    {
+        if (ppvObject == nullptr)
+        {
+            return E_POINTER;
+        }
+        *ppvObject = static_cast<IDxDispatch*>(this);
+        AddRef();
+        return S_OK;
+    }
+    return Microsoft::WRL::Base<IDxDispatch2>::QueryInterface(riid, ppvObject);
+}
+
 HRESULT DxDispatch::GetObject(
             REFGUID objectId,
             REFIID riid,
@@ -353,8 +529,208 @@ HRESULT DxDispatch::GetObject(
     }    
 } CATCH_RETURN();
 
+HRESULT DxDispatch::GetResourceSize(
+            _In_ PCSTR resourceName,
+            _Out_ UINT64* sizeInBytes) try
+{
+    RETURN_HR_IF_NULL(E_POINTER, resourceName);
+    RETURN_HR_IF_NULL(E_POINTER, sizeInBytes);
+    *sizeInBytes = 0;
+
+    auto lock = std::scoped_lock(m_lock);
+    if (nullptr == m_modelWrapper)
+    {
+        m_logger->LogError(fmt::format("{} called before initialize", __FUNCTION__).c_str());
+        return E_UNEXPECTED;
+    }
+    TraceRecorder::ActiveScope activeTrace(m_traceRecorder.get());
+    try
+    {
+        *sizeInBytes = GetExecutor().GetResourceSize(resourceName);
+    }
+    catch(const std::exception& e)
+    {
+        m_logger->LogError(fmt::format("Failed to get the size of resource '{}': {}", resourceName, e.what()).c_str());
+        throw;
+    }
+    return S_OK;
+} CATCH_RETURN();
+
+HRESULT DxDispatch::SetResourceData(
+            _In_ PCSTR resourceName,
+            _In_ const void* data,
+            UINT64 sizeInBytes) try
+{
+    RETURN_HR_IF_NULL(E_POINTER, resourceName);
+    RETURN_HR_IF_NULL(E_POINTER, data);
+    RETURN_HR_IF(E_INVALIDARG, sizeInBytes > std::numeric_limits<size_t>::max());
+
+    auto lock = std::scoped_lock(m_lock);
+    if (nullptr == m_modelWrapper)
+    {
+        m_logger->LogError(fmt::format("{} called before initialize", __FUNCTION__).c_str());
+        return E_UNEXPECTED;
+    }
+    TraceRecorder::ActiveScope activeTrace(m_traceRecorder.get());
+    try
+    {
+        // CPU-visible buffers are written directly, so earlier work that reads the resource must be finished.
+        auto& executor = GetExecutor();
+        m_device->WaitForGpuWorkToComplete();
+        executor.SetResourceData(resourceName, gsl::make_span(static_cast<const std::byte*>(data), static_cast<size_t>(sizeInBytes)));
+    }
+    catch(const std::exception& e)
+    {
+        m_logger->LogError(fmt::format("Failed to set resource '{}': {}", resourceName, e.what()).c_str());
+        throw;
+    }
+    return S_OK;
+} CATCH_RETURN();
+
+HRESULT DxDispatch::GetResourceData(
+            _In_ PCSTR resourceName,
+            _Out_ void* data,
+            UINT64 sizeInBytes) try
+{
+    RETURN_HR_IF_NULL(E_POINTER, resourceName);
+    RETURN_HR_IF_NULL(E_POINTER, data);
+
+    auto lock = std::scoped_lock(m_lock);
+    if (nullptr == m_modelWrapper)
+    {
+        m_logger->LogError(fmt::format("{} called before initialize", __FUNCTION__).c_str());
+        return E_UNEXPECTED;
+    }
+    TraceRecorder::ActiveScope activeTrace(m_traceRecorder.get());
+    try
+    {
+        auto contents = GetExecutor().GetResourceData(resourceName);
+        if (contents.size() > sizeInBytes)
+        {
+            throw std::invalid_argument(fmt::format("Resource '{}' is {} bytes, but the destination is only {} bytes", resourceName, contents.size(), sizeInBytes));
+        }
+        memcpy(data, contents.data(), contents.size());
+    }
+    catch(const std::exception& e)
+    {
+        m_logger->LogError(fmt::format("Failed to get resource '{}': {}", resourceName, e.what()).c_str());
+        throw;
+    }
+    return S_OK;
+} CATCH_RETURN();
+
+HRESULT DxDispatch::WrapResourceHostMemory(
+            _In_ PCSTR resourceName,
+            _In_ void* data,
+            UINT64 sizeInBytes) try
+{
+    RETURN_HR_IF_NULL(E_POINTER, resourceName);
+    RETURN_HR_IF_NULL(E_POINTER, data);
+
+    auto lock = std::scoped_lock(m_lock);
+    if (nullptr == m_modelWrapper)
+    {
+        m_logger->LogError(fmt::format("{} called before initialize", __FUNCTION__).c_str());
+        return E_UNEXPECTED;
+    }
+    TraceRecorder::ActiveScope activeTrace(m_traceRecorder.get());
+    try
+    {
+        // The replaced buffer is released, so it must not be in use.
+        auto& executor = GetExecutor();
+        m_device->WaitForGpuWorkToComplete();
+        executor.WrapResourceHostMemory(resourceName, data, sizeInBytes);
+    }
+    catch(const std::exception& e)
+    {
+        m_logger->LogError(fmt::format("Failed to wrap host memory for resource '{}': {}", resourceName, e.what()).c_str());
+        throw;
+    }
+    return S_OK;
+} CATCH_RETURN();
+
+Executor& DxDispatch::GetExecutor()
+{
+    if (m_executor == nullptr)
+    {
+        m_executor = std::make_unique<Executor>(m_modelWrapper->Value(), m_device, *m_options, m_logger.Get());
+    }
+    return *m_executor;
+}
+
+void DxDispatch::WriteTrace()
+{
+    if (!m_traceRecorder)
+    {
+        return;
+    }
+
+    auto& traceFilePath = m_options->TraceFilePath().value();
+    std::ofstream stream(traceFilePath, std::ios::out | std::ios::trunc);
+    m_traceRecorder->Write(stream);
+    stream.close();
+
+    if (stream)
+    {
+        m_logger->LogInfo(fmt::format("Trace written to '{}' ({} events)", traceFilePath.string(), m_traceRecorder->GetEventCount()).c_str());
+    }
+    else
+    {
+        m_logger->LogError(fmt::format("Failed to write trace to '{}'", traceFilePath.string()).c_str());
+    }
+}
+
+void DxDispatch::WriteMemoryReport()
+{
+    if (!m_options || !m_options->MemoryReportFilePath() || !m_device)
+    {
+        return;
+    }
+
+    auto& memoryReportFilePath = m_options->MemoryReportFilePath().value();
+    std::ofstream stream(memoryReportFilePath, std::ios::out | std::ios::trunc);
+    m_device->GetMemoryTracker().WriteJson(stream);
+    stream << "\n";
+    stream.close();
+
+    if (stream)
+    {
+        m_logger->LogInfo(fmt::format("Memory report written to '{}' ({} bytes peak)",
+            memoryReportFilePath.string(),
+            m_device->GetMemoryTracker().GetTotalUsage().peakInBytes).c_str());
+    }
+    else
+    {
+        m_logger->LogError(fmt::format("Failed to write memory report to '{}'", memoryReportFilePath.string()).c_str());
+    }
+}
+
 DxDispatch::~DxDispatch()
 {
+    // The executor is released first so that its remaining work (e.g. flushing file writes) is part of the trace.
+    {
+        TraceRecorder::ActiveScope activeTrace(m_traceRecorder.get());
+        m_executor.reset();
+    }
+
+    try
+    {
+        WriteTrace();
+    }
+    catch (const std::exception& e)
+    {
+        m_logger->LogError(fmt::format("Failed to write trace: {}", e.what()).c_str());
+    }
+
+    try
+    {
+        WriteMemoryReport();
+    }
+    catch (const std::exception& e)
+    {
+        m_logger->LogError(fmt::format("Failed to write memory report: {}", e.what()).c_str());
+    }
+
     // Ensure remaining D3D references are released before the D3D module is released,
     // regardless of normal exit or exception.
     m_modelWrapper.reset();
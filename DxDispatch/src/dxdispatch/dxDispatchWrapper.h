@@ -8,15 +8,17 @@ class PixCaptureHelper;
 class CommandLineArgs;
 class ModelWrapper;
 class Executor;
+class TraceRecorder;
 
 #ifdef WIN32
 extern ULONG AddDllRef();
 extern ULONG ReleaseDllRef();
 #else
 WINADAPTER_IID(IDxDispatch,       0x1D5837DF, 0x8496, 0x42A6, 0xAA, 0x5B, 0xAA, 0x0D, 0xD1, 0x27, 0xC3, 0xB4);
+WINADAPTER_IID(IDxDispatch2,      0x6A1E0B4C, 0x3F0D, 0x4C8E, 0x9B, 0x1A, 0x52, 0xD7, 0xE4, 0xF8, 0xC3, 0xA9);
 #endif
 
-class DxDispatch : public Microsoft::WRL::Base<IDxDispatch>
+class DxDispatch : public Microsoft::WRL::Base<IDxDispatch2>
 {
 public:
     static HRESULT STDMETHODCALLTYPE CreateDxDispatchFromJsonString(
@@ -35,6 +37,11 @@ public:
         _In_opt_        IAdapter* adapter,
         _In_opt_        IDxDispatchLogger* customLogger);
 
+    // IUnknown
+    HRESULT STDMETHODCALLTYPE QueryInterface(
+        REFIID riid,
+        _COM_Outptr_  void **ppvObject) override;
+
     // IDxDispatch
     HRESULT STDMETHODCALLTYPE  RunAll(
             ) final;
@@ -50,16 +57,45 @@ public:
         REFIID riid,
         _COM_Outptr_  void **ppvObject) final;
 
+    // IDxDispatch2
+    HRESULT STDMETHODCALLTYPE GetResourceSize(
+        _In_ PCSTR resourceName,
+        _Out_ UINT64* sizeInBytes) final;
+
+    HRESULT STDMETHODCALLTYPE SetResourceData(
+        _In_ PCSTR resourceName,
+        _In_ const void* data,
+        UINT64 sizeInBytes) final;
+
+    HRESULT STDMETHODCALLTYPE GetResourceData(
+        _In_ PCSTR resourceName,
+        _Out_ void* data,
+        UINT64 sizeInBytes) final;
+
+    HRESULT STDMETHODCALLTYPE WrapResourceHostMemory(
+        _In_ PCSTR resourceName,
+        _In_ void* data,
+        UINT64 sizeInBytes) final;
+
 protected:
 
     virtual ~DxDispatch();
 
+    void WriteTrace();
+    void WriteMemoryReport();
+    Executor& GetExecutor();
+    std::shared_ptr<Device> CreateDevice(std::shared_ptr<PixCaptureHelper> pixCaptureHelper, IDxDispatchLogger* logger);
+    std::unique_ptr<ModelWrapper> LoadModel(const std::optional<std::filesystem::path>& modelPath, const std::string* jsonConfig);
+    void RunConcurrentInstances();
+
     std::mutex                                  m_lock;
     UINT32                                      m_currentIndex = 0;
     UINT32                                      m_commandCount = 0;
 
     Microsoft::WRL::ComPtr<IDxDispatchLogger>   m_logger;
     std::unique_ptr<ModelWrapper>               m_modelWrapper;
+    std::optional<std::string>                  m_jsonConfig;
+    Microsoft::WRL::ComPtr<IAdapter>            m_adapter;
     std::shared_ptr<Device>                     m_device;
     std::shared_ptr<DmlModule>                  m_dmlModule;
     std::shared_ptr<D3d12Module>                m_d3dModule;
@@ -67,4 +103,5 @@ protected:
     std::shared_ptr<PixCaptureHelper>           m_pixCaptureHelper;
     std::shared_ptr<CommandLineArgs>            m_options;
     std::shared_ptr<Executor>                   m_executor;
+    std::unique_ptr<TraceRecorder>              m_traceRecorder;
 };
\ No newline at end of file
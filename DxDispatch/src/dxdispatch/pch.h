@@ -25,7 +25,9 @@
 #include <numeric>
 #include <thread>
 #include <mutex>
+#include <future>
 #include <map>
+#include <deque>
 
 #ifndef _WIN32
 #include <wsl/winadapter.h>
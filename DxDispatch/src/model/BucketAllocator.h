@@ -54,6 +54,16 @@ public:
         return reinterpret_cast<T*>(memory);
     }
 
+    size_t GetCapacityInBytes() const
+    {
+        size_t capacity = 0;
+        for (auto& bucket : m_buckets)
+        {
+            capacity += bucket.capacity;
+        }
+        return capacity;
+    }
+
 private:
     struct Bucket
     {
@@ -107,4 +107,17 @@ Model::Model(
             },
             command);
     }
-}
\ No newline at end of file
+}
+
+uint64_t Model::GetHostPayloadSizeInBytes() const
+{
+    uint64_t sizeInBytes = m_allocator.GetCapacityInBytes();
+    for (auto& resourceDesc : m_resourceDescs)
+    {
+        if (auto bufferDesc = std::get_if<BufferDesc>(&resourceDesc.value))
+        {
+            sizeInBytes += bufferDesc->initialValues.size();
+        }
+    }
+    return sizeInBytes;
+}
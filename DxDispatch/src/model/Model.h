@@ -176,6 +176,9 @@ public:
     const ResourceDesc& GetResource(std::string_view name) const { return *m_resourceDescsByName.find(name.data())->second; }
     const DispatchableDesc& GetDispatchable(std::string_view name) const { return *m_dispatchableDescsByName.find(name.data())->second; }
 
+    // Host memory of the resources' initial values and the allocator (e.g. operator descs).
+    uint64_t GetHostPayloadSizeInBytes() const;
+
 private:
     std::vector<ResourceDesc> m_resourceDescs;
     std::vector<DispatchableDesc> m_dispatchableDescs;
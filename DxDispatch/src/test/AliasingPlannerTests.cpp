@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include <random>
+#include "AliasingPlanner.h"
+
+// Returns true if no two buffers that are live at the same step occupy overlapping heap ranges.
+static bool IsValidPlan(const std::vector<AliasingPlanner::Buffer>& buffers, const AliasingPlanner::Plan& plan)
+{
+    for (size_t a = 0; a < buffers.size(); a++)
+    {
+        if (plan.offsets[a] + buffers[a].sizeInBytes > plan.heapSizeInBytes)
+        {
+            return false;
+        }
+
+        for (size_t b = a + 1; b < buffers.size(); b++)
+        {
+            bool liveTogether = buffers[a].firstUse <= buffers[b].lastUse && buffers[b].firstUse <= buffers[a].lastUse;
+            bool sameMemory = plan.offsets[a] < plan.offsets[b] + buffers[b].sizeInBytes && plan.offsets[b] < plan.offsets[a] + buffers[a].sizeInBytes;
+            if (liveTogether && sameMemory)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// AliasingPlanner
+// ----------------------------------------------------------------------------
+
+TEST(AliasingPlannerTest, DisjointLifetimesShareMemory)
+{
+    AliasingPlanner planner(1);
+    planner.AddBuffer(100, 0, 1);
+    planner.AddBuffer(100, 2, 3);
+    planner.AddBuffer(100, 4, 4);
+
+    auto plan = planner.CreatePlan();
+    EXPECT_EQ(plan.offsets, (std::vector<uint64_t>{ 0, 0, 0 }));
+    EXPECT_EQ(plan.heapSizeInBytes, 100u);
+    EXPECT_EQ(plan.unaliasedSizeInBytes, 300u);
+    EXPECT_EQ(plan.peakLiveSizeInBytes, 100u);
+}
+
+TEST(AliasingPlannerTest, OverlappingLifetimesDontShareMemory)
+{
+    AliasingPlanner planner(1);
+    planner.AddBuffer(100, 0, 2);
+    planner.AddBuffer(50, 2, 3);
+
+    auto plan = planner.CreatePlan();
+    EXPECT_EQ(plan.offsets, (std::vector<uint64_t>{ 0, 100 }));
+    EXPECT_EQ(plan.heapSizeInBytes, 150u);
+    EXPECT_EQ(plan.peakLiveSizeInBytes, 150u);
+}
+
+TEST(AliasingPlannerTest, SizesAndOffsetsAreAligned)
+{
+    AliasingPlanner planner(64);
+    planner.AddBuffer(1, 0, 0);
+    planner.AddBuffer(65, 0, 0);
+
+    auto plan = planner.CreatePlan();
+    EXPECT_EQ(plan.offsets, (std::vector<uint64_t>{ 128, 0 }));
+    EXPECT_EQ(plan.heapSizeInBytes, 192u);
+    EXPECT_EQ(plan.unaliasedSizeInBytes, 192u);
+}
+
+TEST(AliasingPlannerTest, SmallBufferFillsBestFittingGap)
+{
+    // A, C, and F stay live throughout. Once B and D end, they leave gaps of 80 bytes (100-179) and 40 bytes
+    // (250-289) between them, and E fits into the smaller one.
+    std::vector<AliasingPlanner::Buffer> buffers = 
+    {
+        { 100, 0, 3 },  // A
+        { 80, 0, 0 },   // B
+        { 70, 0, 3 },   // C
+        { 40, 0, 0 },   // D
+        { 30, 0, 3 },   // F
+        { 30, 1, 3 },   // E
+    };
+
+    AliasingPlanner planner(1);
+    for (auto& buffer : buffers)
+    {
+        planner.AddBuffer(buffer.sizeInBytes, buffer.firstUse, buffer.lastUse);
+    }
+
+    auto plan = planner.CreatePlan();
+    EXPECT_TRUE(IsValidPlan(buffers, plan));
+    EXPECT_EQ(plan.offsets, (std::vector<uint64_t>{ 0, 100, 180, 250, 290, 250 }));
+    EXPECT_EQ(plan.heapSizeInBytes, 320u);
+    EXPECT_EQ(plan.peakLiveSizeInBytes, 320u);
+}
+
+TEST(AliasingPlannerTest, EmptyPlan)
+{
+    AliasingPlanner planner(65536);
+    auto plan = planner.CreatePlan();
+    EXPECT_TRUE(plan.offsets.empty());
+    EXPECT_EQ(plan.heapSizeInBytes, 0u);
+    EXPECT_EQ(plan.peakLiveSizeInBytes, 0u);
+}
+
+TEST(AliasingPlannerTest, InvalidArguments)
+{
+    EXPECT_THROW(AliasingPlanner(0), std::invalid_argument);
+
+    AliasingPlanner planner(1);
+    EXPECT_THROW(planner.AddBuffer(1, 2, 1), std::invalid_argument);
+}
+
+TEST(AliasingPlannerTest, RandomPlansAreValid)
+{
+    std::mt19937 random(1);
+    for (int trial = 0; trial < 100; trial++)
+    {
+        AliasingPlanner planner(16);
+        std::vector<AliasingPlanner::Buffer> buffers;
+        for (int i = 0; i < 30; i++)
+        {
+            uint32_t firstUse = random() % 20;
+            uint32_t lastUse = firstUse + random() % 5;
+            uint64_t size = 16 * (1 + random() % 8);
+            planner.AddBuffer(size, firstUse, lastUse);
+            buffers.push_back({ size, firstUse, lastUse });
+        }
+
+        auto plan = planner.CreatePlan();
+        ASSERT_TRUE(IsValidPlan(buffers, plan));
+        EXPECT_GE(plan.heapSizeInBytes, plan.peakLiveSizeInBytes);
+        EXPECT_LE(plan.heapSizeInBytes, plan.unaliasedSizeInBytes);
+    }
+}
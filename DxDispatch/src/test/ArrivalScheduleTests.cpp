@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <sstream>
+#include "ArrivalSchedule.h"
+
+// ----------------------------------------------------------------------------
+// ArrivalSchedule
+// ----------------------------------------------------------------------------
+
+static std::vector<double> TakeArrivals(ArrivalSchedule schedule, size_t count)
+{
+    std::vector<double> arrivals;
+    for (size_t i = 0; i < count; i++)
+    {
+        arrivals.push_back(schedule.NextArrivalTime());
+    }
+    return arrivals;
+}
+
+TEST(ArrivalScheduleTest, ConstantArrivalsAreEvenlySpaced)
+{
+    auto arrivals = TakeArrivals(ArrivalSchedule::Constant(250), 4);
+    EXPECT_EQ(arrivals, (std::vector<double>{ 0, 4, 8, 12 }));
+}
+
+TEST(ArrivalScheduleTest, PoissonArrivalsHaveMeanRate)
+{
+    size_t count = 100000;
+    auto arrivals = TakeArrivals(ArrivalSchedule::Poisson(500, 1), count);
+    EXPECT_EQ(arrivals[0], 0.0);
+
+    // The mean interval is 2 ms, and exponential intervals have a standard deviation equal to their mean.
+    double meanInterval = arrivals.back() / (count - 1);
+    EXPECT_NEAR(meanInterval, 2.0, 0.05);
+
+    double variance = 0;
+    for (size_t i = 1; i < count; i++)
+    {
+        EXPECT_GE(arrivals[i], arrivals[i - 1]);
+        double deviation = arrivals[i] - arrivals[i - 1] - meanInterval;
+        variance += deviation * deviation / (count - 1);
+    }
+    EXPECT_NEAR(std::sqrt(variance), 2.0, 0.1);
+}
+
+TEST(ArrivalScheduleTest, PoissonArrivalsAreReproducible)
+{
+    EXPECT_EQ(TakeArrivals(ArrivalSchedule::Poisson(100, 7), 50), TakeArrivals(ArrivalSchedule::Poisson(100, 7), 50));
+    EXPECT_NE(TakeArrivals(ArrivalSchedule::Poisson(100, 7), 50), TakeArrivals(ArrivalSchedule::Poisson(100, 8), 50));
+}
+
+TEST(ArrivalScheduleTest, InvalidRatesThrow)
+{
+    EXPECT_THROW(ArrivalSchedule::Constant(0), std::invalid_argument);
+    EXPECT_THROW(ArrivalSchedule::Poisson(-1, 0), std::invalid_argument);
+    EXPECT_THROW(ArrivalSchedule::FromTrace({ 1 }, 0.0), std::invalid_argument);
+}
+
+TEST(ArrivalScheduleTest, TraceRepeats)
+{
+    auto arrivals = TakeArrivals(ArrivalSchedule::FromTrace({ 1, 3 }, std::nullopt), 5);
+    EXPECT_EQ(arrivals, (std::vector<double>{ 0, 1, 4, 5, 8 }));
+}
+
+TEST(ArrivalScheduleTest, TraceIsScaledToRate)
+{
+    // The trace's mean interval is 2 ms (500/s); at 1000/s its intervals are halved.
+    auto arrivals = TakeArrivals(ArrivalSchedule::FromTrace({ 1, 3 }, 1000.0), 4);
+    EXPECT_EQ(arrivals, (std::vector<double>{ 0, 0.5, 2, 2.5 }));
+
+    EXPECT_THROW(ArrivalSchedule::FromTrace({ 0, 0 }, 1000.0), std::invalid_argument);
+    EXPECT_THROW(ArrivalSchedule::FromTrace({}, std::nullopt), std::invalid_argument);
+}
+
+TEST(ArrivalScheduleTest, ParseTrace)
+{
+    std::istringstream trace("# intervals in ms\n1.5\n\n  2 \r\n0\n");
+    EXPECT_EQ(ArrivalSchedule::ParseTrace(trace), (std::vector<double>{ 1.5, 2, 0 }));
+
+    for (auto invalidTrace : { "1\nabc\n", "1 2\n", "-1\n", "nan\n" })
+    {
+        std::istringstream stream(invalidTrace);
+        EXPECT_THROW(ArrivalSchedule::ParseTrace(stream), std::invalid_argument) << invalidTrace;
+    }
+}
@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include "BackgroundFileWriter.h"
+
+// ----------------------------------------------------------------------------
+// BackgroundFileWriter
+// ----------------------------------------------------------------------------
+
+class BackgroundFileWriterTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        auto testName = ::testing::UnitTest::GetInstance()->current_test_info()->name();
+        m_directory = std::filesystem::temp_directory_path() / "BackgroundFileWriterTest" / testName;
+        std::filesystem::remove_all(m_directory);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(m_directory);
+    }
+
+    static std::vector<std::byte> MakeData(size_t sizeInBytes, uint8_t seed)
+    {
+        std::vector<std::byte> data(sizeInBytes);
+        for (size_t i = 0; i < sizeInBytes; i++)
+        {
+            data[i] = static_cast<std::byte>(seed + i);
+        }
+        return data;
+    }
+
+    static std::vector<std::byte> ReadFile(const std::filesystem::path& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        std::vector<char> contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        std::vector<std::byte> data(contents.size());
+        memcpy(data.data(), contents.data(), contents.size());
+        return data;
+    }
+
+    std::filesystem::path m_directory;
+};
+
+TEST_F(BackgroundFileWriterTest, WritesFilesInOrder)
+{
+    BackgroundFileWriter writer(1024);
+
+    // Small files are written with stream buffering, large ones without.
+    std::vector<std::vector<std::byte>> contents =
+    {
+        MakeData(16, 1),
+        MakeData(BackgroundFileWriter::c_unbufferedWriteThreshold + 3, 2),
+        MakeData(0, 3),
+    };
+
+    for (size_t i = 0; i < contents.size(); i++)
+    {
+        writer.Write(m_directory / "nested" / std::to_string(i), contents[i]);
+    }
+
+    auto results = writer.Flush();
+    ASSERT_EQ(results.size(), contents.size());
+    for (size_t i = 0; i < contents.size(); i++)
+    {
+        EXPECT_EQ(results[i].path, m_directory / "nested" / std::to_string(i));
+        EXPECT_TRUE(results[i].error.empty());
+        EXPECT_EQ(ReadFile(results[i].path), contents[i]);
+    }
+
+    EXPECT_EQ(writer.WrittenBytes(), 16 + BackgroundFileWriter::c_unbufferedWriteThreshold + 3);
+
+    // Results are only returned once.
+    EXPECT_TRUE(writer.Flush().empty());
+}
+
+TEST_F(BackgroundFileWriterTest, ReplacesExistingFile)
+{
+    BackgroundFileWriter writer(1024);
+    writer.Write(m_directory / "file", MakeData(64, 1));
+    writer.Write(m_directory / "file", MakeData(8, 2));
+    writer.Flush();
+
+    EXPECT_EQ(ReadFile(m_directory / "file"), MakeData(8, 2));
+}
+
+TEST_F(BackgroundFileWriterTest, ReportsErrors)
+{
+    BackgroundFileWriter writer(1024);
+
+    // A directory can't be opened as a file.
+    std::filesystem::create_directories(m_directory / "directory");
+    writer.Write(m_directory / "directory", MakeData(4, 1));
+    writer.Write(m_directory / "file", MakeData(4, 2));
+
+    auto results = writer.Flush();
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_FALSE(results[0].error.empty());
+    EXPECT_TRUE(results[1].error.empty());
+    EXPECT_EQ(writer.WrittenBytes(), 4u);
+}
+
+TEST_F(BackgroundFileWriterTest, WritesLargerThanBudgetAreAccepted)
+{
+    // Every write exceeds the budget, so each one waits for the previous one to finish.
+    BackgroundFileWriter writer(4);
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        writer.Write(m_directory / std::to_string(i), MakeData(64, i));
+    }
+
+    auto results = writer.Flush();
+    ASSERT_EQ(results.size(), 8u);
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        EXPECT_EQ(ReadFile(m_directory / std::to_string(i)), MakeData(64, i));
+    }
+    EXPECT_GE(writer.BlockedMilliseconds(), 0.0);
+}
+
+TEST_F(BackgroundFileWriterTest, DestructorFinishesQueuedWrites)
+{
+    {
+        BackgroundFileWriter writer(1024 * 1024);
+        for (uint8_t i = 0; i < 16; i++)
+        {
+            writer.Write(m_directory / std::to_string(i), MakeData(1024, i));
+        }
+    }
+
+    for (uint8_t i = 0; i < 16; i++)
+    {
+        EXPECT_EQ(ReadFile(m_directory / std::to_string(i)), MakeData(1024, i));
+    }
+}
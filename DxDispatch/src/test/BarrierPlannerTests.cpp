@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include "BarrierPlanner.h"
+
+using ResourceHandle = BarrierPlanner::ResourceHandle;
+
+// Distinct fake resource handles.
+static int a, b, c, heap;
+static const ResourceHandle A = &a, B = &b, C = &c, Heap = &heap;
+
+static BarrierPlanner::Access Read(ResourceHandle resource, ResourceHandle aliasingKey = nullptr)
+{
+    return { resource, false, aliasingKey };
+}
+
+static BarrierPlanner::Access Write(ResourceHandle resource, ResourceHandle aliasingKey = nullptr)
+{
+    return { resource, true, aliasingKey };
+}
+
+// ----------------------------------------------------------------------------
+// BarrierPlanner
+// ----------------------------------------------------------------------------
+
+TEST(BarrierPlannerTest, FirstDispatchNeedsNoBarriers)
+{
+    BarrierPlanner planner;
+    EXPECT_TRUE(planner.AddDispatch({ Read(A), Write(B) }).empty());
+}
+
+TEST(BarrierPlannerTest, ReadAfterWrite)
+{
+    BarrierPlanner planner;
+    planner.AddDispatch({ Read(A), Write(B) });
+
+    auto barriers = planner.AddDispatch({ Read(B), Write(C) });
+    EXPECT_EQ(barriers.uav, (std::vector<ResourceHandle>{ B }));
+    EXPECT_TRUE(barriers.aliasing.empty());
+}
+
+TEST(BarrierPlannerTest, WriteAfterWriteAndWriteAfterRead)
+{
+    BarrierPlanner planner;
+    planner.AddDispatch({ Read(A), Write(B) });
+
+    // Repeating the same dispatch rewrites B; writing A is a hazard with the earlier read.
+    EXPECT_EQ(planner.AddDispatch({ Read(A), Write(B) }).uav, (std::vector<ResourceHandle>{ B }));
+    EXPECT_EQ(planner.AddDispatch({ Write(A) }).uav, (std::vector<ResourceHandle>{ A }));
+}
+
+TEST(BarrierPlannerTest, IndependentDispatchesOverlap)
+{
+    BarrierPlanner planner;
+    planner.AddDispatch({ Read(A), Write(B) });
+
+    // Concurrent reads aren't hazards, and C is untouched by the first dispatch.
+    EXPECT_TRUE(planner.AddDispatch({ Read(A), Write(C) }).empty());
+    EXPECT_EQ(planner.BarrierCount(), 0u);
+}
+
+TEST(BarrierPlannerTest, BarriersAreBatchedAndResolveHazards)
+{
+    BarrierPlanner planner;
+    planner.AddDispatch({ Write(A) });
+    planner.AddDispatch({ Write(B) });
+
+    // Both hazards are resolved by a single batch, listed once per resource.
+    auto barriers = planner.AddDispatch({ Read(A), Read(B), Read(A) });
+    EXPECT_EQ(barriers.uav, (std::vector<ResourceHandle>{ A, B }));
+
+    // Reading again after the barrier is not a hazard.
+    EXPECT_TRUE(planner.AddDispatch({ Read(A), Read(B) }).empty());
+    EXPECT_EQ(planner.BarrierCount(), 2u);
+}
+
+TEST(BarrierPlannerTest, AliasedResourcesNeedAliasingBarriers)
+{
+    BarrierPlanner planner;
+    planner.AddDispatch({ Write(A, Heap) });
+
+    // B occupies the same memory as A, so switching to it needs an aliasing barrier (and no UAV barrier).
+    auto barriers = planner.AddDispatch({ Write(B, Heap) });
+    EXPECT_TRUE(barriers.uav.empty());
+    ASSERT_EQ(barriers.aliasing.size(), 1u);
+    EXPECT_EQ(barriers.aliasing[0].before, A);
+    EXPECT_EQ(barriers.aliasing[0].after, B);
+
+    // Continuing to use B is an ordinary UAV hazard.
+    barriers = planner.AddDispatch({ Read(B, Heap) });
+    EXPECT_EQ(barriers.uav, (std::vector<ResourceHandle>{ B }));
+    EXPECT_TRUE(barriers.aliasing.empty());
+}
+
+TEST(BarrierPlannerTest, ResetForgetsPendingAccesses)
+{
+    BarrierPlanner planner;
+    planner.AddDispatch({ Write(A, Heap) });
+    planner.Reset();
+    EXPECT_TRUE(planner.AddDispatch({ Read(A) }).empty());
+    EXPECT_TRUE(planner.AddDispatch({ Read(B, Heap) }).empty());
+}
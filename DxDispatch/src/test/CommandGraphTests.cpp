@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include "CommandGraph.h"
+
+using ResourceHandle = CommandGraph::ResourceHandle;
+
+// Distinct fake resource handles.
+static int x, y, z, w;
+static const ResourceHandle X = &x, Y = &y, Z = &z, W = &w;
+
+static CommandGraph::Access Read(ResourceHandle resource)
+{
+    return { resource, false };
+}
+
+static CommandGraph::Access Write(ResourceHandle resource)
+{
+    return { resource, true };
+}
+
+static std::vector<uint32_t> GetQueues(const CommandGraph::Schedule& schedule)
+{
+    std::vector<uint32_t> queues;
+    for (auto& node : schedule.nodes)
+    {
+        queues.push_back(node.queue);
+    }
+    return queues;
+}
+
+// ----------------------------------------------------------------------------
+// CommandGraph
+// ----------------------------------------------------------------------------
+
+TEST(CommandGraphTest, DependenciesFollowHazards)
+{
+    CommandGraph graph;
+    graph.AddNode({ Write(X) });           // 0
+    graph.AddNode({ Read(X), Write(Y) });  // 1: RAW on X
+    graph.AddNode({ Read(X), Write(Z) });  // 2: RAW on X
+    graph.AddNode({ Write(X) });           // 3: WAW on X, WAR with 1 and 2
+    graph.AddNode({ Read(W) });            // 4: independent
+
+    EXPECT_EQ(graph.Dependencies(1), (std::vector<size_t>{ 0 }));
+    EXPECT_EQ(graph.Dependencies(2), (std::vector<size_t>{ 0 }));
+    EXPECT_EQ(graph.Dependencies(3), (std::vector<size_t>{ 0, 1, 2 }));
+    EXPECT_TRUE(graph.Dependencies(4).empty());
+}
+
+TEST(CommandGraphTest, UnrolledIterationDependsOnPreviousIteration)
+{
+    // Adding the commands twice gives the hazards between consecutive iterations, including write-after-read
+    // hazards with later commands of the previous iteration.
+    std::vector<std::vector<CommandGraph::Access>> commands = {
+        { Read(X), Write(Y) },  // 0
+        { Read(Y), Write(Z) },  // 1
+        { Read(W) },            // 2
+    };
+
+    CommandGraph graph;
+    for (int iteration = 0; iteration < 2; iteration++)
+    {
+        for (auto& accesses : commands)
+        {
+            graph.AddNode(accesses);
+        }
+    }
+
+    EXPECT_EQ(graph.Dependencies(3), (std::vector<size_t>{ 0, 1 }));  // WAW with 0, WAR with 1 (on Y)
+    EXPECT_EQ(graph.Dependencies(4), (std::vector<size_t>{ 1, 3 }));  // WAW with 1, RAW with 3
+    EXPECT_TRUE(graph.Dependencies(5).empty());
+}
+
+TEST(CommandGraphTest, ChainStaysOnOneQueue)
+{
+    CommandGraph graph;
+    graph.AddNode({ Write(X) });
+    graph.AddNode({ Read(X), Write(Y) });
+    graph.AddNode({ Read(Y), Write(Z) });
+
+    auto schedule = graph.ScheduleOnQueues(4);
+    EXPECT_EQ(GetQueues(schedule), (std::vector<uint32_t>{ 0, 0, 0 }));
+    EXPECT_EQ(schedule.waitCount, 0u);
+    EXPECT_EQ(schedule.makespan, 3.0);
+    EXPECT_EQ(graph.CriticalPath(), graph.TotalWork());
+}
+
+TEST(CommandGraphTest, IndependentCommandsRunConcurrently)
+{
+    CommandGraph graph;
+    graph.AddNode({ Read(W), Write(X) }, 2.0);
+    graph.AddNode({ Read(W), Write(Y) }, 3.0);
+
+    auto schedule = graph.ScheduleOnQueues(2);
+    EXPECT_EQ(GetQueues(schedule), (std::vector<uint32_t>{ 0, 1 }));
+    EXPECT_EQ(schedule.waitCount, 0u);
+    EXPECT_EQ(schedule.makespan, 3.0);
+    EXPECT_EQ(graph.CriticalPath(), 3.0);
+    EXPECT_EQ(graph.TotalWork(), 5.0);
+
+    // A single queue executes everything serially.
+    EXPECT_EQ(graph.ScheduleOnQueues(1).makespan, 5.0);
+    EXPECT_THROW(graph.ScheduleOnQueues(0), std::invalid_argument);
+}
+
+TEST(CommandGraphTest, DiamondWaitsOnlyAcrossQueues)
+{
+    CommandGraph graph;
+    graph.AddNode({ Write(X) });                    // 0
+    graph.AddNode({ Read(X), Write(Y) });           // 1
+    graph.AddNode({ Read(X), Write(Z) });           // 2
+    graph.AddNode({ Read(Y), Read(Z), Write(W) });  // 3
+
+    auto schedule = graph.ScheduleOnQueues(2);
+    EXPECT_EQ(GetQueues(schedule), (std::vector<uint32_t>{ 0, 0, 1, 0 }));
+
+    // Node 2 waits for node 0 on the other queue, and node 3 waits for node 2.
+    ASSERT_EQ(schedule.nodes[2].waits.size(), 1u);
+    EXPECT_EQ(schedule.nodes[2].waits[0].queue, 0u);
+    EXPECT_EQ(schedule.nodes[2].waits[0].node, 0u);
+    ASSERT_EQ(schedule.nodes[3].waits.size(), 1u);
+    EXPECT_EQ(schedule.nodes[3].waits[0].queue, 1u);
+    EXPECT_EQ(schedule.nodes[3].waits[0].node, 2u);
+    EXPECT_EQ(schedule.waitCount, 2u);
+    EXPECT_EQ(schedule.makespan, 3.0);
+    EXPECT_EQ(graph.CriticalPath(), 3.0);
+}
+
+TEST(CommandGraphTest, KnownCompletionsAreNotWaitedOnAgain)
+{
+    CommandGraph graph;
+    graph.AddNode({ Write(X) }, 1.0);                      // 0: queue 0
+    graph.AddNode({ Write(Y) }, 1.0);                      // 1: queue 1
+    graph.AddNode({ Read(X), Read(Y), Write(Z) }, 1.0);    // 2: queue 0, waits for 1
+    graph.AddNode({ Write(W) }, 5.0);                      // 3: queue 1 (idle first)
+    graph.AddNode({ Read(Y), Read(Z) }, 1.0);              // 4: queue 0, already knows 1 completed
+
+    auto schedule = graph.ScheduleOnQueues(2);
+    EXPECT_EQ(GetQueues(schedule), (std::vector<uint32_t>{ 0, 1, 0, 1, 0 }));
+    EXPECT_EQ(schedule.nodes[2].waits.size(), 1u);
+    EXPECT_TRUE(schedule.nodes[4].waits.empty());
+    EXPECT_EQ(schedule.waitCount, 1u);
+}
+
+TEST(CommandGraphTest, KnownCompletionsAreTransitive)
+{
+    CommandGraph graph;
+    graph.AddNode({ Write(X) }, 1.0);               // 0: queue 0
+    graph.AddNode({ Read(X), Write(W) }, 10.0);     // 1: queue 0
+    graph.AddNode({ Read(X), Write(Y) }, 1.0);      // 2: queue 1, waits for 0
+    graph.AddNode({ Read(Y), Write(Z) }, 10.0);     // 3: queue 1
+    graph.AddNode({ Read(X), Read(Y) }, 1.0);       // 4: queue 2, waits for 2 (which implies 0)
+
+    auto schedule = graph.ScheduleOnQueues(3);
+    EXPECT_EQ(GetQueues(schedule), (std::vector<uint32_t>{ 0, 0, 1, 1, 2 }));
+    ASSERT_EQ(schedule.nodes[2].waits.size(), 1u);
+    EXPECT_EQ(schedule.nodes[2].waits[0].node, 0u);
+    ASSERT_EQ(schedule.nodes[4].waits.size(), 1u);
+    EXPECT_EQ(schedule.nodes[4].waits[0].node, 2u);
+    EXPECT_EQ(schedule.waitCount, 2u);
+}
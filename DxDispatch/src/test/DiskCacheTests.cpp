@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include "DiskCache.h"
+
+// ----------------------------------------------------------------------------
+// CacheEntryWriter / CacheEntryReader
+// ----------------------------------------------------------------------------
+
+TEST(CacheEntryTest, ValuesRoundTrip)
+{
+    CacheEntryWriter writer;
+    writer.Write<uint32_t>(7);
+    writer.WriteString("name");
+    std::vector<std::byte> bytes = { std::byte(1), std::byte(2), std::byte(3) };
+    writer.WriteArray(bytes.data(), bytes.size());
+    writer.Write<double>(0.5);
+
+    CacheEntryReader reader(writer.Data());
+    EXPECT_EQ(reader.Read<uint32_t>(), 7u);
+    EXPECT_EQ(reader.ReadString(), "name");
+    EXPECT_EQ(reader.ReadArray(), bytes);
+    EXPECT_FALSE(reader.AtEnd());
+    EXPECT_EQ(reader.Read<double>(), 0.5);
+    EXPECT_TRUE(reader.AtEnd());
+}
+
+TEST(CacheEntryTest, TruncatedValuesThrow)
+{
+    CacheEntryWriter writer;
+    writer.WriteString("name");
+    auto data = writer.Data();
+    data.pop_back();
+
+    CacheEntryReader reader(data);
+    EXPECT_THROW(reader.ReadString(), std::runtime_error);
+
+    std::vector<std::byte> empty;
+    CacheEntryReader emptyReader(empty);
+    EXPECT_THROW(emptyReader.Read<uint32_t>(), std::runtime_error);
+}
+
+// ----------------------------------------------------------------------------
+// DiskCache
+// ----------------------------------------------------------------------------
+
+class DiskCacheTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        m_directory = std::filesystem::temp_directory_path() / 
+            ("DiskCacheTest_" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()));
+        std::filesystem::remove_all(m_directory);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(m_directory);
+    }
+
+    static std::vector<std::byte> Bytes(size_t size, uint8_t value)
+    {
+        return std::vector<std::byte>(size, std::byte(value));
+    }
+
+    std::vector<std::filesystem::path> Files() const
+    {
+        std::vector<std::filesystem::path> files;
+        for (auto& entry : std::filesystem::directory_iterator(m_directory))
+        {
+            files.push_back(entry.path());
+        }
+        return files;
+    }
+
+    std::filesystem::path m_directory;
+};
+
+TEST_F(DiskCacheTest, StoredValuesAreLoaded)
+{
+    DiskCache cache(m_directory, 1024 * 1024);
+    EXPECT_FALSE(cache.Load("a").has_value());
+
+    EXPECT_TRUE(cache.Store("a", Bytes(10, 1)));
+    EXPECT_TRUE(cache.Store("b", Bytes(0, 0)));
+    EXPECT_EQ(cache.Load("a"), Bytes(10, 1));
+    EXPECT_EQ(cache.Load("b"), Bytes(0, 0));
+
+    // Entries persist across cache instances, and replacing an entry leaves no temporary files behind.
+    DiskCache other(m_directory, 1024 * 1024);
+    EXPECT_TRUE(other.Store("a", Bytes(5, 2)));
+    EXPECT_EQ(cache.Load("a"), Bytes(5, 2));
+    EXPECT_EQ(Files().size(), 2u);
+}
+
+TEST_F(DiskCacheTest, DamagedEntriesMiss)
+{
+    DiskCache cache(m_directory, 1024 * 1024);
+    ASSERT_TRUE(cache.Store("a", Bytes(100, 1)));
+    auto path = Files().at(0);
+
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+    EXPECT_FALSE(cache.Load("a").has_value());
+
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << "not an entry";
+    EXPECT_FALSE(cache.Load("a").has_value());
+}
+
+TEST_F(DiskCacheTest, LeastRecentlyUsedEntriesAreEvicted)
+{
+    // Each entry is a little larger than its 400-byte value, so two of them fit in 1000 bytes but three don't.
+    DiskCache cache(m_directory, 1000);
+    auto now = std::filesystem::file_time_type::clock::now();
+
+    ASSERT_TRUE(cache.Store("a", Bytes(400, 1)));
+    ASSERT_TRUE(cache.Store("b", Bytes(400, 2)));
+    std::filesystem::last_write_time(Files()[0], now - std::chrono::hours(2));
+    std::filesystem::last_write_time(Files()[1], now - std::chrono::hours(2));
+
+    // Loading 'a' makes it the most recently used, so storing 'c' evicts 'b'.
+    EXPECT_TRUE(cache.Load("a").has_value());
+    ASSERT_TRUE(cache.Store("c", Bytes(400, 3)));
+
+    EXPECT_TRUE(cache.Load("a").has_value());
+    EXPECT_FALSE(cache.Load("b").has_value());
+    EXPECT_TRUE(cache.Load("c").has_value());
+}
+
+TEST_F(DiskCacheTest, ConcurrentWritersDontCorruptEntries)
+{
+    DiskCache cache(m_directory, 1024 * 1024);
+    std::vector<std::thread> threads;
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        threads.emplace_back([&, i]
+        {
+            for (int j = 0; j < 20; j++)
+            {
+                cache.Store("shared", Bytes(1000, i));
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    auto value = cache.Load("shared");
+    ASSERT_TRUE(value.has_value());
+    ASSERT_EQ(value->size(), 1000u);
+    EXPECT_EQ(*value, Bytes(1000, static_cast<uint8_t>((*value)[0])));
+    EXPECT_EQ(Files().size(), 1u);
+}
@@ -0,0 +1,107 @@
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <wsl/winadapter.h>
+#endif
+
+#include <gtest/gtest.h>
+#include <wil/result.h>
+#include <wrl/client.h>
+#include <vector>
+#include "DxDispatchInterface.h"
+
+#ifndef _WIN32
+WINADAPTER_IID(IDxDispatch2, 0x6A1E0B4C, 0x3F0D, 0x4C8E, 0x9B, 0x1A, 0x52, 0xD7, 0xE4, 0xF8, 0xC3, 0xA9);
+#endif
+
+using Microsoft::WRL::ComPtr;
+
+// These tests run models through the public interface, so they need a D3D12 adapter with DirectML support.
+
+static constexpr const char* c_addModel = R"({
+    "resources": 
+    {
+        "A": { "initialValuesDataType": "FLOAT32", "initialValues": [1, 2, 3] },
+        "B": { "initialValuesDataType": "FLOAT32", "initialValues": [5, 8, -5] },
+        "Out": { "initialValuesDataType": "FLOAT32", "initialValues": { "valueCount": 3, "value": 0 } }
+    },
+    "dispatchables": 
+    {
+        "add": 
+        {
+            "type": "DML_OPERATOR_ELEMENT_WISE_ADD",
+            "desc": 
+            {
+                "ATensor": { "DataType": "FLOAT32", "Sizes": [3] },
+                "BTensor": { "DataType": "FLOAT32", "Sizes": [3] },
+                "OutputTensor": { "DataType": "FLOAT32", "Sizes": [3] }
+            }
+        }
+    },
+    "commands": 
+    [
+        { "type": "dispatch", "dispatchable": "add", "bindings": { "ATensor": "A", "BTensor": "B", "OutputTensor": "Out" } }
+    ]
+})";
+
+// ----------------------------------------------------------------------------
+// IDxDispatch2
+// ----------------------------------------------------------------------------
+
+TEST(DxDispatchApiTest, RunAllTwiceWithNewResourceData)
+{
+    ComPtr<IDxDispatch> dispatch;
+    ASSERT_EQ(CreateDxDispatchFromString("", c_addModel, nullptr, nullptr, &dispatch), S_OK);
+
+    ComPtr<IDxDispatch2> dispatch2;
+    ASSERT_EQ(dispatch.As(&dispatch2), S_OK);
+
+    UINT64 sizeInBytes = 0;
+    ASSERT_EQ(dispatch2->GetResourceSize("A", &sizeInBytes), S_OK);
+    ASSERT_GE(sizeInBytes, 3 * sizeof(float));
+    ASSERT_EQ(sizeInBytes % sizeof(float), 0u);
+
+    const float b[] = { 5, 8, -5 };
+    for (float offset : { 0.0f, 10.0f, -100.0f })
+    {
+        std::vector<float> a(static_cast<size_t>(sizeInBytes / sizeof(float)));
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            a[i] = static_cast<float>(i + 1) + offset;
+        }
+        ASSERT_EQ(dispatch2->SetResourceData("A", a.data(), sizeInBytes), S_OK);
+        ASSERT_EQ(dispatch2->RunAll(), S_OK);
+
+        std::vector<float> out(a.size());
+        ASSERT_EQ(dispatch2->GetResourceData("Out", out.data(), sizeInBytes), S_OK);
+        for (size_t i = 0; i < 3; i++)
+        {
+            EXPECT_EQ(out[i], a[i] + b[i]) << "offset " << offset << ", element " << i;
+        }
+    }
+}
+
+TEST(DxDispatchApiTest, RunAllAfterRunningCommandsIndividually)
+{
+    ComPtr<IDxDispatch> dispatch;
+    ASSERT_EQ(CreateDxDispatchFromString("", c_addModel, nullptr, nullptr, &dispatch), S_OK);
+
+    ASSERT_EQ(dispatch->GetCommandCount(), 1u);
+    ASSERT_EQ(dispatch->RunCommand(0), S_OK);
+    ASSERT_EQ(dispatch->RunCommand(0), S_OK);
+    ASSERT_EQ(dispatch->RunAll(), S_OK);
+    ASSERT_EQ(dispatch->RunAll(), S_OK);
+}
+
+TEST(DxDispatchApiTest, QueryInterface)
+{
+    ComPtr<IDxDispatch> dispatch;
+    ASSERT_EQ(CreateDxDispatchFromString("", c_addModel, nullptr, nullptr, &dispatch), S_OK);
+
+    ComPtr<IDxDispatch2> dispatch2;
+    ASSERT_EQ(dispatch.As(&dispatch2), S_OK);
+
+    ComPtr<IDxDispatch> dispatchFromDispatch2;
+    ASSERT_EQ(dispatch2.As(&dispatchFromDispatch2), S_OK);
+    EXPECT_EQ(dispatchFromDispatch2.Get(), dispatch.Get());
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include <gtest/gtest.h>
+#include "FrameRing.h"
+
+// Simulated queue: signals are enqueued in order and "complete" only when the test retires them
+// (or when the CPU blocks on them, which drains the queue up to the requested value).
+class FakeFenceTimeline : public IFenceTimeline
+{
+public:
+    uint64_t Signal() override { return ++lastSignaledValue; }
+    uint64_t GetCompletedValue() override { return completedValue; }
+
+    void WaitForValue(uint64_t value) override
+    {
+        ASSERT_LE(value, lastSignaledValue) << "Waiting on a value that was never signaled would hang";
+        waitedValues.push_back(value);
+        completedValue = std::max(completedValue, value);
+    }
+
+    void Retire(uint64_t value) { completedValue = std::max(completedValue, value); }
+
+    uint64_t lastSignaledValue = 0;
+    uint64_t completedValue = 0;
+    std::vector<uint64_t> waitedValues;
+};
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+#include "FrameRing.h"
+#include "FakeFenceTimeline.h"
+
+// ----------------------------------------------------------------------------
+// FrameRing
+// ----------------------------------------------------------------------------
+
+TEST(FrameRingTest, ZeroFramesIsInvalid)
+{
+    FakeFenceTimeline timeline;
+    EXPECT_THROW(FrameRing(&timeline, 0), std::invalid_argument);
+}
+
+TEST(FrameRingTest, SingleFrameWaitsOnEverySubmission)
+{
+    FakeFenceTimeline timeline;
+    FrameRing ring(&timeline, 1);
+
+    for (uint64_t i = 1; i <= 3; i++)
+    {
+        EXPECT_EQ(ring.SubmitCurrentFrame(), i);
+        EXPECT_EQ(ring.AdvanceFrame(), 0u);
+        EXPECT_EQ(timeline.completedValue, i);
+    }
+
+    EXPECT_EQ(ring.StallCount(), 3u);
+    EXPECT_EQ(timeline.waitedValues, (std::vector<uint64_t>{ 1, 2, 3 }));
+}
+
+TEST(FrameRingTest, MultipleFramesOverlapUntilRingIsFull)
+{
+    FakeFenceTimeline timeline;
+    FrameRing ring(&timeline, 3);
+
+    // The first two submissions don't block since their next frames have never been used.
+    ring.SubmitCurrentFrame();
+    EXPECT_EQ(ring.AdvanceFrame(), 1u);
+    ring.SubmitCurrentFrame();
+    EXPECT_EQ(ring.AdvanceFrame(), 2u);
+    EXPECT_TRUE(timeline.waitedValues.empty());
+    EXPECT_EQ(ring.FramesInFlight(), 2u);
+
+    // Wrapping back to frame 0 requires its submission (fence value 1) to complete.
+    ring.SubmitCurrentFrame();
+    EXPECT_EQ(ring.FramesInFlight(), 3u);
+    EXPECT_EQ(ring.AdvanceFrame(), 0u);
+    EXPECT_EQ(timeline.waitedValues, (std::vector<uint64_t>{ 1 }));
+    EXPECT_EQ(ring.StallCount(), 1u);
+    EXPECT_EQ(ring.FramesInFlight(), 2u);
+}
+
+TEST(FrameRingTest, RetiredFramesDoNotStall)
+{
+    FakeFenceTimeline timeline;
+    FrameRing ring(&timeline, 2);
+
+    for (int i = 0; i < 10; i++)
+    {
+        uint64_t fenceValue = ring.SubmitCurrentFrame();
+        timeline.Retire(fenceValue);
+        ring.AdvanceFrame();
+    }
+
+    EXPECT_EQ(ring.StallCount(), 0u);
+    EXPECT_TRUE(timeline.waitedValues.empty());
+    EXPECT_EQ(ring.FramesInFlight(), 0u);
+}
+
+TEST(FrameRingTest, WaitForAllFramesDrainsWithoutCountingStalls)
+{
+    FakeFenceTimeline timeline;
+    FrameRing ring(&timeline, 4);
+
+    ring.SubmitCurrentFrame();
+    ring.AdvanceFrame();
+    ring.SubmitCurrentFrame();
+    ring.AdvanceFrame();
+    ring.SubmitCurrentFrame();
+    EXPECT_EQ(ring.FramesInFlight(), 3u);
+
+    ring.WaitForAllFrames();
+    EXPECT_EQ(ring.FramesInFlight(), 0u);
+    EXPECT_EQ(timeline.completedValue, 3u);
+    EXPECT_EQ(ring.StallCount(), 0u);
+    EXPECT_EQ(ring.CurrentFrameIndex(), 2u);
+}
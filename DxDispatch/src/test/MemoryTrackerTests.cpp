@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include <thread>
+#include "MemoryTracker.h"
+
+// ----------------------------------------------------------------------------
+// MemoryTracker
+// ----------------------------------------------------------------------------
+
+TEST(MemoryTrackerTest, TracksLiveAndPeakPerCategory)
+{
+    MemoryTracker tracker;
+    tracker.Allocate(MemoryCategory::ModelResources, 100);
+    tracker.Allocate(MemoryCategory::ModelResources, 50);
+    tracker.Free(MemoryCategory::ModelResources, 100);
+    tracker.Allocate(MemoryCategory::ModelResources, 20);
+
+    auto usage = tracker.GetUsage(MemoryCategory::ModelResources);
+    EXPECT_EQ(usage.liveInBytes, 70u);
+    EXPECT_EQ(usage.peakInBytes, 150u);
+    EXPECT_EQ(usage.allocationCount, 3u);
+
+    auto otherUsage = tracker.GetUsage(MemoryCategory::Readback);
+    EXPECT_EQ(otherUsage.liveInBytes, 0u);
+    EXPECT_EQ(otherUsage.peakInBytes, 0u);
+    EXPECT_EQ(otherUsage.allocationCount, 0u);
+}
+
+TEST(MemoryTrackerTest, TotalPeakIsPeakOfSum)
+{
+    // The categories peak at different times, so the total peak is less than the sum of their peaks.
+    MemoryTracker tracker;
+    tracker.Allocate(MemoryCategory::UploadStaging, 100);
+    tracker.Free(MemoryCategory::UploadStaging, 100);
+    tracker.Allocate(MemoryCategory::DmlPersistent, 60);
+    tracker.Allocate(MemoryCategory::DmlTemporary, 30);
+
+    auto total = tracker.GetTotalUsage();
+    EXPECT_EQ(total.liveInBytes, 90u);
+    EXPECT_EQ(total.peakInBytes, 100u);
+    EXPECT_EQ(total.allocationCount, 3u);
+
+    tracker.Allocate(MemoryCategory::Readback, 20);
+    EXPECT_EQ(tracker.GetTotalUsage().peakInBytes, 110u);
+}
+
+TEST(MemoryTrackerTest, FreeingMoreThanLiveClampsToZero)
+{
+    MemoryTracker tracker;
+    tracker.Allocate(MemoryCategory::HostModel, 10);
+    tracker.Allocate(MemoryCategory::Readback, 5);
+
+    // Debug builds assert on the mismatch; release builds clamp the category's live bytes to 0.
+    EXPECT_DEBUG_DEATH(tracker.Free(MemoryCategory::HostModel, 11), "");
+    EXPECT_DEBUG_DEATH(tracker.Free(MemoryCategory::DescriptorHeaps, 1), "");
+#ifdef NDEBUG
+    EXPECT_EQ(tracker.GetUsage(MemoryCategory::HostModel).liveInBytes, 0u);
+    EXPECT_EQ(tracker.GetUsage(MemoryCategory::DescriptorHeaps).liveInBytes, 0u);
+    EXPECT_EQ(tracker.GetTotalUsage().liveInBytes, 5u);
+#else
+    EXPECT_EQ(tracker.GetUsage(MemoryCategory::HostModel).liveInBytes, 10u);
+#endif
+}
+
+TEST(MemoryTrackerTest, WriteJson)
+{
+    MemoryTracker tracker;
+    tracker.Allocate(MemoryCategory::Readback, 8);
+
+    std::ostringstream stream;
+    tracker.WriteJson(stream);
+    auto json = stream.str();
+    EXPECT_EQ(json.find("{\"total\": {\"live_bytes\": 8, \"peak_bytes\": 8, \"allocations\": 1}"), 0u);
+    EXPECT_NE(json.find("\"readback\": {\"live_bytes\": 8, \"peak_bytes\": 8, \"allocations\": 1}"), std::string::npos);
+    EXPECT_NE(json.find("\"host_model\": {\"live_bytes\": 0, \"peak_bytes\": 0, \"allocations\": 0}}"), std::string::npos);
+}
+
+TEST(MemoryTrackerTest, ConcurrentAllocations)
+{
+    MemoryTracker tracker;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+    {
+        threads.emplace_back([&tracker]
+        {
+            for (int i = 0; i < 1000; i++)
+            {
+                tracker.Allocate(MemoryCategory::OnnxBindings, 4);
+                tracker.Free(MemoryCategory::OnnxBindings, 4);
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    auto usage = tracker.GetUsage(MemoryCategory::OnnxBindings);
+    EXPECT_EQ(usage.liveInBytes, 0u);
+    EXPECT_EQ(usage.allocationCount, 4000u);
+    EXPECT_GE(usage.peakInBytes, 4u);
+    EXPECT_LE(usage.peakInBytes, 16u);
+}
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include "PhaseTiming.h"
+
+// ----------------------------------------------------------------------------
+// PhaseRecorder
+// ----------------------------------------------------------------------------
+
+static void SleepMilliseconds(uint32_t milliseconds)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+}
+
+TEST(PhaseTimingTest, ScopesWithoutRecorderDoNothing)
+{
+    EXPECT_EQ(PhaseRecorder::GetActive(), nullptr);
+    PhaseScope scope(CpuPhase::Bind);
+}
+
+TEST(PhaseTimingTest, RecorderIsActiveForItsLifetime)
+{
+    {
+        PhaseRecorder recorder;
+        EXPECT_EQ(PhaseRecorder::GetActive(), &recorder);
+
+        {
+            PhaseRecorder nestedRecorder;
+            EXPECT_EQ(PhaseRecorder::GetActive(), &nestedRecorder);
+        }
+        EXPECT_EQ(PhaseRecorder::GetActive(), &recorder);
+
+        // Recorders are per thread.
+        std::thread([] { EXPECT_EQ(PhaseRecorder::GetActive(), nullptr); }).join();
+    }
+    EXPECT_EQ(PhaseRecorder::GetActive(), nullptr);
+}
+
+TEST(PhaseTimingTest, NestedScopesAreExclusive)
+{
+    PhaseRecorder recorder;
+
+    // Time outside of any scope isn't charged.
+    SleepMilliseconds(20);
+    {
+        PhaseScope record(CpuPhase::Record);
+        SleepMilliseconds(10);
+        {
+            PhaseScope wait(CpuPhase::FenceWait);
+            SleepMilliseconds(100);
+        }
+        SleepMilliseconds(10);
+    }
+
+    // The wait would push the record time past 100 ms if it were also charged to the outer phase.
+    auto totals = recorder.TakeTotals();
+    double record = totals[static_cast<size_t>(CpuPhase::Record)];
+    double wait = totals[static_cast<size_t>(CpuPhase::FenceWait)];
+    EXPECT_GE(record, 20.0);
+    EXPECT_LT(record, 100.0);
+    EXPECT_GE(wait, 100.0);
+    EXPECT_EQ(totals[static_cast<size_t>(CpuPhase::Bind)], 0.0);
+}
+
+TEST(PhaseTimingTest, TakeTotalsStartsOver)
+{
+    PhaseRecorder recorder;
+    PhaseScope sleep(CpuPhase::Sleep);
+    SleepMilliseconds(10);
+
+    // The phase in progress is charged up to the call, and the rest goes to the next totals.
+    EXPECT_GE(recorder.TakeTotals()[static_cast<size_t>(CpuPhase::Sleep)], 10.0);
+    EXPECT_LT(recorder.TakeTotals()[static_cast<size_t>(CpuPhase::Sleep)], 10.0);
+}
+
+TEST(PhaseTimingTest, PhaseNames)
+{
+    EXPECT_STREQ(GetCpuPhaseName(CpuPhase::ResolveBindings), "resolve bindings");
+    EXPECT_STREQ(GetCpuPhaseName(CpuPhase::FenceWait), "fence wait");
+}
@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+#include "RangeAllocators.h"
+#include "FakeFenceTimeline.h"
+
+// ----------------------------------------------------------------------------
+// RingAllocator
+// ----------------------------------------------------------------------------
+
+TEST(RingAllocatorTest, InvalidSizes)
+{
+    FakeFenceTimeline timeline;
+    EXPECT_THROW(RingAllocator(&timeline, 0), std::invalid_argument);
+
+    RingAllocator ring(&timeline, 16);
+    EXPECT_THROW(ring.Allocate(0), std::invalid_argument);
+    EXPECT_THROW(ring.Allocate(17), std::invalid_argument);
+}
+
+TEST(RingAllocatorTest, AllocationsAreContiguousUntilRetired)
+{
+    FakeFenceTimeline timeline;
+    RingAllocator ring(&timeline, 16);
+
+    EXPECT_EQ(ring.Allocate(4), 0u);
+    EXPECT_EQ(ring.Allocate(4), 4u);
+    ring.Submit(timeline.Signal());
+    EXPECT_EQ(ring.Allocate(8), 8u);
+    EXPECT_EQ(ring.UsedSize(), 16u);
+
+    // Once the first submission completes, its ranges are reused.
+    ring.Submit(timeline.Signal());
+    timeline.Retire(1);
+    EXPECT_EQ(ring.Allocate(8), 0u);
+    EXPECT_EQ(ring.StallCount(), 0u);
+}
+
+TEST(RingAllocatorTest, FullRingWithoutSubmissionsThrows)
+{
+    FakeFenceTimeline timeline;
+    RingAllocator ring(&timeline, 4);
+
+    // Unsubmitted allocations can never be retired, so waiting would hang.
+    ring.Allocate(4);
+    EXPECT_THROW(ring.Allocate(1), std::runtime_error);
+}
+
+TEST(RingAllocatorTest, TryAllocateDoesNotWait)
+{
+    FakeFenceTimeline timeline;
+    RingAllocator ring(&timeline, 8);
+
+    EXPECT_EQ(ring.TryAllocate(6), 0u);
+    EXPECT_EQ(ring.UnsubmittedSize(), 6u);
+    ring.Submit(timeline.Signal());
+    EXPECT_EQ(ring.UnsubmittedSize(), 0u);
+
+    // The ring is full until the submission completes, and oversized requests never fit.
+    EXPECT_FALSE(ring.TryAllocate(4).has_value());
+    EXPECT_FALSE(ring.TryAllocate(9).has_value());
+    EXPECT_EQ(ring.StallCount(), 0u);
+
+    timeline.Retire(1);
+    EXPECT_EQ(ring.TryAllocate(4), 0u);
+}
+
+TEST(RingAllocatorTest, WrapSkipsEndOfRing)
+{
+    FakeFenceTimeline timeline;
+    RingAllocator ring(&timeline, 10);
+
+    ring.Allocate(6);
+    ring.Submit(timeline.Signal());
+    ring.Allocate(3);
+    ring.Submit(timeline.Signal());
+    timeline.Retire(1);
+
+    // Only 1 slot remains at the end, so this allocation wraps to the start and consumes the remainder.
+    EXPECT_EQ(ring.Allocate(5), 0u);
+    EXPECT_EQ(ring.UsedSize(), 9u);
+    ring.Submit(timeline.Signal());
+
+    timeline.Retire(3);
+    ring.Retire();
+    EXPECT_EQ(ring.UsedSize(), 0u);
+    EXPECT_EQ(ring.Allocate(10), 0u);
+}
+
+TEST(RingAllocatorTest, FullRingWaitsForOldestSubmission)
+{
+    FakeFenceTimeline timeline;
+    RingAllocator ring(&timeline, 8);
+
+    for (uint64_t i = 0; i < 4; i++)
+    {
+        EXPECT_EQ(ring.Allocate(2), i * 2);
+        ring.Submit(timeline.Signal());
+    }
+
+    EXPECT_EQ(ring.Allocate(2), 0u);
+    EXPECT_EQ(timeline.waitedValues, (std::vector<uint64_t>{ 1 }));
+    EXPECT_EQ(ring.StallCount(), 1u);
+
+    // A larger allocation needs multiple submissions to retire.
+    ring.Submit(timeline.Signal());
+    EXPECT_EQ(ring.Allocate(4), 2u);
+    EXPECT_EQ(timeline.waitedValues, (std::vector<uint64_t>{ 1, 2, 3 }));
+}
+
+// ----------------------------------------------------------------------------
+// FreeListAllocator
+// ----------------------------------------------------------------------------
+
+TEST(FreeListAllocatorTest, FirstFit)
+{
+    FakeFenceTimeline timeline;
+    FreeListAllocator allocator(&timeline, 16);
+
+    EXPECT_EQ(allocator.Allocate(4), 0u);
+    EXPECT_EQ(allocator.Allocate(8), 4u);
+    EXPECT_EQ(allocator.Allocate(4), 12u);
+    EXPECT_EQ(allocator.UsedSize(), 16u);
+    EXPECT_THROW(allocator.Allocate(1), std::runtime_error);
+    EXPECT_THROW(allocator.Allocate(0), std::invalid_argument);
+}
+
+TEST(FreeListAllocatorTest, FreesAreDeferredUntilSubmissionCompletes)
+{
+    FakeFenceTimeline timeline;
+    FreeListAllocator allocator(&timeline, 8);
+
+    auto a = allocator.Allocate(4);
+    allocator.Allocate(4);
+    allocator.Free(a, 4);
+
+    // Not yet submitted: the range may be referenced by recorded (unsubmitted) work.
+    EXPECT_THROW(allocator.Allocate(4), std::runtime_error);
+
+    allocator.Submit(timeline.Signal());
+    allocator.Retire();
+    EXPECT_EQ(allocator.UsedSize(), 8u);
+
+    // Submitted but not complete: Allocate() blocks until the GPU passes the fence.
+    EXPECT_EQ(allocator.Allocate(4), a);
+    EXPECT_EQ(timeline.waitedValues, (std::vector<uint64_t>{ 1 }));
+}
+
+TEST(FreeListAllocatorTest, AdjacentFreeRangesCoalesce)
+{
+    FakeFenceTimeline timeline;
+    FreeListAllocator allocator(&timeline, 12);
+
+    auto a = allocator.Allocate(4);
+    auto b = allocator.Allocate(4);
+    auto c = allocator.Allocate(4);
+    allocator.Free(a, 4);
+    allocator.Free(c, 4);
+    allocator.Free(b, 4);
+    allocator.Submit(timeline.Signal());
+    timeline.Retire(1);
+    allocator.Retire();
+
+    EXPECT_EQ(allocator.UsedSize(), 0u);
+    EXPECT_EQ(allocator.Allocate(12), 0u);
+}
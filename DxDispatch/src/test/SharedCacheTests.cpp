@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "SharedCache.h"
+
+// ----------------------------------------------------------------------------
+// SharedCache
+// ----------------------------------------------------------------------------
+
+TEST(SharedCacheTest, SameKeySharesObject)
+{
+    SharedCache<int> cache;
+    int createCount = 0;
+    auto create = [&] { return ++createCount; };
+
+    auto a = cache.GetOrCreate("a", create);
+    auto a2 = cache.GetOrCreate("a", create);
+    auto b = cache.GetOrCreate("b", create);
+
+    EXPECT_EQ(a, a2);
+    EXPECT_EQ(*a, 1);
+    EXPECT_EQ(*b, 2);
+    EXPECT_EQ(createCount, 2);
+    EXPECT_EQ(cache.GetStats().hits, 1u);
+    EXPECT_EQ(cache.GetStats().misses, 2u);
+    EXPECT_EQ(cache.GetLiveCount(), 2u);
+}
+
+TEST(SharedCacheTest, ObjectIsReleasedWithLastUser)
+{
+    SharedCache<int> cache;
+    int createCount = 0;
+    auto create = [&] { return ++createCount; };
+
+    auto a = cache.GetOrCreate("a", create);
+    auto a2 = cache.GetOrCreate("a", create);
+    a.reset();
+    EXPECT_EQ(cache.GetLiveCount(), 1u);
+
+    a2.reset();
+    EXPECT_EQ(cache.GetLiveCount(), 0u);
+
+    // The object is created again once no one holds it.
+    EXPECT_EQ(*cache.GetOrCreate("a", create), 2);
+    EXPECT_EQ(cache.GetStats().misses, 2u);
+}
+
+TEST(SharedCacheTest, FailedCreationIsNotCached)
+{
+    SharedCache<int> cache;
+    EXPECT_THROW(cache.GetOrCreate("a", []() -> int { throw std::runtime_error("failed"); }), std::runtime_error);
+    EXPECT_EQ(cache.GetLiveCount(), 0u);
+    EXPECT_EQ(*cache.GetOrCreate("a", [] { return 7; }), 7);
+}
+
+TEST(SharedCacheTest, ReleasedEntriesArePruned)
+{
+    SharedCache<int> cache;
+    for (int i = 0; i < 1000; i++)
+    {
+        cache.GetOrCreate(std::to_string(i), [&] { return i; });
+    }
+
+    auto kept = cache.GetOrCreate("kept", [] { return -1; });
+    EXPECT_EQ(cache.GetLiveCount(), 1u);
+    EXPECT_EQ(*cache.GetOrCreate("kept", [] { return 0; }), -1);
+}
+
+TEST(SharedCacheTest, ConcurrentRequestsShareOneObject)
+{
+    SharedCache<int> cache;
+    std::vector<std::shared_ptr<const int>> values(8);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        threads.emplace_back([&, i] { values[i] = cache.GetOrCreate("a", [i] { return static_cast<int>(i); }); });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (auto& value : values)
+    {
+        EXPECT_EQ(value, values[0]);
+    }
+    EXPECT_EQ(cache.GetStats().hits + cache.GetStats().misses, values.size());
+}
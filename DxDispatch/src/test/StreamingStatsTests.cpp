@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+#include "StreamingStats.h"
+
+// ----------------------------------------------------------------------------
+// StreamingStats
+// ----------------------------------------------------------------------------
+
+TEST(StreamingStatsTest, Empty)
+{
+    StreamingStats stats;
+    auto summary = stats.GetSummary();
+    EXPECT_EQ(summary.count, 0u);
+    EXPECT_EQ(summary.sum, 0.0);
+    EXPECT_EQ(summary.median, 0.0);
+}
+
+TEST(StreamingStatsTest, ShortStreamsAreExact)
+{
+    StreamingStats stats;
+    for (double sample : { 5.0, 1.0, 4.0, 2.0, 3.0, 6.0 })
+    {
+        stats.Add(sample);
+    }
+
+    // The median is sorted[count / 2], the same as Timings::ComputeStats.
+    auto summary = stats.GetSummary();
+    EXPECT_EQ(summary.count, 6u);
+    EXPECT_EQ(summary.sum, 21.0);
+    EXPECT_EQ(summary.average, 3.5);
+    EXPECT_EQ(summary.median, 4.0);
+    EXPECT_EQ(summary.min, 1.0);
+    EXPECT_EQ(summary.max, 6.0);
+    EXPECT_EQ(stats.Percentile(0), 1.0);
+    EXPECT_EQ(stats.Percentile(1), 6.0);
+}
+
+TEST(StreamingStatsTest, LongStreamsAreApproximate)
+{
+    StreamingStats stats;
+    size_t count = StreamingStats::c_exactSampleCapacity * 10;
+    for (size_t i = 0; i < count; i++)
+    {
+        // Interleave small and large values so the histogram sees both ends early.
+        stats.Add(i % 2 == 0 ? 0.001 * (i + 1) : 1000.0 - 0.001 * i);
+    }
+
+    auto summary = stats.GetSummary();
+    EXPECT_EQ(summary.count, count);
+    EXPECT_DOUBLE_EQ(summary.min, 0.001);
+    EXPECT_DOUBLE_EQ(summary.max, 1000.0 - 0.001);
+
+    std::vector<double> samples;
+    for (size_t i = 0; i < count; i++)
+    {
+        samples.push_back(i % 2 == 0 ? 0.001 * (i + 1) : 1000.0 - 0.001 * i);
+    }
+    std::sort(samples.begin(), samples.end());
+
+    for (double fraction : { 0.1, 0.5, 0.9, 0.99 })
+    {
+        double expected = samples[static_cast<size_t>(fraction * count)];
+        EXPECT_NEAR(stats.Percentile(fraction), expected, expected * StreamingStats::c_bucketGrowth);
+    }
+}
+
+TEST(StreamingStatsTest, ValuesOutsideBucketRangeAreClamped)
+{
+    StreamingStats stats;
+    for (size_t i = 0; i <= StreamingStats::c_exactSampleCapacity; i++)
+    {
+        stats.Add(i % 2 == 0 ? 0.0 : 1e9);
+    }
+
+    EXPECT_EQ(stats.Percentile(0), 0.0);
+    EXPECT_EQ(stats.Percentile(1), 1e9);
+}
+
+TEST(StreamingStatsTest, MergeMatchesSingleStream)
+{
+    // Exact + exact, exact + histogram, and histogram + exact streams.
+    for (auto sizes : { std::pair<size_t, size_t>(10, 20), { 10, StreamingStats::c_exactSampleCapacity * 2 }, { StreamingStats::c_exactSampleCapacity * 2, 10 } })
+    {
+        StreamingStats first;
+        StreamingStats second;
+        StreamingStats combined;
+        for (size_t i = 0; i < sizes.first; i++)
+        {
+            first.Add(1.0 + i);
+            combined.Add(1.0 + i);
+        }
+        for (size_t i = 0; i < sizes.second; i++)
+        {
+            second.Add(100.0 + i);
+            combined.Add(100.0 + i);
+        }
+
+        first.Merge(second);
+        auto summary = first.GetSummary();
+        auto expected = combined.GetSummary();
+        EXPECT_EQ(summary.count, expected.count);
+        EXPECT_DOUBLE_EQ(summary.sum, expected.sum);
+        EXPECT_EQ(summary.min, expected.min);
+        EXPECT_EQ(summary.max, expected.max);
+        for (double fraction : { 0.1, 0.5, 0.99 })
+        {
+            EXPECT_NEAR(first.Percentile(fraction), combined.Percentile(fraction), combined.Percentile(fraction) * StreamingStats::c_bucketGrowth);
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+// WarmupStats
+// ----------------------------------------------------------------------------
+
+TEST(WarmupStatsTest, AtLeastOneSampleIsHot)
+{
+    // Same split as Timings::ComputeStats: min(count - 1, maxWarmup) cold samples.
+    for (size_t count = 0; count <= 5; count++)
+    {
+        WarmupStats stats(2);
+        for (size_t i = 0; i < count; i++)
+        {
+            stats.Add(static_cast<double>(i));
+        }
+
+        size_t expectedCold = std::min<size_t>(count > 0 ? count - 1 : 0, 2);
+        EXPECT_EQ(stats.Count(), count);
+        EXPECT_EQ(stats.GetColdSummary().count, expectedCold);
+        EXPECT_EQ(stats.GetHotSummary().count, count - expectedCold);
+    }
+}
+
+TEST(WarmupStatsTest, ColdSamplesComeFirst)
+{
+    WarmupStats stats(1);
+    stats.Add(100);
+    stats.Add(2);
+    stats.Add(4);
+
+    EXPECT_EQ(stats.GetColdSummary().max, 100.0);
+    EXPECT_EQ(stats.GetHotSummary().min, 2.0);
+    EXPECT_EQ(stats.GetHotSummary().max, 4.0);
+
+    // Reading the summaries doesn't change the split.
+    EXPECT_EQ(stats.GetHotSummary().count, 2u);
+}
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include "TensorValueCache.h"
+
+// Stands in for a tensor value bound to a resource (e.g. an OrtValue wrapping a D3D12 resource): a CPU buffer that
+// keeps its resource alive, which counts the values created over it.
+struct FakeResource
+{
+    int valuesCreated = 0;
+};
+
+struct FakeTensorValue
+{
+    std::shared_ptr<FakeResource> resource;
+    std::vector<int64_t> shape;
+    std::vector<float> data;
+};
+
+using FakeTensorValueCache = TensorValueCache<FakeResource*, FakeTensorValue>;
+
+static FakeTensorValue& GetOrCreate(
+    FakeTensorValueCache& cache,
+    const std::string& name,
+    const std::shared_ptr<FakeResource>& resource,
+    const std::vector<int64_t>& shape,
+    bool* rebuilt = nullptr)
+{
+    return cache.GetOrCreate(name, resource.get(), shape, [&]
+    {
+        resource->valuesCreated++;
+        size_t elementCount = 1;
+        for (auto dimSize : shape) { elementCount *= static_cast<size_t>(dimSize); }
+        return FakeTensorValue{ resource, shape, std::vector<float>(elementCount) };
+    }, rebuilt);
+}
+
+// ----------------------------------------------------------------------------
+// TensorValueCache
+// ----------------------------------------------------------------------------
+
+TEST(TensorValueCacheTest, ReusesValueForSameResourceAndShape)
+{
+    FakeTensorValueCache cache;
+    auto resource = std::make_shared<FakeResource>();
+
+    bool rebuilt = false;
+    auto& first = GetOrCreate(cache, "x", resource, { 2, 3 }, &rebuilt);
+    EXPECT_TRUE(rebuilt);
+    first.data[0] = 42.0f;
+
+    for (int iteration = 0; iteration < 10; iteration++)
+    {
+        auto& value = GetOrCreate(cache, "x", resource, { 2, 3 }, &rebuilt);
+        EXPECT_FALSE(rebuilt);
+        EXPECT_EQ(&value, &first);
+        EXPECT_EQ(value.data[0], 42.0f);
+    }
+    EXPECT_EQ(resource->valuesCreated, 1);
+    EXPECT_EQ(cache.GetSize(), 1u);
+}
+
+TEST(TensorValueCacheTest, RebuildsWhenShapeChanges)
+{
+    FakeTensorValueCache cache;
+    auto resource = std::make_shared<FakeResource>();
+
+    bool rebuilt = false;
+    GetOrCreate(cache, "x", resource, { 4 });
+    auto& value = GetOrCreate(cache, "x", resource, { 2, 2 }, &rebuilt);
+    EXPECT_TRUE(rebuilt);
+    EXPECT_EQ(value.shape, (std::vector<int64_t>{ 2, 2 }));
+
+    // A scalar's empty shape is a shape of its own.
+    GetOrCreate(cache, "x", resource, {}, &rebuilt);
+    EXPECT_TRUE(rebuilt);
+    GetOrCreate(cache, "x", resource, {}, &rebuilt);
+    EXPECT_FALSE(rebuilt);
+    EXPECT_EQ(resource->valuesCreated, 3);
+}
+
+TEST(TensorValueCacheTest, RebuildsWhenResourceChanges)
+{
+    FakeTensorValueCache cache;
+    auto resource0 = std::make_shared<FakeResource>();
+    auto resource1 = std::make_shared<FakeResource>();
+
+    bool rebuilt = false;
+    GetOrCreate(cache, "x", resource0, { 8 });
+    auto& value = GetOrCreate(cache, "x", resource1, { 8 }, &rebuilt);
+    EXPECT_TRUE(rebuilt);
+    EXPECT_EQ(value.resource, resource1);
+    EXPECT_EQ(resource0->valuesCreated, 1);
+    EXPECT_EQ(resource1->valuesCreated, 1);
+}
+
+TEST(TensorValueCacheTest, ReleasesStaleValue)
+{
+    FakeTensorValueCache cache;
+    auto resource0 = std::make_shared<FakeResource>();
+    auto resource1 = std::make_shared<FakeResource>();
+
+    GetOrCreate(cache, "x", resource0, { 8 });
+    EXPECT_EQ(resource0.use_count(), 2);
+
+    GetOrCreate(cache, "x", resource1, { 8 });
+    EXPECT_EQ(resource0.use_count(), 1);
+    EXPECT_EQ(resource1.use_count(), 2);
+
+    EXPECT_TRUE(cache.Erase("x"));
+    EXPECT_FALSE(cache.Erase("x"));
+    EXPECT_EQ(resource1.use_count(), 1);
+    EXPECT_EQ(cache.GetSize(), 0u);
+}
+
+TEST(TensorValueCacheTest, TensorsAreCachedIndependently)
+{
+    FakeTensorValueCache cache;
+    auto resource = std::make_shared<FakeResource>();
+
+    // Values without a resource (e.g. CPU tensors allocated by the runtime) are keyed by shape alone.
+    bool rebuilt = false;
+    cache.GetOrCreate("cpu", nullptr, { 3 }, [] { return FakeTensorValue{ nullptr, { 3 }, std::vector<float>(3) }; });
+    GetOrCreate(cache, "x", resource, { 1 });
+    GetOrCreate(cache, "y", resource, { 1 });
+
+    GetOrCreate(cache, "x", resource, { 2 }, &rebuilt);
+    EXPECT_TRUE(rebuilt);
+    GetOrCreate(cache, "y", resource, { 1 }, &rebuilt);
+    EXPECT_FALSE(rebuilt);
+    cache.GetOrCreate("cpu", nullptr, { 3 }, [] { return FakeTensorValue{}; }, &rebuilt);
+    EXPECT_FALSE(rebuilt);
+
+    EXPECT_EQ(cache.GetSize(), 3u);
+    cache.Clear();
+    EXPECT_EQ(cache.GetSize(), 0u);
+    EXPECT_EQ(resource.use_count(), 1);
+}
+
+TEST(TensorValueCacheTest, FailedCreateLeavesTensorUncached)
+{
+    FakeTensorValueCache cache;
+    auto resource = std::make_shared<FakeResource>();
+
+    GetOrCreate(cache, "x", resource, { 1 });
+    EXPECT_THROW(cache.GetOrCreate("x", resource.get(), { 2 }, []() -> FakeTensorValue { throw std::runtime_error("failed"); }), std::runtime_error);
+    EXPECT_EQ(cache.GetSize(), 0u);
+
+    bool rebuilt = false;
+    GetOrCreate(cache, "x", resource, { 1 }, &rebuilt);
+    EXPECT_TRUE(rebuilt);
+}
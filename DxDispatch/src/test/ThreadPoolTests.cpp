@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include "ThreadPool.h"
+
+// ----------------------------------------------------------------------------
+// ThreadPool
+// ----------------------------------------------------------------------------
+
+TEST(ThreadPoolTest, ThreadCountIncludesCallingThread)
+{
+    ThreadPool pool(4);
+    EXPECT_EQ(pool.ThreadCount(), 4u);
+
+    // A pool with a single thread runs every loop on the calling thread.
+    ThreadPool serialPool(1);
+    auto callingThread = std::this_thread::get_id();
+    serialPool.ParallelFor(8, [&](size_t) { EXPECT_EQ(std::this_thread::get_id(), callingThread); });
+}
+
+TEST(ThreadPoolTest, EveryIndexRunsOnce)
+{
+    ThreadPool pool(4);
+    std::vector<std::atomic<uint32_t>> calls(1000);
+
+    pool.ParallelFor(calls.size(), [&](size_t i) { calls[i]++; });
+
+    for (auto& count : calls)
+    {
+        EXPECT_EQ(count, 1u);
+    }
+}
+
+TEST(ThreadPoolTest, PoolIsReusable)
+{
+    ThreadPool pool(3);
+    std::atomic<uint64_t> sum = 0;
+
+    for (size_t loop = 0; loop < 100; loop++)
+    {
+        pool.ParallelFor(loop, [&](size_t i) { sum += i + 1; });
+    }
+
+    // sum over loops of loop * (loop + 1) / 2
+    uint64_t expected = 0;
+    for (uint64_t loop = 0; loop < 100; loop++)
+    {
+        expected += loop * (loop + 1) / 2;
+    }
+    EXPECT_EQ(sum, expected);
+}
+
+TEST(ThreadPoolTest, ExceptionsAreRethrownAfterLoopFinishes)
+{
+    ThreadPool pool(4);
+    std::atomic<uint32_t> calls = 0;
+
+    EXPECT_THROW(pool.ParallelFor(64, [&](size_t i)
+    {
+        calls++;
+        if (i == 10)
+        {
+            throw std::runtime_error("failed");
+        }
+    }), std::runtime_error);
+    EXPECT_EQ(calls, 64u);
+
+    // The pool still works after a failed loop.
+    calls = 0;
+    pool.ParallelFor(16, [&](size_t) { calls++; });
+    EXPECT_EQ(calls, 16u);
+}
@@ -0,0 +1,188 @@
+#include "FakeFenceTimeline.h"
+#include "TimestampRing.h"
+
+// ----------------------------------------------------------------------------
+// TimestampRing
+// ----------------------------------------------------------------------------
+
+using TimestampPair = std::pair<uint64_t, uint64_t>;
+using QueryRange = std::pair<uint32_t, uint32_t>;
+
+class TimestampRingTest : public ::testing::Test
+{
+protected:
+    // Records a timestamp and immediately "resolves" a value for it, as the GPU would when the submission executes.
+    uint32_t Record(TimestampRing& ring, FakeFenceTimeline& timeline, uint64_t value)
+    {
+        uint32_t queryIndex = ring.Record(&timeline);
+        resolvedValues[queryIndex] = value;
+        return queryIndex;
+    }
+
+    std::vector<uint64_t> resolvedValues = std::vector<uint64_t>(8);
+    std::vector<TimestampPair> pairs;
+    std::vector<IFenceTimeline*> pairTimelines;
+    TimestampRing::PairCallback onPair = [this](IFenceTimeline* timeline, uint64_t start, uint64_t end)
+    {
+        pairs.push_back({ start, end });
+        pairTimelines.push_back(timeline);
+    };
+};
+
+TEST_F(TimestampRingTest, CapacityMustBeEven)
+{
+    EXPECT_THROW(TimestampRing(0, resolvedValues.data(), onPair), std::invalid_argument);
+    EXPECT_THROW(TimestampRing(3, resolvedValues.data(), onPair), std::invalid_argument);
+}
+
+TEST_F(TimestampRingTest, PairsAreConsumedWhenSubmissionCompletes)
+{
+    FakeFenceTimeline timeline;
+    TimestampRing ring(8, resolvedValues.data(), onPair);
+
+    Record(ring, timeline, 10);
+    Record(ring, timeline, 15);
+    ring.Submit(&timeline, timeline.Signal());
+
+    // Nothing is consumed until the fence completes, and polling doesn't wait.
+    ring.Poll();
+    EXPECT_TRUE(pairs.empty());
+    EXPECT_TRUE(timeline.waitedValues.empty());
+
+    timeline.Retire(1);
+    ring.Poll();
+    ASSERT_EQ(pairs.size(), 1u);
+    EXPECT_EQ(pairs[0], TimestampPair(10, 15));
+}
+
+TEST_F(TimestampRingTest, PairMaySpanSubmissions)
+{
+    FakeFenceTimeline timeline;
+    TimestampRing ring(8, resolvedValues.data(), onPair);
+
+    Record(ring, timeline, 100);
+    ring.Submit(&timeline, timeline.Signal());
+    Record(ring, timeline, 130);
+    ring.Submit(&timeline, timeline.Signal());
+
+    timeline.Retire(1);
+    ring.Poll();
+    EXPECT_TRUE(pairs.empty());
+
+    timeline.Retire(2);
+    ring.Poll();
+    ASSERT_EQ(pairs.size(), 1u);
+    EXPECT_EQ(pairs[0], TimestampPair(100, 130));
+}
+
+TEST_F(TimestampRingTest, UnresolvedRangesWrapAroundRing)
+{
+    FakeFenceTimeline timeline;
+    TimestampRing ring(8, resolvedValues.data(), onPair);
+
+    for (uint64_t i = 0; i < 6; i++)
+    {
+        Record(ring, timeline, i);
+    }
+    ring.Submit(&timeline, timeline.Signal());
+    timeline.Retire(1);
+    ring.Poll();
+    EXPECT_EQ(pairs.size(), 3u);
+
+    for (uint64_t i = 0; i < 4; i++)
+    {
+        Record(ring, timeline, i);
+    }
+
+    auto ranges = ring.GetUnresolvedRanges(&timeline);
+    ASSERT_EQ(ranges.size(), 2u);
+    EXPECT_EQ(ranges[0], QueryRange(6, 2));
+    EXPECT_EQ(ranges[1], QueryRange(0, 2));
+
+    ring.Submit(&timeline, timeline.Signal());
+    EXPECT_TRUE(ring.GetUnresolvedRanges(&timeline).empty());
+}
+
+TEST_F(TimestampRingTest, TimelinesAreResolvedSeparately)
+{
+    FakeFenceTimeline timeline0;
+    FakeFenceTimeline timeline1;
+    TimestampRing ring(8, resolvedValues.data(), onPair);
+
+    Record(ring, timeline0, 1);
+    Record(ring, timeline0, 2);
+    Record(ring, timeline1, 3);
+    Record(ring, timeline1, 4);
+
+    EXPECT_EQ(ring.GetUnresolvedRanges(&timeline0), (std::vector<QueryRange>{ { 0, 2 } }));
+    EXPECT_EQ(ring.GetUnresolvedRanges(&timeline1), (std::vector<QueryRange>{ { 2, 2 } }));
+
+    // Pairs are consumed in recording order, so the second queue's pair waits for the first queue.
+    ring.Submit(&timeline1, timeline1.Signal());
+    timeline1.Retire(1);
+    ring.Poll();
+    EXPECT_TRUE(pairs.empty());
+
+    ring.Submit(&timeline0, timeline0.Signal());
+    timeline0.Retire(1);
+    ring.Poll();
+    ASSERT_EQ(pairs.size(), 2u);
+    EXPECT_EQ(pairs[0], TimestampPair(1, 2));
+    EXPECT_EQ(pairs[1], TimestampPair(3, 4));
+    EXPECT_EQ(pairTimelines, (std::vector<IFenceTimeline*>{ &timeline0, &timeline1 }));
+}
+
+TEST_F(TimestampRingTest, FullRingWaitsForOldestSubmission)
+{
+    FakeFenceTimeline timeline;
+    TimestampRing ring(4, resolvedValues.data(), onPair);
+
+    // Two submissions in flight fill the ring.
+    for (uint64_t submission = 0; submission < 2; submission++)
+    {
+        Record(ring, timeline, submission * 10);
+        Record(ring, timeline, submission * 10 + 1);
+        ring.Submit(&timeline, timeline.Signal());
+    }
+
+    Record(ring, timeline, 20);
+    EXPECT_EQ(timeline.waitedValues, std::vector<uint64_t>{ 1 });
+    EXPECT_EQ(ring.StallCount(), 1u);
+    ASSERT_EQ(pairs.size(), 1u);
+    EXPECT_EQ(pairs[0], TimestampPair(0, 1));
+
+    // The oldest query is already consumed, so there's room without waiting.
+    Record(ring, timeline, 21);
+    EXPECT_EQ(ring.StallCount(), 1u);
+}
+
+TEST_F(TimestampRingTest, FullRingOfUnsubmittedTimestampsThrows)
+{
+    FakeFenceTimeline timeline;
+    TimestampRing ring(2, resolvedValues.data(), onPair);
+
+    ring.Record(&timeline);
+    ring.Record(&timeline);
+    EXPECT_THROW(ring.Record(&timeline), std::runtime_error);
+}
+
+TEST_F(TimestampRingTest, DrainWaitsForSubmittedTimestamps)
+{
+    FakeFenceTimeline timeline;
+    TimestampRing ring(8, resolvedValues.data(), onPair);
+
+    // Many more timestamps than the capacity can pass through the ring.
+    for (uint64_t i = 0; i < 100; i++)
+    {
+        Record(ring, timeline, i * 2);
+        Record(ring, timeline, i * 2 + 1);
+        ring.Submit(&timeline, timeline.Signal());
+    }
+
+    EXPECT_TRUE(ring.Drain());
+    ASSERT_EQ(pairs.size(), 100u);
+    EXPECT_EQ(pairs.back(), TimestampPair(198, 199));
+
+    Record(ring, timeline, 0);
+    EXPECT_FALSE(ring.Drain());
+}
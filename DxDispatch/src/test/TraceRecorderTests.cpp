@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include "PhaseTiming.h"
+#include "TraceRecorder.h"
+
+// ----------------------------------------------------------------------------
+// TraceRecorder
+// ----------------------------------------------------------------------------
+
+static std::string WriteTrace(const TraceRecorder& recorder)
+{
+    std::ostringstream stream;
+    recorder.Write(stream);
+    return stream.str();
+}
+
+TEST(TraceRecorderTest, ScopesWithoutActiveRecorderDoNothing)
+{
+    TraceRecorder recorder;
+    {
+        TraceScope scope("test", "inactive");
+    }
+    EXPECT_EQ(recorder.GetEventCount(), 0u);
+}
+
+TEST(TraceRecorderTest, ActiveScopesNest)
+{
+    TraceRecorder recorder;
+    {
+        TraceRecorder::ActiveScope active(&recorder);
+        EXPECT_EQ(TraceRecorder::GetActive(), &recorder);
+        {
+            TraceRecorder::ActiveScope inactive(nullptr);
+            EXPECT_EQ(TraceRecorder::GetActive(), nullptr);
+            TraceScope scope("test", "ignored");
+        }
+        EXPECT_EQ(TraceRecorder::GetActive(), &recorder);
+        TraceScope scope("test", "recorded");
+    }
+    EXPECT_EQ(TraceRecorder::GetActive(), nullptr);
+    EXPECT_EQ(recorder.GetEventCount(), 1u);
+}
+
+TEST(TraceRecorderTest, ThreadsHaveSeparateTracks)
+{
+    TraceRecorder recorder;
+    recorder.AddEvent("main", "test", TraceRecorder::Clock::now(), TraceRecorder::Clock::now());
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++)
+    {
+        threads.emplace_back([&recorder]
+        {
+            TraceRecorder::ActiveScope active(&recorder);
+            for (int j = 0; j < 100; j++)
+            {
+                TraceScope scope("test", "worker");
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_EQ(recorder.GetEventCount(), 401u);
+
+    // Each of the five threads is named.
+    auto trace = WriteTrace(recorder);
+    for (int track = 1; track <= 5; track++)
+    {
+        EXPECT_NE(trace.find("\"name\":\"Thread " + std::to_string(track) + "\""), std::string::npos);
+    }
+}
+
+TEST(TraceRecorderTest, WritesCompleteEvents)
+{
+    TraceRecorder recorder;
+    auto start = TraceRecorder::Clock::now() + std::chrono::milliseconds(1);
+    recorder.AddEvent("say \"hi\"\n", "test", start, start + std::chrono::microseconds(250));
+    recorder.AddEvent("kernel", "gpu", start, start + std::chrono::microseconds(10), recorder.GetNamedTrackId("GPU queue 0"));
+
+    auto trace = WriteTrace(recorder);
+    EXPECT_EQ(trace.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", 0), 0u);
+    EXPECT_NE(trace.find("\"tid\":1,\"name\":\"say \\\"hi\\\"\\u000a\",\"cat\":\"test\""), std::string::npos);
+    EXPECT_NE(trace.find("\"dur\":250.000}"), std::string::npos);
+    EXPECT_NE(trace.find("\"tid\":2,\"name\":\"kernel\",\"cat\":\"gpu\""), std::string::npos);
+    EXPECT_EQ(trace.substr(trace.size() - 4), "\n]}\n");
+}
+
+TEST(TraceRecorderTest, NamedTracksAreSeparate)
+{
+    TraceRecorder recorder;
+    uint32_t queue0 = recorder.GetNamedTrackId("GPU queue 0");
+    uint32_t queue1 = recorder.GetNamedTrackId("GPU queue 1");
+    EXPECT_NE(queue0, queue1);
+    EXPECT_EQ(recorder.GetNamedTrackId("GPU queue 0"), queue0);
+
+    // Overlapping events of different queues are on different tracks, and neither shares a thread's track.
+    auto start = TraceRecorder::Clock::now();
+    recorder.AddEvent("a", "gpu", start, start + std::chrono::microseconds(10), queue0);
+    recorder.AddEvent("b", "gpu", start, start + std::chrono::microseconds(10), queue1);
+    recorder.AddEvent("c", "test", start, start + std::chrono::microseconds(10));
+
+    auto trace = WriteTrace(recorder);
+    EXPECT_NE(trace.find("\"tid\":" + std::to_string(queue0) + ",\"name\":\"thread_name\",\"args\":{\"name\":\"GPU queue 0\"}"), std::string::npos);
+    EXPECT_NE(trace.find("\"tid\":" + std::to_string(queue1) + ",\"name\":\"thread_name\",\"args\":{\"name\":\"GPU queue 1\"}"), std::string::npos);
+    EXPECT_NE(trace.find("\"tid\":" + std::to_string(queue0) + ",\"name\":\"a\""), std::string::npos);
+    EXPECT_NE(trace.find("\"tid\":" + std::to_string(queue1) + ",\"name\":\"b\""), std::string::npos);
+    EXPECT_NE(trace.find("\"tid\":3,\"name\":\"thread_name\",\"args\":{\"name\":\"Thread 1\"}"), std::string::npos);
+    EXPECT_NE(trace.find("\"tid\":3,\"name\":\"c\""), std::string::npos);
+}
+
+TEST(TraceRecorderTest, PhaseScopesAreRecorded)
+{
+    TraceRecorder recorder;
+    {
+        TraceRecorder::ActiveScope active(&recorder);
+        PhaseScope scope(CpuPhase::FenceWait);
+    }
+    EXPECT_NE(WriteTrace(recorder).find("\"name\":\"fence wait\",\"cat\":\"phase\""), std::string::npos);
+}